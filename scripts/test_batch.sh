@@ -0,0 +1,37 @@
+#!/usr/bin/env bash
+set -euo pipefail
+
+root=$(cd "$(dirname "$0")/.." && pwd)
+headless="$root/build/ct10_headless"
+batch="$root/build/ct10_batch"
+manifest="$root/tests/batch_manifest.txt"
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+"$batch" "$manifest" --jobs 4 --out "$work/results.json" || true
+sed -n 's/.*"message": "\([^"]*\)".*/\1/p' "$work/results.json" |
+  sed 's/\\n.*//' > "$work/batch.txt"
+
+status=0
+index=0
+while IFS= read -r line; do
+  line=${line%%#*}
+  [[ -z "${line// }" ]] && continue
+  index=$((index + 1))
+  read -r -a args <<< "$line"
+  expected=$(cd "$root/tests" && "$headless" "${args[@]}" | head -n 1 || true)
+  actual=$(sed -n "${index}p" "$work/batch.txt")
+  if [[ "$expected" != "$actual" ]]; then
+    echo "MISMATCH ${args[0]}: '$actual' vs '$expected'"
+    status=1
+  else
+    echo "OK ${args[0]}: $actual"
+  fi
+done < "$manifest"
+
+if [[ $index -ne $(wc -l < "$work/batch.txt") ]]; then
+  echo "MISMATCH: batch reported a different number of jobs"
+  status=1
+fi
+
+exit $status
@@ -0,0 +1,63 @@
+#!/usr/bin/env bash
+set -euo pipefail
+
+root=$(cd "$(dirname "$0")/.." && pwd)
+headless="$root/build/ct10_headless"
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+status=0
+for program in "$root"/tests/programs/*.txt; do
+  name=$(basename "$program" .txt)
+  args=("$program")
+  case "$name" in
+    io_terminal_input|io_term_printer)
+      args+=(--terminal-in "$root/tests/tapes/terminal_input.txt" --terminal-alpha)
+      ;;
+  esac
+
+  clock_out=$("$headless" "${args[@]}" --engine clock \
+    --save-state "$work/$name.clock.ct10" || true)
+  functional_out=$("$headless" "${args[@]}" --engine functional \
+    --save-state "$work/$name.functional.ct10" || true)
+
+  if [[ "$clock_out" != "$functional_out" ]]; then
+    echo "MISMATCH $name: '$clock_out' vs '$functional_out'"
+    status=1
+  elif ! cmp -s "$work/$name.clock.ct10" "$work/$name.functional.ct10"; then
+    echo "MISMATCH $name: final machine state differs"
+    status=1
+  else
+    echo "OK $name: $clock_out"
+  fi
+done
+
+# A run resumed from its checkpoints ends in the same state, and a file cut
+# short resumes from its last complete record, one interval before the halt.
+program="$root/tests/programs/div_two_numbers.txt"
+every=50
+run_out=$("$headless" "$program" --checkpoint "$work/run.ckpt" \
+  --checkpoint-every $every --save-state "$work/run.ct10" || true)
+clocks=$(sed -n 's/.*halted after \([0-9]*\) clock steps.*/\1/p' <<< "$run_out")
+last=$(( (clocks - 1) / every * every ))
+"$headless" "$program" --resume "$work/run.ckpt" \
+  --save-state "$work/resumed.ct10" > /dev/null || true
+head -c -1 "$work/run.ckpt" > "$work/cut.ckpt"
+"$headless" "$program" --resume "$work/cut.ckpt" --max-steps $last \
+  --save-state "$work/cut.ct10" > /dev/null || true
+"$headless" "$program" --max-steps $last \
+  --save-state "$work/last.ct10" > /dev/null || true
+if [[ -z "$clocks" ]]; then
+  echo "MISMATCH checkpoint: '$run_out'"
+  status=1
+elif ! cmp -s "$work/run.ct10" "$work/resumed.ct10"; then
+  echo "MISMATCH checkpoint: resumed state differs"
+  status=1
+elif ! cmp -s "$work/last.ct10" "$work/cut.ct10"; then
+  echo "MISMATCH checkpoint: cut file did not resume at clock $last"
+  status=1
+else
+  echo "OK checkpoint: resumed at clock $last and at the halt"
+fi
+
+exit $status
@@ -0,0 +1,54 @@
+#!/usr/bin/env bash
+set -euo pipefail
+
+root=$(cd "$(dirname "$0")/.." && pwd)
+headless="$root/build/ct10_headless"
+program="$root/tests/programs/io_term_printer.txt"
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+status=0
+run() {
+  local tape=$1
+  shift
+  "$headless" "$program" --terminal-in "$tape" --terminal-alpha "$@" \
+    > /dev/null || true
+}
+
+# Loading a state runs it on to the halt, so a halted one is only decoded
+# and saved again as a plain v2 file.
+resave() {
+  "$headless" "$program" --load-state "$1" --save-state "$2" > /dev/null ||
+    true
+}
+
+check() {
+  local name=$1 expected=$2 actual=$3
+  if ! cmp -s "$expected" "$actual"; then
+    echo "MISMATCH $name"
+    status=1
+  else
+    echo "OK $name"
+  fi
+}
+
+# The long run of zeros left in the terminal input gives the compressed
+# save something to code.
+printf 'ABCD%0300d' 0 > "$work/tape.txt"
+run "$work/tape.txt" --save-state "$work/plain.ct10"
+run "$work/tape.txt" --save-state "$work/packed.ct10" --compress-state
+if cmp -s "$work/plain.ct10" "$work/packed.ct10"; then
+  echo "MISMATCH compressed save: streams were not coded"
+  status=1
+fi
+resave "$work/plain.ct10" "$work/plain.resaved.ct10"
+check "plain round trip" "$work/plain.ct10" "$work/plain.resaved.ct10"
+resave "$work/packed.ct10" "$work/packed.resaved.ct10"
+check "compressed round trip" "$work/plain.ct10" "$work/packed.resaved.ct10"
+
+# The fixture is a CT10DMP1 file saved 400 clocks into this run.
+run "$root/tests/tapes/terminal_input.txt" --save-state "$work/run.ct10"
+resave "$root/tests/states/io_term_printer_v1.ct10" "$work/v1.ct10"
+check "v1 state resumed" "$work/run.ct10" "$work/v1.ct10"
+
+exit $status
@@ -0,0 +1,64 @@
+#!/usr/bin/env bash
+set -euo pipefail
+
+root=$(cd "$(dirname "$0")/.." && pwd)
+headless="$root/build/ct10_headless"
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+# Each sweep runs 256 machines through the lockstep engine; every line must
+# match a scalar run of the same program with that byte in place. Without
+# its EXPECT lines a program passes on halting, so the lines give the clocks.
+status=0
+check() {
+  local name=$1
+  shift
+  local value expected actual
+  for value in $(seq 0 255); do
+    printf -v value '%02X' "$value"
+    actual=$(grep "^0x$value: " "$work/sweep.txt" | sed 's/^0x..: //')
+    expected=$("$@" "$value" | head -n 1 || true)
+    if [[ "$expected" != "$actual" ]]; then
+      echo "MISMATCH $name 0x$value: '$actual' vs '$expected'"
+      status=1
+      return
+    fi
+  done
+  echo "OK $name: $(tail -n 1 "$work/sweep.txt")"
+}
+
+scalar_memory() {
+  local program=$1 address=$2 value=$3
+  { cat "$program"; printf '@%s\n%s\n' "$address" "$value"; } \
+    > "$work/program.txt"
+  "$headless" "$work/program.txt"
+}
+
+scalar_terminal() {
+  local program=$1 value=$2
+  echo "$value" > "$work/terminal.txt"
+  "$headless" "$program" --terminal-in "$work/terminal.txt" --terminal-hex
+}
+
+while read -r name address; do
+  program="$root/tests/programs/$name.txt"
+  "$headless" "$program" --sweep "0x$address" > "$work/sweep.txt" || true
+  check "$name@$address" scalar_memory "$program" "$address"
+  grep -v '^# EXPECT' "$program" > "$work/clocks.txt"
+  "$headless" "$work/clocks.txt" --sweep "0x$address" > "$work/sweep.txt" ||
+    true
+  check "$name@$address clocks" scalar_memory "$work/clocks.txt" "$address"
+done <<'EOF'
+test 20
+branch_bze 20
+div_two_numbers 22
+mul_two_numbers 21
+shift_sra 20
+skip_if_flag 21
+EOF
+
+program="$root/tests/programs/io_terminal_input.txt"
+"$headless" "$program" --sweep-terminal > "$work/sweep.txt" || true
+check "io_terminal_input@terminal" scalar_terminal "$program"
+
+exit $status
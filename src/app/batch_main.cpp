@@ -0,0 +1,687 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "app/batch_scheduler.h"
+#include "app/grading.h"
+#include "core/coverage.h"
+#include "core/execution_engine.h"
+#include "core/functional_engine.h"
+#include "core/instruction_probes.h"
+#include "core/machine_fork.h"
+#include "core/machine_state.h"
+#include "core/microcode_coverage.h"
+#include "core/runner.h"
+#include "core/timing_engine.h"
+
+namespace {
+
+namespace fs = std::filesystem;
+using Clock = std::chrono::steady_clock;
+
+// Jobs that differ only in terminal input run the program once up to its
+// first terminal transfer, then each continues from a fork of that run.
+struct ForkGroup {
+  std::vector<size_t> members;
+  ct10::core::MachineFork fork;
+  // What the shared prefix covered, copied into each member's coverage.
+  ct10::core::Coverage coverage;
+};
+
+struct BatchJob {
+  std::string name;
+  ct10::app::GradingJob job;
+  const ct10::app::ProgramSpec* spec = nullptr;
+  std::string setup_error;
+  const ForkGroup* fork_group = nullptr;
+};
+
+struct JobOutcome {
+  ct10::app::GradeStatus status = ct10::app::GradeStatus::Error;
+  uint64_t steps = 0;
+  uint64_t prefix_clocks = 0;
+  uint64_t slices = 0;
+  double wall_ms = 0.0;
+  std::string message;
+};
+
+// A job between time slices. Its machine is kept so the next slice resumes
+// at the same clock on whichever worker picks it up, and so is its coverage,
+// which may still be waiting on the outcome of a branch.
+struct JobRun {
+  std::unique_ptr<ct10::core::MachineState> state;
+  bool prepared = false;
+  ct10::core::Coverage coverage;
+};
+
+// Engines owned by one worker thread, plus the machine of its last finished
+// job, reused by the next job it starts. Microcode coverage is kept per
+// worker and merged once every job is done.
+struct Worker {
+  ct10::core::UntracedExecutionEngine execution;
+  ct10::core::FunctionalEngine functional;
+  ct10::core::MicrocodeCoverage microcode;
+  bool coverage = false;
+  std::unique_ptr<ct10::core::MachineState> spare;
+};
+
+// Files shared between jobs (tapes, expected output) are read once.
+class FileCache {
+ public:
+  bool Read(const std::string& path, std::string& content) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = files_.find(path);
+    if (it == files_.end()) {
+      std::optional<std::string> loaded;
+      std::string data;
+      if (ct10::app::ReadFileContent(path, data)) {
+        loaded = std::move(data);
+      }
+      it = files_.emplace(path, std::move(loaded)).first;
+    }
+    if (!it->second) {
+      return false;
+    }
+    content = *it->second;
+    return true;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::unordered_map<std::string, std::optional<std::string>> files_;
+};
+
+void PrintUsage() {
+  std::printf(
+      "usage: ct10_batch <manifest|directory> [--out FILE] [--jobs N] "
+      "[--slice CLOCKS] [--no-fork] [--coverage FILE]\n"
+      "       [--microcode-coverage FILE] [job options]\n"
+      "Each manifest line is a program path followed by ct10_headless job "
+      "options;\nrelative paths are resolved against the manifest's "
+      "directory. A directory\nruns every *.txt program in it. Job options "
+      "given here apply to every job.\nJobs differing only in --terminal-in "
+      "share one run up to the first terminal\ntransfer unless --no-fork. "
+      "--coverage and --microcode-coverage merge what every\njob ran into "
+      "FILE.\n");
+}
+
+std::vector<std::string> SplitWords(const std::string& line) {
+  std::istringstream in(line);
+  std::vector<std::string> words;
+  std::string word;
+  while (in >> word) {
+    words.push_back(word);
+  }
+  return words;
+}
+
+void ResolvePath(const fs::path& base,
+                 const std::string& common,
+                 std::string& path) {
+  if (!path.empty() && path != common && fs::path(path).is_relative()) {
+    path = (base / path).lexically_normal().string();
+  }
+}
+
+// Parses one manifest line on top of the command-line defaults.
+bool ParseManifestLine(const std::string& line,
+                       const fs::path& base,
+                       const ct10::app::GradingJob& defaults,
+                       BatchJob& out,
+                       std::string& error) {
+  std::vector<std::string> words = SplitWords(line);
+  std::vector<char*> argv;
+  argv.push_back(nullptr);
+  for (std::string& word : words) {
+    argv.push_back(word.data());
+  }
+  int argc = static_cast<int>(argv.size());
+
+  out.job = defaults;
+  out.job.program_path.clear();
+  for (int i = 1; i < argc; ++i) {
+    ct10::app::JobOption option =
+        ct10::app::ParseJobOption(argc, argv.data(), i, out.job, error);
+    if (option == ct10::app::JobOption::Invalid) {
+      return false;
+    }
+    if (option == ct10::app::JobOption::Parsed) {
+      continue;
+    }
+    if (ct10::app::IsNumber(argv[i]) && !out.job.max_steps_set) {
+      if (ct10::app::ParseStepsValue(argv[i], out.job.max_steps)) {
+        out.job.max_steps_set = true;
+      }
+      continue;
+    }
+    if (!out.job.program_path.empty()) {
+      error = std::string("unexpected argument ") + argv[i] + ".";
+      return false;
+    }
+    out.job.program_path = argv[i];
+  }
+  if (out.job.program_path.empty()) {
+    error = "missing program path.";
+    return false;
+  }
+
+  out.name = out.job.program_path;
+  ResolvePath(base, "", out.job.program_path);
+  ResolvePath(base, defaults.tape_path, out.job.tape_path);
+  ResolvePath(base, defaults.terminal_in_path, out.job.terminal_in_path);
+  ResolvePath(base, defaults.expect_term_path, out.job.expect_term_path);
+  ResolvePath(base, defaults.expect_printer_path,
+              out.job.expect_printer_path);
+  return true;
+}
+
+bool CollectJobs(const std::string& source,
+                 const ct10::app::GradingJob& defaults,
+                 std::vector<BatchJob>& jobs,
+                 std::string& error) {
+  std::error_code ec;
+  if (fs::is_directory(source, ec)) {
+    std::vector<fs::path> programs;
+    for (const fs::directory_entry& entry :
+         fs::directory_iterator(source, ec)) {
+      if (entry.is_regular_file() && entry.path().extension() == ".txt") {
+        programs.push_back(entry.path());
+      }
+    }
+    std::sort(programs.begin(), programs.end());
+    for (const fs::path& program : programs) {
+      BatchJob job;
+      job.name = program.filename().string();
+      job.job = defaults;
+      job.job.program_path = program.string();
+      jobs.push_back(std::move(job));
+    }
+    return true;
+  }
+
+  std::ifstream manifest(source);
+  if (!manifest) {
+    error = "Unable to open manifest.";
+    return false;
+  }
+  fs::path base = fs::path(source).parent_path();
+  std::string line;
+  int line_number = 0;
+  while (std::getline(manifest, line)) {
+    ++line_number;
+    size_t comment = line.find('#');
+    if (comment != std::string::npos) {
+      line.erase(comment);
+    }
+    if (SplitWords(line).empty()) {
+      continue;
+    }
+    BatchJob job;
+    std::string line_error;
+    if (!ParseManifestLine(line, base, defaults, job, line_error)) {
+      error = "manifest line " + std::to_string(line_number) + ": " +
+              line_error;
+      return false;
+    }
+    jobs.push_back(std::move(job));
+  }
+  return true;
+}
+
+// Runs the next slice_clocks of a job; returns true once it is graded.
+bool RunSlice(const BatchJob& batch_job,
+              const ct10::app::FileReader& read,
+              uint64_t slice_clocks,
+              Worker& worker,
+              JobRun& run,
+              JobOutcome& outcome) {
+  Clock::time_point start = Clock::now();
+  const ct10::app::GradingJob& job = batch_job.job;
+  ct10::core::TimingEngine timing;
+  bool done = true;
+  ++outcome.slices;
+  if (!batch_job.setup_error.empty()) {
+    outcome.message = batch_job.setup_error;
+  } else {
+    if (!run.state) {
+      run.state = worker.spare ? std::move(worker.spare)
+                               : std::make_unique<ct10::core::MachineState>();
+      run.state->trace.set_capacity(0);
+      const ForkGroup* group = batch_job.fork_group;
+      if (group && group->fork.captured()) {
+        group->fork.Spawn(*run.state);
+        run.coverage = group->coverage;
+        run.prepared = ct10::app::LoadTerminalInput(
+            job, read, run.state->io.terminal_input, outcome.message);
+        outcome.steps = group->fork.clocks();
+        outcome.prefix_clocks = group->fork.clocks();
+      } else {
+        run.prepared = ct10::app::PrepareJob(job, batch_job.spec, read,
+                                             *run.state, outcome.message);
+        timing.Reset(run.state->timing);
+      }
+    }
+    if (run.prepared) {
+      uint64_t max_steps = static_cast<uint64_t>(job.max_steps);
+      // A fork taken at a halt has nothing left to run.
+      if (!run.state->mode.halted && outcome.steps < max_steps) {
+        worker.execution.set_fast_forward(job.fast_forward);
+        ct10::core::InstructionProbes probes;
+        probes.coverage = worker.coverage ? &run.coverage : nullptr;
+        ct10::core::UntracedRunner runner(
+            worker.execution,
+            job.use_functional ? &worker.functional : nullptr, probes);
+        ct10::core::RunResult result = runner.Run(
+            *run.state, timing,
+            {ct10::core::BudgetUnit::Clocks,
+             std::min(slice_clocks, max_steps - outcome.steps)});
+        outcome.steps += result.clocks;
+      }
+      done = run.state->mode.halted || outcome.steps >= max_steps;
+      if (done) {
+        ct10::app::GradeResult grade = ct10::app::GradeJob(
+            job, batch_job.spec, *run.state, outcome.steps, read);
+        outcome.status = grade.status;
+        outcome.message = std::move(grade.message);
+      }
+    }
+    if (done) {
+      worker.spare = std::move(run.state);
+    }
+  }
+  outcome.wall_ms +=
+      std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+  return done;
+}
+
+// Everything that shapes a run except the terminal input and the
+// expected output.
+std::string ForkKey(const ct10::app::GradingJob& job) {
+  std::ostringstream key;
+  key << job.program_path << '\n'
+      << job.tape_path << '\n'
+      << job.max_steps << ' ' << job.tape_alpha << job.tape_hex
+      << job.terminal_alpha << job.terminal_hex << job.io_mode_set
+      << static_cast<int>(job.io_mode) << job.use_functional
+      << job.fast_forward;
+  return key.str();
+}
+
+std::vector<std::unique_ptr<ForkGroup>> GroupForks(
+    std::vector<BatchJob>& jobs) {
+  std::map<std::string, std::unique_ptr<ForkGroup>> by_key;
+  for (size_t i = 0; i < jobs.size(); ++i) {
+    if (jobs[i].setup_error.empty() && !jobs[i].job.terminal_in_path.empty()) {
+      std::unique_ptr<ForkGroup>& group = by_key[ForkKey(jobs[i].job)];
+      if (!group) {
+        group = std::make_unique<ForkGroup>();
+      }
+      group->members.push_back(i);
+    }
+  }
+  std::vector<std::unique_ptr<ForkGroup>> groups;
+  for (auto& [key, group] : by_key) {
+    if (group->members.size() > 1) {
+      for (size_t member : group->members) {
+        jobs[member].fork_group = group.get();
+      }
+      groups.push_back(std::move(group));
+    }
+  }
+  return groups;
+}
+
+// Runs the group's first job up to its first terminal transfer and
+// captures the fork. The group's jobs run from reset if the prefix cannot
+// be shared: the first job fails to load, or its terminal input was read.
+void RunPrefix(const BatchJob& first,
+               const ct10::app::FileReader& read,
+               Worker& worker,
+               ForkGroup& group) {
+  const ct10::app::GradingJob& job = first.job;
+  ct10::core::MachineState state;
+  state.trace.set_capacity(0);
+  std::string message;
+  if (!ct10::app::PrepareJob(job, first.spec, read, state, message) ||
+      state.io.terminal_input.empty()) {
+    return;
+  }
+  ct10::core::TimingEngine timing;
+  timing.Reset(state.timing);
+  worker.execution.set_fast_forward(job.fast_forward);
+  ct10::core::InstructionProbes probes;
+  probes.coverage = worker.coverage ? &group.coverage : nullptr;
+  ct10::core::UntracedRunner runner(
+      worker.execution, job.use_functional ? &worker.functional : nullptr,
+      probes);
+  uint64_t clocks = ct10::core::RunUntilTerminalInput(
+      runner, state, timing, static_cast<uint64_t>(job.max_steps));
+  if (state.io.terminal_input_pos == 0) {
+    group.fork.Capture(state, clocks);
+  }
+}
+
+const char* StatusName(ct10::app::GradeStatus status) {
+  switch (status) {
+    case ct10::app::GradeStatus::Pass:
+      return "pass";
+    case ct10::app::GradeStatus::Fail:
+      return "fail";
+    case ct10::app::GradeStatus::NoHalt:
+      return "no_halt";
+    case ct10::app::GradeStatus::Error:
+      return "error";
+  }
+  return "error";
+}
+
+std::string JsonString(const std::string& text) {
+  std::string out = "\"";
+  for (char c : text) {
+    switch (c) {
+      case '"':
+        out += "\\\"";
+        break;
+      case '\\':
+        out += "\\\\";
+        break;
+      case '\n':
+        out += "\\n";
+        break;
+      case '\t':
+        out += "\\t";
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          char escaped[8];
+          std::snprintf(escaped, sizeof(escaped), "\\u%04x",
+                        static_cast<unsigned>(c));
+          out += escaped;
+        } else {
+          out += c;
+        }
+        break;
+    }
+  }
+  out += '"';
+  return out;
+}
+
+// One job per line so results stay easy to grep.
+bool WriteResults(std::FILE* out,
+                  const std::vector<BatchJob>& jobs,
+                  const std::vector<JobOutcome>& outcomes,
+                  const ct10::app::WorkStealingScheduler& scheduler,
+                  uint64_t slice_clocks,
+                  size_t fork_groups,
+                  double prefix_ms) {
+  size_t passed = std::count_if(
+      outcomes.begin(), outcomes.end(), [](const JobOutcome& outcome) {
+        return outcome.status == ct10::app::GradeStatus::Pass;
+      });
+  std::fprintf(out, "{\n");
+  double wall_ms = scheduler.wall_ms();
+  std::fprintf(out, "  \"workers\": %u,\n", scheduler.workers());
+  std::fprintf(out, "  \"slice_clocks\": %llu,\n",
+               static_cast<unsigned long long>(slice_clocks));
+  std::fprintf(out, "  \"fork_groups\": %zu,\n", fork_groups);
+  std::fprintf(out, "  \"prefix_ms\": %.3f,\n", prefix_ms);
+  std::fprintf(out, "  \"wall_ms\": %.3f,\n", wall_ms);
+  std::fprintf(out, "  \"total\": %zu,\n", jobs.size());
+  std::fprintf(out, "  \"passed\": %zu,\n", passed);
+  std::fprintf(out, "  \"worker_stats\": [\n");
+  const std::vector<ct10::app::WorkerStats>& stats = scheduler.stats();
+  for (size_t i = 0; i < stats.size(); ++i) {
+    std::fprintf(out,
+                 "    {\"worker\": %zu, \"busy_ms\": %.3f, "
+                 "\"utilization\": %.3f, \"slices\": %llu, "
+                 "\"steals\": %llu, \"jobs\": %llu}%s\n",
+                 i, stats[i].busy_ms,
+                 wall_ms > 0.0 ? stats[i].busy_ms / wall_ms : 0.0,
+                 static_cast<unsigned long long>(stats[i].slices),
+                 static_cast<unsigned long long>(stats[i].steals),
+                 static_cast<unsigned long long>(stats[i].finished),
+                 i + 1 < stats.size() ? "," : "");
+  }
+  std::fprintf(out, "  ],\n");
+  std::fprintf(out, "  \"jobs\": [\n");
+  for (size_t i = 0; i < jobs.size(); ++i) {
+    const JobOutcome& outcome = outcomes[i];
+    std::fprintf(out,
+                 "    {\"name\": %s, \"status\": \"%s\", \"exit_code\": %d, "
+                 "\"steps\": %llu, \"prefix_clocks\": %llu, "
+                 "\"slices\": %llu, \"wall_ms\": %.3f, \"message\": %s}%s\n",
+                 JsonString(jobs[i].name).c_str(), StatusName(outcome.status),
+                 static_cast<int>(outcome.status),
+                 static_cast<unsigned long long>(outcome.steps),
+                 static_cast<unsigned long long>(outcome.prefix_clocks),
+                 static_cast<unsigned long long>(outcome.slices),
+                 outcome.wall_ms, JsonString(outcome.message).c_str(),
+                 i + 1 < jobs.size() ? "," : "");
+  }
+  std::fprintf(out, "  ]\n}\n");
+  return std::ferror(out) == 0;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    PrintUsage();
+    return 3;
+  }
+
+  ct10::app::GradingJob defaults;
+  std::string source;
+  std::string out_path = "-";
+  std::string coverage_path;
+  std::string microcode_path;
+  unsigned workers = std::max(1u, std::thread::hardware_concurrency());
+  int slice_clocks = 1000000;
+  bool fork = true;
+
+  for (int i = 1; i < argc; ++i) {
+    const char* arg = argv[i];
+    std::string error;
+    ct10::app::JobOption option =
+        ct10::app::ParseJobOption(argc, argv, i, defaults, error);
+    if (option == ct10::app::JobOption::Invalid) {
+      std::printf("FAIL: %s\n", error.c_str());
+      return 3;
+    }
+    if (option == ct10::app::JobOption::Parsed) {
+      continue;
+    }
+    if (std::strcmp(arg, "--out") == 0 && i + 1 < argc) {
+      out_path = argv[++i];
+      continue;
+    }
+    if (std::strcmp(arg, "--jobs") == 0 && i + 1 < argc) {
+      int parsed = 0;
+      if (!ct10::app::ParseStepsValue(argv[++i], parsed) || parsed > 1024) {
+        std::printf("FAIL: invalid --jobs value.\n");
+        return 3;
+      }
+      workers = static_cast<unsigned>(parsed);
+      continue;
+    }
+    if (std::strcmp(arg, "--coverage") == 0 && i + 1 < argc) {
+      coverage_path = argv[++i];
+      continue;
+    }
+    if (std::strcmp(arg, "--microcode-coverage") == 0 && i + 1 < argc) {
+      microcode_path = argv[++i];
+      continue;
+    }
+    if (std::strcmp(arg, "--no-fork") == 0) {
+      fork = false;
+      continue;
+    }
+    if (std::strcmp(arg, "--slice") == 0 && i + 1 < argc) {
+      if (!ct10::app::ParseStepsValue(argv[++i], slice_clocks) ||
+          slice_clocks == 0) {
+        std::printf("FAIL: invalid --slice value.\n");
+        return 3;
+      }
+      continue;
+    }
+    if (source.empty() && std::strncmp(arg, "--", 2) != 0) {
+      source = arg;
+      continue;
+    }
+    PrintUsage();
+    return 3;
+  }
+  if (source.empty()) {
+    PrintUsage();
+    return 3;
+  }
+
+  std::vector<BatchJob> jobs;
+  std::string error;
+  if (!CollectJobs(source, defaults, jobs, error)) {
+    std::printf("FAIL: %s\n", error.c_str());
+    return 3;
+  }
+  // An existing report is checked before any job runs, and merged into.
+  ct10::core::Coverage coverage;
+  if (!coverage_path.empty() && std::ifstream(coverage_path).good() &&
+      !ct10::core::LoadCoverage(coverage, coverage_path, &error)) {
+    std::printf("FAIL: coverage merge failed: %s\n", error.c_str());
+    return 3;
+  }
+  ct10::core::MicrocodeCoverage microcode;
+  if (!microcode_path.empty() && std::ifstream(microcode_path).good() &&
+      !ct10::core::LoadMicrocodeCoverage(microcode, microcode_path, &error)) {
+    std::printf("FAIL: microcode coverage merge failed: %s\n",
+                error.c_str());
+    return 3;
+  }
+
+  FileCache cache;
+  ct10::app::FileReader read = [&cache](const std::string& path,
+                                        std::string& content) {
+    return cache.Read(path, content);
+  };
+
+  // Each program is parsed once however many jobs run it.
+  struct LoadedProgram {
+    ct10::app::ProgramSpec spec;
+    std::string error;
+  };
+  std::map<std::string, std::unique_ptr<LoadedProgram>> programs;
+  for (BatchJob& job : jobs) {
+    std::unique_ptr<LoadedProgram>& program = programs[job.job.program_path];
+    if (!program) {
+      program = std::make_unique<LoadedProgram>();
+      ct10::app::LoadProgramSpec(job.job.program_path, read, program->spec,
+                                 program->error);
+    }
+    if (program->error.empty()) {
+      job.spec = &program->spec;
+    } else {
+      job.setup_error = "FAIL: " + program->error;
+    }
+  }
+
+  std::vector<JobOutcome> outcomes(jobs.size());
+  std::vector<JobRun> runs(jobs.size());
+  std::vector<Worker> pool(
+      std::min<size_t>(workers, std::max<size_t>(jobs.size(), 1)));
+  for (Worker& worker : pool) {
+    worker.coverage = !coverage_path.empty();
+  }
+  if (!microcode_path.empty()) {
+    for (Worker& worker : pool) {
+      worker.execution.set_microcode_coverage(&worker.microcode);
+      worker.functional.set_microcode_coverage(&worker.microcode);
+    }
+  }
+  ct10::app::WorkStealingScheduler scheduler(
+      static_cast<unsigned>(pool.size()));
+  std::vector<std::unique_ptr<ForkGroup>> groups;
+  if (fork) {
+    groups = GroupForks(jobs);
+  }
+  scheduler.Run(groups.size(), [&](size_t index, unsigned worker) {
+    ForkGroup& group = *groups[index];
+    RunPrefix(jobs[group.members.front()], read, pool[worker], group);
+    return true;
+  });
+  double prefix_ms = scheduler.wall_ms();
+
+  scheduler.Run(jobs.size(), [&](size_t index, unsigned worker) {
+    return RunSlice(jobs[index], read, static_cast<uint64_t>(slice_clocks),
+                    pool[worker], runs[index], outcomes[index]);
+  });
+
+  std::FILE* out = stdout;
+  if (out_path != "-") {
+    out = std::fopen(out_path.c_str(), "w");
+    if (!out) {
+      std::printf("FAIL: Unable to open results file.\n");
+      return 3;
+    }
+  }
+  bool written =
+      WriteResults(out, jobs, outcomes, scheduler,
+                   static_cast<uint64_t>(slice_clocks), groups.size(), prefix_ms);
+  if (out != stdout) {
+    written = std::fclose(out) == 0 && written;
+  }
+  if (!written) {
+    std::printf("FAIL: Failed to write results file.\n");
+    return 3;
+  }
+  if (!coverage_path.empty()) {
+    for (const JobRun& run : runs) {
+      coverage.Merge(run.coverage);
+    }
+    if (!ct10::core::SaveCoverage(coverage, coverage_path, &error)) {
+      std::printf("FAIL: coverage write failed: %s\n", error.c_str());
+      return 3;
+    }
+  }
+  if (!microcode_path.empty()) {
+    for (const Worker& worker : pool) {
+      microcode.Merge(worker.microcode);
+    }
+    if (!ct10::core::SaveMicrocodeCoverage(microcode, microcode_path,
+                                           &error)) {
+      std::printf("FAIL: microcode coverage write failed: %s\n",
+                  error.c_str());
+      return 3;
+    }
+  }
+
+  size_t passed = std::count_if(
+      outcomes.begin(), outcomes.end(), [](const JobOutcome& outcome) {
+        return outcome.status == ct10::app::GradeStatus::Pass;
+      });
+  if (out != stdout) {
+    double busy_ms = 0.0;
+    for (const ct10::app::WorkerStats& stats : scheduler.stats()) {
+      busy_ms += stats.busy_ms;
+    }
+    double capacity_ms = scheduler.wall_ms() * scheduler.workers();
+    std::printf(
+        "%s: %zu/%zu jobs passed in %.1f ms (%u workers, %.0f%% busy).\n",
+        passed == jobs.size() ? "PASS" : "FAIL", passed, jobs.size(),
+        scheduler.wall_ms(), scheduler.workers(),
+        capacity_ms > 0.0 ? 100.0 * busy_ms / capacity_ms : 0.0);
+  }
+  return passed == jobs.size() ? 0 : 1;
+}
@@ -0,0 +1,130 @@
+#include "app/batch_scheduler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+namespace ct10::app {
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double MillisecondsSince(Clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(Clock::now() - start)
+      .count();
+}
+
+}  // namespace
+
+WorkStealingScheduler::WorkStealingScheduler(unsigned workers)
+    : queues_(std::max(1u, workers)), stats_(queues_.size()) {}
+
+void WorkStealingScheduler::Run(size_t tasks, const Slice& slice) {
+  std::fill(stats_.begin(), stats_.end(), WorkerStats{});
+  for (size_t task = 0; task < tasks; ++task) {
+    queues_[task % queues_.size()].tasks.push_back(task);
+  }
+  remaining_.store(tasks);
+  queued_.store(tasks);
+
+  Clock::time_point start = Clock::now();
+  std::vector<std::thread> threads;
+  for (unsigned worker = 1; worker < queues_.size(); ++worker) {
+    threads.emplace_back(
+        [this, worker, &slice]() { Work(worker, slice); });
+  }
+  Work(0, slice);
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  wall_ms_ = MillisecondsSince(start);
+}
+
+unsigned WorkStealingScheduler::workers() const {
+  return static_cast<unsigned>(queues_.size());
+}
+
+const std::vector<WorkerStats>& WorkStealingScheduler::stats() const {
+  return stats_;
+}
+
+double WorkStealingScheduler::wall_ms() const { return wall_ms_; }
+
+void WorkStealingScheduler::Work(unsigned worker, const Slice& slice) {
+  WorkerStats stats;
+  while (remaining_.load(std::memory_order_acquire) > 0) {
+    size_t task = 0;
+    if (!Pop(worker, task)) {
+      if (!Steal(worker, task)) {
+        std::unique_lock<std::mutex> lock(idle_mutex_);
+        idle_.wait(lock, [this]() {
+          return remaining_.load(std::memory_order_acquire) == 0 ||
+                 queued_.load() > 0;
+        });
+        continue;
+      }
+      ++stats.steals;
+    }
+    Clock::time_point start = Clock::now();
+    bool done = slice(task, worker);
+    stats.busy_ms += MillisecondsSince(start);
+    ++stats.slices;
+    if (done) {
+      ++stats.finished;
+      if (remaining_.fetch_sub(1, std::memory_order_release) == 1) {
+        Wake(true);
+      }
+    } else {
+      Requeue(worker, task);
+    }
+  }
+  stats_[worker] = stats;
+}
+
+bool WorkStealingScheduler::Pop(unsigned worker, size_t& task) {
+  Queue& queue = queues_[worker];
+  std::lock_guard<std::mutex> lock(queue.mutex);
+  if (queue.tasks.empty()) {
+    return false;
+  }
+  task = queue.tasks.back();
+  queue.tasks.pop_back();
+  queued_.fetch_sub(1);
+  return true;
+}
+
+bool WorkStealingScheduler::Steal(unsigned worker, size_t& task) {
+  for (size_t offset = 1; offset < queues_.size(); ++offset) {
+    Queue& victim = queues_[(worker + offset) % queues_.size()];
+    std::lock_guard<std::mutex> lock(victim.mutex);
+    if (!victim.tasks.empty()) {
+      task = victim.tasks.front();
+      victim.tasks.pop_front();
+      queued_.fetch_sub(1);
+      return true;
+    }
+  }
+  return false;
+}
+
+void WorkStealingScheduler::Requeue(unsigned worker, size_t task) {
+  Queue& queue = queues_[worker];
+  {
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    queue.tasks.push_front(task);
+    queued_.fetch_add(1);
+  }
+  Wake(false);
+}
+
+void WorkStealingScheduler::Wake(bool all) {
+  // Taking the lock orders the change before a waiter's next check.
+  { std::lock_guard<std::mutex> lock(idle_mutex_); }
+  if (all) {
+    idle_.notify_all();
+  } else {
+    idle_.notify_one();
+  }
+}
+
+}  // namespace ct10::app
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace ct10::app {
+
+struct WorkerStats {
+  uint64_t slices = 0;
+  uint64_t steals = 0;
+  uint64_t finished = 0;
+  double busy_ms = 0.0;
+};
+
+// Runs tasks in time slices on a fixed pool of worker threads. Each worker
+// owns a deque and takes work from its back; an idle worker steals from the
+// front of another worker's deque. A slice that leaves its task unfinished
+// puts it back at the front of its deque, where thieves look first, so one
+// long task never holds up the short ones queued behind it. A worker with
+// nothing to steal sleeps until a task is put back or the last one finishes.
+class WorkStealingScheduler {
+ public:
+  // Runs one slice of task on worker; returns true once the task is done.
+  using Slice = std::function<bool(size_t task, unsigned worker)>;
+
+  explicit WorkStealingScheduler(unsigned workers);
+
+  // Blocks until every task in [0, tasks) has finished.
+  void Run(size_t tasks, const Slice& slice);
+
+  unsigned workers() const;
+  const std::vector<WorkerStats>& stats() const;
+  double wall_ms() const;
+
+ private:
+  struct alignas(64) Queue {
+    std::mutex mutex;
+    std::deque<size_t> tasks;
+  };
+
+  void Work(unsigned worker, const Slice& slice);
+  bool Pop(unsigned worker, size_t& task);
+  bool Steal(unsigned worker, size_t& task);
+  void Requeue(unsigned worker, size_t task);
+  // Wakes one idle worker after a requeue, or all of them once every task
+  // is done.
+  void Wake(bool all);
+
+  std::vector<Queue> queues_;
+  std::vector<WorkerStats> stats_;
+  std::atomic<size_t> remaining_{0};
+  // Tasks sitting in the deques, which idle workers wait on.
+  std::atomic<size_t> queued_{0};
+  std::mutex idle_mutex_;
+  std::condition_variable idle_;
+  double wall_ms_ = 0.0;
+};
+
+}  // namespace ct10::app
@@ -0,0 +1,532 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "app/golden_program.h"
+#include "app/program_text.h"
+#include "app/tape_io.h"
+#include "core/execution_engine.h"
+#include "core/functional_engine.h"
+#include "core/machine_state.h"
+#include "core/runner.h"
+#include "core/snapshot.h"
+#include "core/state_io.h"
+#include "core/timing_engine.h"
+#include "core/trace_sink.h"
+
+namespace {
+
+namespace fs = std::filesystem;
+using Clock = std::chrono::steady_clock;
+
+constexpr uint64_t kMaxClocks = 100000000;
+// The synthetic loops count X from 0 back round to 0.
+constexpr int kLoopIterations = 256;
+
+// What one repetition of a case did; rates are reported for whichever
+// fields are set.
+struct Work {
+  uint64_t clocks = 0;
+  uint64_t instructions = 0;
+  uint64_t bytes = 0;
+  uint64_t operations = 0;
+};
+
+struct BenchCase {
+  std::string name;
+  std::function<Work()> run;
+};
+
+struct CaseResult {
+  std::string name;
+  Work work;
+  double median_ms = 0.0;
+  double p99_ms = 0.0;
+  double min_ms = 0.0;
+};
+
+struct Options {
+  int warmup = 3;
+  int reps = 20;
+  std::string filter;
+  std::string json_path;
+};
+
+void PrintUsage() {
+  std::printf(
+      "usage: ct10_bench [--warmup N] [--reps N] [--filter TEXT] "
+      "[--json FILE|-]\n"
+      "Runs every case whose name contains TEXT, N warmup and N timed "
+      "repetitions\neach, and reports the median and p99 time per "
+      "repetition.\n");
+}
+
+bool ParseCount(const char* text, int& value) {
+  char* end = nullptr;
+  long parsed = std::strtol(text, &end, 10);
+  if (end == text || *end != '\0' || parsed < 0 || parsed > 100000) {
+    return false;
+  }
+  value = static_cast<int>(parsed);
+  return true;
+}
+
+// A loop running body kLoopIterations times from address 0x02, then
+// halting. Branch targets in body may use {next}, the address after the
+// instruction.
+std::string LoopProgram(const std::vector<std::string>& body,
+                        const std::string& data) {
+  std::string text = "# START 0x000\nLXI 00\n";
+  unsigned address = 0x02;
+  for (const std::string& line : body) {
+    std::string instruction = line;
+    size_t next = instruction.find("{next}");
+    if (next != std::string::npos) {
+      char target[8];
+      std::snprintf(target, sizeof(target), "%02X", address + 2);
+      instruction.replace(next, 6, target);
+    }
+    text += instruction + "\n";
+    address += 2;
+  }
+  char tail[64];
+  std::snprintf(tail, sizeof(tail), "INX FF\nBXZ %02X\nBUN 02\nBST 00\n",
+                address + 6);
+  text += tail;
+  text += data;
+  return text;
+}
+
+std::vector<std::string> Repeat(const std::vector<std::string>& pattern,
+                                size_t count) {
+  std::vector<std::string> lines;
+  for (size_t i = 0; i < count; ++i) {
+    lines.push_back(pattern[i % pattern.size()]);
+  }
+  return lines;
+}
+
+bool PrepareProgram(const std::string& text, ct10::core::MachineState& state) {
+  ct10::app::ProgramSpec spec;
+  ct10::app::ParseResult result;
+  ct10::app::ParseProgramContent(text, spec, result);
+  if (result.skipped > 0 || spec.writes.empty()) {
+    return false;
+  }
+  state.Reset();
+  state.memory.Clear();
+  for (const ct10::app::ProgramWrite& write : spec.writes) {
+    state.memory.Write(write.address, write.value);
+  }
+  state.par.Load(spec.has_entry ? spec.entry : 0x000);
+  state.trace.set_capacity(0);
+  // Errors raise flags instead of halting, and I/O instructions transfer.
+  state.panel_input.error_inst = true;
+  state.panel_input.error_add = true;
+  state.panel_input.error_div = true;
+  state.panel_input.io_mode = 1;
+  return true;
+}
+
+// Runs a copy of prepared to its halt with the given engines.
+template <typename Engine>
+BenchCase ProgramCase(const std::string& name,
+                      const ct10::core::MachineState& prepared,
+                      Engine execution,
+                      bool fast_forward,
+                      bool functional,
+                      size_t trace_capacity = 0) {
+  execution.set_fast_forward(fast_forward);
+  auto engine = std::make_shared<Engine>(std::move(execution));
+  auto functional_engine = std::make_shared<ct10::core::FunctionalEngine>();
+  auto state = std::make_shared<ct10::core::MachineState>(prepared);
+  state->trace.set_capacity(trace_capacity);
+  auto source = std::make_shared<ct10::core::MachineState>(*state);
+  return {name, [=]() {
+            ct10::core::TimingEngine timing;
+            *state = *source;
+            ct10::core::BasicRunner<Engine> runner(
+                *engine, functional ? functional_engine.get() : nullptr);
+            ct10::core::RunResult run = runner.Run(
+                *state, timing, {ct10::core::BudgetUnit::Clocks, kMaxClocks});
+            Work work;
+            work.clocks = run.clocks;
+            work.instructions = run.instructions;
+            return work;
+          }};
+}
+
+void AddEngineCases(std::vector<BenchCase>& cases,
+                    const std::string& name,
+                    const ct10::core::MachineState& prepared) {
+  cases.push_back(ProgramCase(name + "/clock", prepared,
+                              ct10::core::UntracedExecutionEngine(), false,
+                              false));
+  cases.push_back(ProgramCase(name + "/clock-ff", prepared,
+                              ct10::core::UntracedExecutionEngine(), true,
+                              false));
+  cases.push_back(ProgramCase(name + "/functional", prepared,
+                              ct10::core::UntracedExecutionEngine(), true,
+                              true));
+}
+
+bool AddProgramCases(std::vector<BenchCase>& cases) {
+  const std::string data = "@80\n01 40 00 00\n";
+  struct Synthetic {
+    const char* name;
+    std::vector<std::string> pattern;
+  };
+  const Synthetic synthetic[] = {
+      {"immediate",
+       {"LAI 05", "AND 7F", "IOR 01", "XOR 03", "LCI 10", "FLC 00"}},
+      {"paged", {"LDA 80", "ADD 81", "STA 82", "SUB 81", "LDQ 81", "STQ 83"}},
+      {"branch", {"BUN {next}", "BPS {next}", "BZE {next}", "BNC {next}"}},
+      {"mpy-div", {"LDA 80", "MPY 81", "LDA 80", "DIV 81"}},
+      {"shift", {"LAI 35", "SLA 01", "SRA 01", "SLL 01", "SRL 01"}},
+      {"block-io",
+       {"OCD 12", "LCI 0F", "WDB 80", "OCD 11", "LCI 0F", "RDB 90"}},
+  };
+  for (const Synthetic& program : synthetic) {
+    ct10::core::MachineState state;
+    size_t count = program.pattern.size() * (24 / program.pattern.size());
+    if (!PrepareProgram(LoopProgram(Repeat(program.pattern, count), data),
+                        state)) {
+      std::printf("FAIL: synthetic program %s did not assemble.\n",
+                  program.name);
+      return false;
+    }
+    // Enough terminal input for every block read.
+    state.io.terminal_input.assign(kLoopIterations * 16 * 2, 0x41);
+    AddEngineCases(cases, program.name, state);
+  }
+
+  ct10::core::MachineState golden;
+  ct10::app::LoadGoldenProgram(golden);
+  golden.trace.set_capacity(0);
+  AddEngineCases(cases, "golden", golden);
+
+  ct10::core::MachineState paged;
+  PrepareProgram(LoopProgram(Repeat(synthetic[1].pattern, 24), data), paged);
+  cases.push_back(ProgramCase("trace/none", paged,
+                              ct10::core::UntracedExecutionEngine(), false,
+                              false));
+  cases.push_back(ProgramCase("trace/ring", paged,
+                              ct10::core::ExecutionEngine(), false, false,
+                              ct10::core::TraceBuffer::kDefaultCapacity));
+  auto stream = std::make_shared<ct10::core::TraceStream>(
+      [](std::span<const uint8_t>) {});
+  cases.push_back(ProgramCase(
+      "trace/stream", paged,
+      ct10::core::StreamingExecutionEngine(
+          ct10::core::StreamingTraceSink(stream.get())),
+      false, false));
+  // The sink only holds a pointer; keep the stream alive with the case.
+  BenchCase& streamed = cases.back();
+  streamed.run = [stream, run = streamed.run]() { return run(); };
+  return true;
+}
+
+// A machine with full memory and a few KiB in its I/O streams.
+ct10::core::MachineState StateFixture() {
+  ct10::core::MachineState state;
+  ct10::app::LoadGoldenProgram(state);
+  for (uint16_t address = 0x100; address < ct10::core::Memory::kSize;
+       ++address) {
+    state.memory.Write(address, static_cast<uint8_t>(address * 7));
+  }
+  state.io.printer_output.assign(4096, 'A');
+  state.io.terminal_output.assign(2048, 'B');
+  state.io.terminal_input.assign(1024, 'C');
+  return state;
+}
+
+void AddStateCases(std::vector<BenchCase>& cases, const fs::path& state_path) {
+  auto state = std::make_shared<ct10::core::MachineState>(StateFixture());
+  auto loaded = std::make_shared<ct10::core::MachineState>();
+
+  cases.push_back({"state/save-load", [=]() {
+                     constexpr int kRounds = 100;
+                     Work work;
+                     for (int i = 0; i < kRounds; ++i) {
+                       ct10::core::SaveState(*state, state_path.string(),
+                                             nullptr);
+                       ct10::core::LoadState(*loaded, state_path.string(),
+                                             nullptr);
+                     }
+                     work.operations = kRounds;
+                     work.bytes = kRounds * fs::file_size(state_path);
+                     return work;
+                   }});
+
+  auto bytes = std::make_shared<std::vector<uint8_t>>();
+  cases.push_back({"state/serialize", [=]() {
+                     constexpr int kRounds = 1000;
+                     Work work;
+                     for (int i = 0; i < kRounds; ++i) {
+                       ct10::core::SerializeState(*state, *bytes);
+                       ct10::core::DeserializeState(*bytes, *loaded, nullptr);
+                     }
+                     work.operations = kRounds;
+                     work.bytes = kRounds * bytes->size();
+                     return work;
+                   }});
+
+  auto snapshot = std::make_shared<ct10::core::Snapshot>();
+  cases.push_back({"state/snapshot", [=]() {
+                     constexpr int kRounds = 10000;
+                     for (int i = 0; i < kRounds; ++i) {
+                       ct10::core::CaptureState(*state, *snapshot);
+                       ct10::core::RestoreState(*loaded, *snapshot);
+                     }
+                     Work work;
+                     work.operations = kRounds;
+                     return work;
+                   }});
+}
+
+void AddTextCases(std::vector<BenchCase>& cases, const fs::path& tape_path) {
+  // About 1 MiB of source, rewriting memory many times over.
+  auto source = std::make_shared<std::string>();
+  const char* lines[] = {"LDA 80    # load", "ADD 81", "STA 82", "BUN 10",
+                         "4C 2A 00 FF"};
+  for (int i = 0; source->size() < (1u << 20); ++i) {
+    if (i % 256 == 0) {
+      char origin[16];
+      std::snprintf(origin, sizeof(origin), "@%03X\n", (i / 256) % 0x300);
+      *source += origin;
+    }
+    *source += lines[i % 5];
+    *source += '\n';
+  }
+  cases.push_back({"parse/program", [=]() {
+                     ct10::app::ProgramSpec spec;
+                     ct10::app::ParseResult result;
+                     ct10::app::ParseProgramContent(*source, spec, result);
+                     Work work;
+                     work.bytes = source->size();
+                     return work;
+                   }});
+
+  {
+    std::ofstream tape(tape_path, std::ios::binary);
+    for (int i = 0; i < (1 << 20) / 3; ++i) {
+      char byte[4];
+      std::snprintf(byte, sizeof(byte), "%02X%c", i & 0xFF,
+                    i % 16 == 15 ? '\n' : ' ');
+      tape << byte;
+    }
+  }
+  uint64_t tape_bytes = fs::file_size(tape_path);
+  cases.push_back({"tape/load", [=]() {
+                     ct10::core::IOState io;
+                     ct10::app::LoadTapeText(tape_path.string(), io, nullptr);
+                     Work work;
+                     work.bytes = tape_bytes;
+                     return work;
+                   }});
+}
+
+double Percentile(const std::vector<double>& sorted, double fraction) {
+  size_t rank = static_cast<size_t>(
+      std::max(1.0, std::ceil(fraction * static_cast<double>(sorted.size()))));
+  return sorted[std::min(rank, sorted.size()) - 1];
+}
+
+CaseResult Measure(const BenchCase& bench, const Options& options) {
+  CaseResult result;
+  result.name = bench.name;
+  for (int i = 0; i < options.warmup; ++i) {
+    bench.run();
+  }
+  std::vector<double> times;
+  for (int i = 0; i < options.reps; ++i) {
+    Clock::time_point start = Clock::now();
+    result.work = bench.run();
+    times.push_back(
+        std::chrono::duration<double, std::milli>(Clock::now() - start)
+            .count());
+  }
+  std::sort(times.begin(), times.end());
+  result.median_ms = Percentile(times, 0.5);
+  result.p99_ms = Percentile(times, 0.99);
+  result.min_ms = times.front();
+  return result;
+}
+
+double Rate(uint64_t count, double ms) {
+  return ms > 0.0 ? static_cast<double>(count) * 1000.0 / ms : 0.0;
+}
+
+std::string FormatRate(double rate, const char* unit) {
+  char text[48];
+  if (rate >= 1e9) {
+    std::snprintf(text, sizeof(text), "%.2fG %s", rate / 1e9, unit);
+  } else if (rate >= 1e6) {
+    std::snprintf(text, sizeof(text), "%.2fM %s", rate / 1e6, unit);
+  } else if (rate >= 1e3) {
+    std::snprintf(text, sizeof(text), "%.2fk %s", rate / 1e3, unit);
+  } else {
+    std::snprintf(text, sizeof(text), "%.0f %s", rate, unit);
+  }
+  return text;
+}
+
+void PrintResult(const CaseResult& result) {
+  std::string rates;
+  auto add = [&](uint64_t count, const char* unit) {
+    if (count == 0) {
+      return;
+    }
+    if (!rates.empty()) {
+      rates += ", ";
+    }
+    rates += FormatRate(Rate(count, result.median_ms), unit);
+  };
+  add(result.work.clocks, "clocks/s");
+  add(result.work.instructions, "inst/s");
+  add(result.work.operations, "ops/s");
+  add(result.work.bytes, "B/s");
+  std::printf("%-22s %10.3f %10.3f   %s\n", result.name.c_str(),
+              result.median_ms, result.p99_ms, rates.c_str());
+}
+
+bool WriteJson(const std::string& path,
+               const Options& options,
+               const std::vector<CaseResult>& results) {
+  std::FILE* out = path == "-" ? stdout : std::fopen(path.c_str(), "w");
+  if (!out) {
+    return false;
+  }
+  std::fprintf(out, "{\n");
+  std::fprintf(out, "  \"warmup\": %d,\n", options.warmup);
+  std::fprintf(out, "  \"reps\": %d,\n", options.reps);
+  std::fprintf(out, "  \"cases\": [\n");
+  for (size_t i = 0; i < results.size(); ++i) {
+    const CaseResult& result = results[i];
+    double ms = result.median_ms;
+    std::fprintf(out,
+                 "    {\"name\": \"%s\", \"median_ms\": %.4f, "
+                 "\"p99_ms\": %.4f, \"min_ms\": %.4f, \"clocks\": %llu, "
+                 "\"instructions\": %llu, \"operations\": %llu, "
+                 "\"bytes\": %llu, \"clocks_per_s\": %.0f, "
+                 "\"instructions_per_s\": %.0f, \"operations_per_s\": %.0f, "
+                 "\"bytes_per_s\": %.0f}%s\n",
+                 result.name.c_str(), ms, result.p99_ms, result.min_ms,
+                 static_cast<unsigned long long>(result.work.clocks),
+                 static_cast<unsigned long long>(result.work.instructions),
+                 static_cast<unsigned long long>(result.work.operations),
+                 static_cast<unsigned long long>(result.work.bytes),
+                 Rate(result.work.clocks, ms),
+                 Rate(result.work.instructions, ms),
+                 Rate(result.work.operations, ms),
+                 Rate(result.work.bytes, ms),
+                 i + 1 < results.size() ? "," : "");
+  }
+  std::fprintf(out, "  ]\n}\n");
+  bool ok = std::ferror(out) == 0;
+  if (out != stdout) {
+    ok = std::fclose(out) == 0 && ok;
+  }
+  return ok;
+}
+
+// A directory of this process's own under the system temp directory, so
+// concurrent runs do not share the state and tape files, removed with
+// everything in it when the run ends.
+class ScratchDir {
+ public:
+  ScratchDir() {
+    std::random_device random;
+    std::error_code error;
+    do {
+      char name[32];
+      std::snprintf(name, sizeof(name), "ct10_bench_%08x",
+                    static_cast<unsigned>(random()));
+      path_ = fs::temp_directory_path() / name;
+    } while (!fs::create_directory(path_, error) && !error);
+  }
+  ScratchDir(const ScratchDir&) = delete;
+  ScratchDir& operator=(const ScratchDir&) = delete;
+
+  ~ScratchDir() {
+    std::error_code ignored;
+    fs::remove_all(path_, ignored);
+  }
+
+  const fs::path& path() const { return path_; }
+
+ private:
+  fs::path path_;
+};
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Options options;
+  for (int i = 1; i < argc; ++i) {
+    const char* arg = argv[i];
+    bool has_value = i + 1 < argc;
+    if (std::strcmp(arg, "--warmup") == 0 && has_value) {
+      if (!ParseCount(argv[++i], options.warmup)) {
+        std::printf("FAIL: invalid --warmup value.\n");
+        return 3;
+      }
+    } else if (std::strcmp(arg, "--reps") == 0 && has_value) {
+      if (!ParseCount(argv[++i], options.reps) || options.reps == 0) {
+        std::printf("FAIL: invalid --reps value.\n");
+        return 3;
+      }
+    } else if (std::strcmp(arg, "--filter") == 0 && has_value) {
+      options.filter = argv[++i];
+    } else if (std::strcmp(arg, "--json") == 0 && has_value) {
+      options.json_path = argv[++i];
+    } else {
+      PrintUsage();
+      return 3;
+    }
+  }
+
+  ScratchDir scratch;
+  fs::path state_path = scratch.path() / "state.bin";
+  fs::path tape_path = scratch.path() / "tape.txt";
+
+  std::vector<BenchCase> cases;
+  if (!AddProgramCases(cases)) {
+    return 3;
+  }
+  AddStateCases(cases, state_path);
+  AddTextCases(cases, tape_path);
+
+  bool to_stdout = options.json_path == "-";
+  if (!to_stdout) {
+    std::printf("%-22s %10s %10s   %s\n", "case", "median ms", "p99 ms",
+                "rate at median");
+  }
+  std::vector<CaseResult> results;
+  for (const BenchCase& bench : cases) {
+    if (bench.name.find(options.filter) == std::string::npos) {
+      continue;
+    }
+    results.push_back(Measure(bench, options));
+    if (!to_stdout) {
+      PrintResult(results.back());
+    }
+  }
+
+  if (!options.json_path.empty() &&
+      !WriteJson(options.json_path, options, results)) {
+    std::printf("FAIL: unable to write %s.\n", options.json_path.c_str());
+    return 3;
+  }
+  return 0;
+}
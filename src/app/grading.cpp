@@ -0,0 +1,421 @@
+#include "app/grading.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#include "app/golden_program.h"
+#include "app/tape_io.h"
+
+namespace ct10::app {
+namespace {
+
+bool ParseIoMode(const char* text, uint8_t& mode) {
+  if (std::strcmp(text, "rexmt") == 0) {
+    mode = 3;
+    return true;
+  }
+  if (std::strcmp(text, "off") == 0) {
+    mode = 0;
+    return true;
+  }
+  if (std::strcmp(text, "octal") == 0) {
+    mode = 0;
+    return true;
+  }
+  if (std::strcmp(text, "hex") == 0) {
+    mode = 1;
+    return true;
+  }
+  if (std::strcmp(text, "alpha") == 0) {
+    mode = 2;
+    return true;
+  }
+  return false;
+}
+
+bool LoadExpectedHexFile(const std::string& path,
+                         const FileReader& read,
+                         std::vector<uint8_t>& bytes,
+                         std::string& error) {
+  std::string content;
+  if (!read(path, content)) {
+    error = "Unable to open expected output file.";
+    return false;
+  }
+  ParseResult result = ParseProgramText(content, bytes);
+  if (bytes.empty()) {
+    error = "No bytes parsed from expected output file.";
+    return false;
+  }
+  if (result.skipped > 0) {
+    error = "Expected output file contains invalid tokens.";
+    return false;
+  }
+  return true;
+}
+
+bool CompareOutput(const char* label,
+                   const std::vector<uint8_t>& actual,
+                   const std::vector<uint8_t>& expected,
+                   std::string& message) {
+  char line[128];
+  if (actual.size() != expected.size()) {
+    std::snprintf(line, sizeof(line), "FAIL: %s size %zu (expected %zu).",
+                  label, actual.size(), expected.size());
+    message = line;
+    return false;
+  }
+  for (size_t i = 0; i < expected.size(); ++i) {
+    if (actual[i] != expected[i]) {
+      std::snprintf(line, sizeof(line),
+                    "FAIL: %s byte %zu = 0x%02X (expected 0x%02X).", label, i,
+                    static_cast<unsigned>(actual[i]),
+                    static_cast<unsigned>(expected[i]));
+      message = line;
+      return false;
+    }
+  }
+  return true;
+}
+
+bool LoadInputText(const std::string& path,
+                   const FileReader& read,
+                   core::IOState& io,
+                   std::string& error) {
+  std::string content;
+  if (!read(path, content)) {
+    error = "Unable to open tape file.";
+    return false;
+  }
+  std::string parse_error;
+  if (!ParseTapeText(content, io, &parse_error)) {
+    error = parse_error;
+    return false;
+  }
+  return true;
+}
+
+const char* PhaseName(core::ClockPhase phase) {
+  switch (phase) {
+    case core::ClockPhase::CP1:
+      return "CP1";
+    case core::ClockPhase::CP2:
+      return "CP2";
+    case core::ClockPhase::CP3:
+      return "CP3";
+  }
+  return "CP3";
+}
+
+}  // namespace
+
+bool ReadFileContent(const std::string& path, std::string& content) {
+  std::ifstream file(path, std::ios::in | std::ios::binary);
+  if (!file) {
+    return false;
+  }
+  std::ostringstream buffer;
+  buffer << file.rdbuf();
+  content = buffer.str();
+  return true;
+}
+
+bool IsNumber(const char* text) {
+  if (text == nullptr || text[0] == '\0') {
+    return false;
+  }
+  char* end = nullptr;
+  std::strtol(text, &end, 10);
+  return end != text && *end == '\0';
+}
+
+bool ParseStepsValue(const char* text, int& value) {
+  char* end = nullptr;
+  long parsed = std::strtol(text, &end, 10);
+  if (end == text || parsed <= 0) {
+    return false;
+  }
+  if (parsed > 10000000) {
+    parsed = 10000000;
+  }
+  value = static_cast<int>(parsed);
+  return true;
+}
+
+JobOption ParseJobOption(int argc,
+                         char** argv,
+                         int& i,
+                         GradingJob& job,
+                         std::string& error) {
+  const char* arg = argv[i];
+  auto take_path = [&](const char* name, std::string& path) {
+    if (i + 1 < argc) {
+      path = argv[++i];
+      return JobOption::Parsed;
+    }
+    error = std::string(name) + " requires a path.";
+    return JobOption::Invalid;
+  };
+
+  if (std::strcmp(arg, "--tape") == 0) {
+    return take_path("--tape", job.tape_path);
+  }
+  if (std::strcmp(arg, "--tape-alpha") == 0) {
+    job.tape_alpha = true;
+    job.tape_hex = false;
+    return JobOption::Parsed;
+  }
+  if (std::strcmp(arg, "--tape-hex") == 0) {
+    job.tape_hex = true;
+    job.tape_alpha = false;
+    return JobOption::Parsed;
+  }
+  if (std::strcmp(arg, "--terminal-in") == 0) {
+    return take_path("--terminal-in", job.terminal_in_path);
+  }
+  if (std::strcmp(arg, "--terminal-alpha") == 0) {
+    job.terminal_alpha = true;
+    job.terminal_hex = false;
+    return JobOption::Parsed;
+  }
+  if (std::strcmp(arg, "--terminal-hex") == 0) {
+    job.terminal_hex = true;
+    job.terminal_alpha = false;
+    return JobOption::Parsed;
+  }
+  if (std::strcmp(arg, "--max-steps") == 0) {
+    if (i + 1 >= argc) {
+      error = "--max-steps requires a value.";
+      return JobOption::Invalid;
+    }
+    if (!ParseStepsValue(argv[++i], job.max_steps)) {
+      error = "invalid --max-steps value.";
+      return JobOption::Invalid;
+    }
+    job.max_steps_set = true;
+    return JobOption::Parsed;
+  }
+  if (std::strcmp(arg, "--expect-term") == 0) {
+    return take_path("--expect-term", job.expect_term_path);
+  }
+  if (std::strcmp(arg, "--expect-printer") == 0) {
+    return take_path("--expect-printer", job.expect_printer_path);
+  }
+  if (std::strcmp(arg, "--engine") == 0) {
+    if (i + 1 >= argc) {
+      error = "--engine requires a value.";
+      return JobOption::Invalid;
+    }
+    const char* engine = argv[++i];
+    if (std::strcmp(engine, "functional") == 0) {
+      job.use_functional = true;
+    } else if (std::strcmp(engine, "clock") == 0) {
+      job.use_functional = false;
+    } else {
+      error = "invalid --engine (clock|functional).";
+      return JobOption::Invalid;
+    }
+    return JobOption::Parsed;
+  }
+  if (std::strcmp(arg, "--fast-forward") == 0) {
+    job.fast_forward = true;
+    return JobOption::Parsed;
+  }
+  if (std::strcmp(arg, "--io-mode") == 0) {
+    if (i + 1 >= argc) {
+      error = "--io-mode requires a value.";
+      return JobOption::Invalid;
+    }
+    uint8_t parsed = 1;
+    if (!ParseIoMode(argv[++i], parsed)) {
+      error = "invalid --io-mode (rexmt|off|hex|alpha).";
+      return JobOption::Invalid;
+    }
+    job.io_mode = parsed;
+    job.io_mode_set = true;
+    return JobOption::Parsed;
+  }
+  return JobOption::NotOption;
+}
+
+bool LoadProgramSpec(const std::string& path,
+                     const FileReader& read,
+                     ProgramSpec& spec,
+                     std::string& error) {
+  std::string content;
+  if (!read(path, content)) {
+    error = "Unable to open program file.";
+    return false;
+  }
+  ParseResult result;
+  ParseProgramContent(content, spec, result);
+  if (spec.writes.empty()) {
+    error = "No bytes parsed from program file.";
+    return false;
+  }
+  return true;
+}
+
+bool PrepareJob(const GradingJob& job,
+                const ProgramSpec* spec,
+                const FileReader& read,
+                core::MachineState& state,
+                std::string& message) {
+  if (!spec) {
+    LoadGoldenProgram(state);
+  } else {
+    state.Reset();
+    state.memory.Clear();
+    for (const auto& write : spec->writes) {
+      if (write.address >= core::Memory::kSize) {
+        message = "FAIL: program write exceeds memory size.";
+        return false;
+      }
+      state.memory.Write(write.address, write.value);
+    }
+    state.par.Load(spec->has_entry ? spec->entry : 0x000);
+  }
+
+  uint8_t io_mode = job.io_mode;
+  if (!job.io_mode_set) {
+    if (job.tape_alpha) {
+      io_mode = 3;
+    } else if (job.tape_hex) {
+      io_mode = 2;
+    } else if (!job.terminal_in_path.empty()) {
+      io_mode = job.terminal_alpha ? 3 : 2;
+    }
+  }
+  state.panel_input.io_mode = io_mode;
+
+  if (!job.tape_path.empty()) {
+    state.io.alpha_mode = job.tape_alpha;
+    state.io.hex_mode = job.tape_hex || !job.tape_alpha;
+    std::string error;
+    if (!LoadInputText(job.tape_path, read, state.io, error)) {
+      message = "FAIL: tape load failed: " + error;
+      return false;
+    }
+  }
+
+  if (!job.terminal_in_path.empty()) {
+    if (!LoadTerminalInput(job, read, state.io.terminal_input, message)) {
+      return false;
+    }
+    state.io.terminal_input_pos = 0;
+    state.io.interrupt = false;
+  }
+  return true;
+}
+
+bool LoadTerminalInput(const GradingJob& job,
+                       const FileReader& read,
+                       std::vector<uint8_t>& terminal_input,
+                       std::string& message) {
+  core::IOState temp_io;
+  temp_io.alpha_mode = job.terminal_alpha;
+  temp_io.hex_mode = job.terminal_hex || !job.terminal_alpha;
+  std::string error;
+  if (!LoadInputText(job.terminal_in_path, read, temp_io, error)) {
+    message = "FAIL: terminal input load failed: " + error;
+    return false;
+  }
+  terminal_input = std::move(temp_io.input_data);
+  return true;
+}
+
+GradeResult GradeJob(const GradingJob& job,
+                     const ProgramSpec* spec,
+                     const core::MachineState& state,
+                     uint64_t steps,
+                     const FileReader& read) {
+  GradeResult result;
+  char line[160];
+
+  if (!state.mode.halted) {
+    std::snprintf(line, sizeof(line),
+                  "FAIL: did not halt within %d clock steps.\n", job.max_steps);
+    result.message = line;
+    std::snprintf(line, sizeof(line),
+                  "State: PAR=0x%03X OP=0x%02X MAR=0x%03X D=%u %s %s",
+                  static_cast<unsigned>(state.par.value()),
+                  static_cast<unsigned>(state.opcode.value()),
+                  static_cast<unsigned>(state.mar.value()),
+                  static_cast<unsigned>(state.timing.distributor),
+                  PhaseName(state.timing.phase),
+                  state.timing.acquisition ? "acq" : "exec");
+    result.message += line;
+    result.status = GradeStatus::NoHalt;
+    return result;
+  }
+
+  if (!spec) {
+    uint8_t value = state.memory.Read(kGoldenProgramResultAddress);
+    if (value != kGoldenProgramExpectedValue) {
+      std::snprintf(line, sizeof(line),
+                    "FAIL: memory[0x%02X] = 0x%02X (expected 0x%02X).",
+                    kGoldenProgramResultAddress, value,
+                    kGoldenProgramExpectedValue);
+      result.message = line;
+      result.status = GradeStatus::Fail;
+      return result;
+    }
+    std::snprintf(line, sizeof(line),
+                  "PASS: halted after %llu clock steps. memory[0x%02X] = "
+                  "0x%02X.",
+                  static_cast<unsigned long long>(steps),
+                  kGoldenProgramResultAddress, value);
+    result.message = line;
+    return result;
+  }
+
+  for (const auto& expect : spec->expects) {
+    uint8_t value = state.memory.Read(expect.address);
+    if (value != expect.value) {
+      std::snprintf(line, sizeof(line),
+                    "FAIL: memory[0x%02X] = 0x%02X (expected 0x%02X).",
+                    static_cast<unsigned>(expect.address),
+                    static_cast<unsigned>(value),
+                    static_cast<unsigned>(expect.value));
+      result.message = line;
+      result.status = GradeStatus::Fail;
+      return result;
+    }
+  }
+
+  struct OutputCheck {
+    const std::string& path;
+    const char* label;
+    const std::vector<uint8_t>& actual;
+  };
+  const OutputCheck checks[] = {
+      {job.expect_term_path, "terminal output", state.io.terminal_output},
+      {job.expect_printer_path, "printer output", state.io.printer_output},
+  };
+  for (const OutputCheck& check : checks) {
+    if (check.path.empty()) {
+      continue;
+    }
+    std::vector<uint8_t> expected;
+    std::string error;
+    if (!LoadExpectedHexFile(check.path, read, expected, error)) {
+      result.message = "FAIL: " + error;
+      result.status = GradeStatus::Fail;
+      return result;
+    }
+    if (!CompareOutput(check.label, check.actual, expected, result.message)) {
+      result.status = GradeStatus::Fail;
+      return result;
+    }
+  }
+
+  std::snprintf(line, sizeof(line), "PASS: halted after %llu clock steps.",
+                static_cast<unsigned long long>(steps));
+  result.message = line;
+  return result;
+}
+
+}  // namespace ct10::app
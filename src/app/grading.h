@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "app/program_text.h"
+#include "core/machine_state.h"
+
+namespace ct10::app {
+
+// One graded run: a program plus the inputs and expectations given on the
+// ct10_headless command line or a ct10_batch manifest line.
+struct GradingJob {
+  std::string program_path;
+  std::string tape_path;
+  std::string terminal_in_path;
+  std::string expect_term_path;
+  std::string expect_printer_path;
+  int max_steps = 200000;
+  bool max_steps_set = false;
+  bool tape_alpha = false;
+  bool tape_hex = false;
+  bool terminal_alpha = true;
+  bool terminal_hex = false;
+  bool io_mode_set = false;
+  uint8_t io_mode = 1;
+  bool use_functional = false;
+  bool fast_forward = false;
+};
+
+// Values double as ct10_headless exit codes.
+enum class GradeStatus : uint8_t {
+  Pass = 0,
+  Fail = 1,
+  NoHalt = 2,
+  Error = 3,
+};
+
+struct GradeResult {
+  GradeStatus status = GradeStatus::Pass;
+  std::string message;
+};
+
+enum class JobOption : uint8_t {
+  NotOption,
+  Parsed,
+  Invalid,
+};
+
+// Reads a whole file into content. Batch runs pass a caching reader so
+// inputs shared between jobs are read once.
+using FileReader =
+    std::function<bool(const std::string& path, std::string& content)>;
+
+bool ReadFileContent(const std::string& path, std::string& content);
+
+bool IsNumber(const char* text);
+bool ParseStepsValue(const char* text, int& value);
+
+// Consumes the job option at argv[i] and its value, advancing i. Returns
+// NotOption for arguments that are not job options, and Invalid with error
+// set for a missing or bad value.
+JobOption ParseJobOption(int argc,
+                         char** argv,
+                         int& i,
+                         GradingJob& job,
+                         std::string& error);
+
+bool LoadProgramSpec(const std::string& path,
+                     const FileReader& read,
+                     ProgramSpec& spec,
+                     std::string& error);
+
+// Resets state and loads the job's program (the golden program when spec is
+// null), I/O switches, tape and terminal input. On failure message holds
+// the FAIL line and the job ends with GradeStatus::Error.
+bool PrepareJob(const GradingJob& job,
+                const ProgramSpec* spec,
+                const FileReader& read,
+                core::MachineState& state,
+                std::string& message);
+
+// Reads the job's terminal input file the way PrepareJob does.
+bool LoadTerminalInput(const GradingJob& job,
+                       const FileReader& read,
+                       std::vector<uint8_t>& terminal_input,
+                       std::string& message);
+
+// Checks a finished run against the halt requirement, EXPECT lines and the
+// expected terminal and printer output.
+GradeResult GradeJob(const GradingJob& job,
+                     const ProgramSpec* spec,
+                     const core::MachineState& state,
+                     uint64_t steps,
+                     const FileReader& read);
+
+}  // namespace ct10::app
@@ -1,415 +1,950 @@
+#include <algorithm>
+#include <chrono>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <fstream>
+#include <iostream>
 #include <sstream>
 #include <string>
+#include <vector>
 
-#include "app/golden_program.h"
-#include "app/program_text.h"
-#include "app/tape_io.h"
+#include "app/grading.h"
+#include "app/panel_session.h"
+#include "core/checkpoint.h"
+#include "core/coverage.h"
 #include "core/execution_engine.h"
+#include "core/execution_history.h"
+#include "core/functional_engine.h"
+#include "core/instruction_probes.h"
+#include "core/lockstep_engine.h"
+#include "core/instruction_set.h"
 #include "core/machine_state.h"
+#include "core/microcode_coverage.h"
+#include "core/profile.h"
+#include "core/runner.h"
+#include "core/state_io.h"
 #include "core/timing_engine.h"
+#include "core/trace_file.h"
 
 namespace {
 
-void StepClock(ct10::core::TimingEngine& timing,
-               ct10::core::MachineState& state,
-               ct10::core::ExecutionEngine& execution) {
-  bool was_halted = state.mode.halted;
-  state.mode.halted = false;
-  execution.Step(state);
-  if (!state.mode.halted) {
-    state.mode.halted = was_halted;
-  }
-  timing.Advance(state.timing);
-}
-
-int ParseMaxSteps(int argc, char** argv) {
-  if (argc < 2) {
-    return 200000;
-  }
+bool ParseTraceCapacity(const char* text, size_t& value) {
   char* end = nullptr;
-  long value = std::strtol(argv[1], &end, 10);
-  if (end == argv[1] || value <= 0) {
-    return 200000;
-  }
-  if (value > 10000000) {
-    return 10000000;
-  }
-  return static_cast<int>(value);
-}
-
-bool IsNumber(const char* text) {
-  if (text == nullptr || text[0] == '\0') {
+  long parsed = std::strtol(text, &end, 10);
+  if (end == text || *end != '\0' || parsed < 0 || parsed > 1000000) {
     return false;
   }
-  char* end = nullptr;
-  std::strtol(text, &end, 10);
-  return end != text && *end == '\0';
+  value = static_cast<size_t>(parsed);
+  return true;
 }
 
-bool LoadProgramFile(const std::string& path,
-                     ct10::app::ProgramSpec& spec,
-                     ct10::app::ParseResult& result,
-                     std::string& error) {
-  std::ifstream file(path, std::ios::in | std::ios::binary);
-  if (!file) {
-    error = "Unable to open program file.";
-    return false;
-  }
-  std::ostringstream buffer;
-  buffer << file.rdbuf();
-  const std::string content = buffer.str();
-  ct10::app::ParseProgramContent(content, spec, result);
-  if (spec.writes.empty()) {
-    error = "No bytes parsed from program file.";
+bool ParseCheckpointInterval(const char* text, uint64_t& value) {
+  char* end = nullptr;
+  long long parsed = std::strtoll(text, &end, 10);
+  if (end == text || *end != '\0' || parsed <= 0) {
     return false;
   }
+  value = static_cast<uint64_t>(parsed);
   return true;
 }
 
-bool ParseStepsValue(const char* text, int& value) {
+bool ParseSweepAddress(const char* text, int& value) {
   char* end = nullptr;
-  long parsed = std::strtol(text, &end, 10);
-  if (end == text || parsed <= 0) {
+  long parsed = std::strtol(text, &end, 0);
+  if (end == text || *end != '\0' || parsed < 0 ||
+      parsed >= ct10::core::Memory::kSize) {
     return false;
   }
-  if (parsed > 10000000) {
-    parsed = 10000000;
-  }
   value = static_cast<int>(parsed);
   return true;
 }
 
-bool LoadExpectedHexFile(const std::string& path,
-                         std::vector<uint8_t>& bytes,
-                         std::string& error) {
-  std::ifstream file(path, std::ios::in | std::ios::binary);
-  if (!file) {
-    error = "Unable to open expected output file.";
-    return false;
+// Runs the prepared machine once per byte value, placed in memory at
+// sweep_address or, when it is negative, as the first terminal input byte.
+// The runs share one program image, so they go through the lockstep engine.
+int RunSweep(const ct10::app::GradingJob& job,
+             const ct10::app::ProgramSpec* spec,
+             const ct10::core::MachineState& prepared,
+             const ct10::core::TimingEngine& timing,
+             const ct10::app::FileReader& read,
+             int sweep_address) {
+  constexpr size_t kValues = 256;
+  std::vector<ct10::core::MachineState> machines(kValues, prepared);
+  for (size_t value = 0; value < kValues; ++value) {
+    ct10::core::MachineState& machine = machines[value];
+    uint8_t byte = static_cast<uint8_t>(value);
+    if (sweep_address >= 0) {
+      machine.memory.Write(static_cast<uint16_t>(sweep_address), byte);
+    } else if (machine.io.terminal_input.empty()) {
+      machine.io.terminal_input.push_back(byte);
+    } else {
+      machine.io.terminal_input[0] = byte;
+    }
   }
-  std::ostringstream buffer;
-  buffer << file.rdbuf();
-  ct10::app::ParseResult result = ct10::app::ParseProgramText(buffer.str(), bytes);
-  if (bytes.empty()) {
-    error = "No bytes parsed from expected output file.";
-    return false;
+
+  ct10::core::LockstepEngine lockstep;
+  std::vector<uint64_t> clocks(kValues);
+  lockstep.Run(machines, timing, static_cast<uint64_t>(job.max_steps), clocks);
+
+  size_t passed = 0;
+  for (size_t value = 0; value < kValues; ++value) {
+    ct10::app::GradeResult result =
+        ct10::app::GradeJob(job, spec, machines[value], clocks[value], read);
+    if (result.status == ct10::app::GradeStatus::Pass) {
+      ++passed;
+    }
+    std::string line = result.message.substr(0, result.message.find('\n'));
+    std::printf("0x%02zX: %s\n", value, line.c_str());
   }
-  if (result.skipped > 0) {
-    error = "Expected output file contains invalid tokens.";
+  std::printf("SWEEP: %zu/%zu passed (%llu vector instructions, %llu scalar "
+              "steps).\n",
+              passed, kValues,
+              static_cast<unsigned long long>(lockstep.vector_instructions()),
+              static_cast<unsigned long long>(lockstep.scalar_steps()));
+  return passed == kValues ? 0 : 1;
+}
+
+// Bytes each device moved during a run. Tape is device 0; the read-side
+// 0x11 marker a block read leaves in the output stream counts as output.
+struct DeviceBytes {
+  uint64_t tape_in = 0;
+  uint64_t tape_out = 0;
+  uint64_t terminal_in = 0;
+  uint64_t terminal_out = 0;
+  uint64_t printer_out = 0;
+};
+
+DeviceBytes DeviceMarks(const ct10::core::IOState& io) {
+  return {io.input_pos, io.output_data.size(), io.terminal_input_pos,
+          io.terminal_output.size(), io.printer_output.size()};
+}
+
+DeviceBytes DeviceBytesSince(const DeviceBytes& start,
+                             const ct10::core::IOState& io) {
+  DeviceBytes end = DeviceMarks(io);
+  return {end.tape_in - start.tape_in, end.tape_out - start.tape_out,
+          end.terminal_in - start.terminal_in,
+          end.terminal_out - start.terminal_out,
+          end.printer_out - start.printer_out};
+}
+
+double PerSecond(uint64_t count, double wall_ms) {
+  return wall_ms > 0.0 ? static_cast<double>(count) * 1000.0 / wall_ms : 0.0;
+}
+
+void PrintStats(const ct10::core::RunResult& run,
+                double wall_ms,
+                const DeviceBytes& bytes) {
+  double wait_percent =
+      run.clocks > 0 ? 100.0 * static_cast<double>(run.wait_clocks) /
+                           static_cast<double>(run.clocks)
+                     : 0.0;
+  std::printf("STATS: wall %.3f ms\n", wall_ms);
+  std::printf("STATS: %llu clocks (%.0f/s)\n",
+              static_cast<unsigned long long>(run.clocks),
+              PerSecond(run.clocks, wall_ms));
+  std::printf("STATS: %llu instructions (%.0f/s)\n",
+              static_cast<unsigned long long>(run.instructions),
+              PerSecond(run.instructions, wall_ms));
+  std::printf("STATS: %llu micro-ops (%.0f/s)\n",
+              static_cast<unsigned long long>(run.micro_ops),
+              PerSecond(run.micro_ops, wall_ms));
+  std::printf("STATS: %llu I/O wait clocks (%.2f%%)\n",
+              static_cast<unsigned long long>(run.wait_clocks), wait_percent);
+  std::printf("STATS: tape in %llu out %llu, terminal in %llu out %llu, "
+              "printer out %llu bytes\n",
+              static_cast<unsigned long long>(bytes.tape_in),
+              static_cast<unsigned long long>(bytes.tape_out),
+              static_cast<unsigned long long>(bytes.terminal_in),
+              static_cast<unsigned long long>(bytes.terminal_out),
+              static_cast<unsigned long long>(bytes.printer_out));
+}
+
+bool WriteStatsJson(const std::string& path,
+                    const ct10::core::RunResult& run,
+                    double wall_ms,
+                    const DeviceBytes& bytes) {
+  std::FILE* out = path == "-" ? stdout : std::fopen(path.c_str(), "w");
+  if (!out) {
     return false;
   }
-  return true;
+  std::fprintf(out, "{\n");
+  std::fprintf(out, "  \"wall_ms\": %.3f,\n", wall_ms);
+  std::fprintf(out, "  \"clocks\": %llu,\n",
+               static_cast<unsigned long long>(run.clocks));
+  std::fprintf(out, "  \"clocks_per_s\": %.0f,\n",
+               PerSecond(run.clocks, wall_ms));
+  std::fprintf(out, "  \"instructions\": %llu,\n",
+               static_cast<unsigned long long>(run.instructions));
+  std::fprintf(out, "  \"instructions_per_s\": %.0f,\n",
+               PerSecond(run.instructions, wall_ms));
+  std::fprintf(out, "  \"micro_ops\": %llu,\n",
+               static_cast<unsigned long long>(run.micro_ops));
+  std::fprintf(out, "  \"micro_ops_per_s\": %.0f,\n",
+               PerSecond(run.micro_ops, wall_ms));
+  std::fprintf(out, "  \"wait_clocks\": %llu,\n",
+               static_cast<unsigned long long>(run.wait_clocks));
+  std::fprintf(out,
+               "  \"devices\": {\"tape\": {\"in\": %llu, \"out\": %llu}, "
+               "\"terminal\": {\"in\": %llu, \"out\": %llu}, "
+               "\"printer\": {\"out\": %llu}}\n",
+               static_cast<unsigned long long>(bytes.tape_in),
+               static_cast<unsigned long long>(bytes.tape_out),
+               static_cast<unsigned long long>(bytes.terminal_in),
+               static_cast<unsigned long long>(bytes.terminal_out),
+               static_cast<unsigned long long>(bytes.printer_out));
+  std::fprintf(out, "}\n");
+  bool ok = std::ferror(out) == 0;
+  if (out != stdout) {
+    ok = std::fclose(out) == 0 && ok;
+  }
+  return ok;
 }
 
-bool ParseIoMode(const char* text, uint8_t& mode) {
-  if (std::strcmp(text, "rexmt") == 0) {
-    mode = 3;
-    return true;
+double Percent(uint64_t part, uint64_t whole) {
+  return whole > 0 ? 100.0 * static_cast<double>(part) /
+                         static_cast<double>(whole)
+                   : 0.0;
+}
+
+void PrintProfileRow(const char* label,
+                     const ct10::core::ProfileCounts& counts,
+                     uint64_t total_clocks) {
+  std::printf("PROFILE: %-10s %12llu %14llu %7.2f%% %12llu\n", label,
+              static_cast<unsigned long long>(counts.instructions),
+              static_cast<unsigned long long>(counts.clocks),
+              Percent(counts.clocks, total_clocks),
+              static_cast<unsigned long long>(counts.wait_clocks));
+}
+
+// Top addresses by clocks, labelled with the instruction now in memory
+// there, then every instruction run.
+void PrintProfile(const ct10::core::Profile& profile,
+                  const ct10::core::MachineState& state) {
+  constexpr size_t kTopAddresses = 20;
+  const ct10::core::ProfileCounts& total = profile.total();
+  std::printf("PROFILE: %llu instructions, %llu clocks, %.2f%% I/O wait\n",
+              static_cast<unsigned long long>(total.instructions),
+              static_cast<unsigned long long>(total.clocks),
+              Percent(total.wait_clocks, total.clocks));
+
+  std::vector<uint16_t> addresses;
+  for (uint16_t address = 0; address < ct10::core::Memory::kSize;
+       ++address) {
+    if (profile.address(address).instructions > 0) {
+      addresses.push_back(address);
+    }
   }
-  if (std::strcmp(text, "off") == 0) {
-    mode = 0;
-    return true;
+  std::stable_sort(addresses.begin(), addresses.end(),
+                   [&](uint16_t a, uint16_t b) {
+                     return profile.address(a).clocks >
+                            profile.address(b).clocks;
+                   });
+  addresses.resize(std::min(addresses.size(), kTopAddresses));
+  std::printf("PROFILE: %-10s %12s %14s %8s %12s\n", "address", "instructions",
+              "clocks", "time", "wait");
+  for (uint16_t address : addresses) {
+    const ct10::core::InstructionSpec* spec =
+        ct10::core::FindInstruction(state.memory.Read(address));
+    std::string_view mnemonic = spec ? spec->mnemonic : "???";
+    char label[16];
+    std::snprintf(label, sizeof(label), "%03X %.*s",
+                  static_cast<unsigned>(address),
+                  static_cast<int>(mnemonic.size()), mnemonic.data());
+    PrintProfileRow(label, profile.address(address), total.clocks);
   }
-  if (std::strcmp(text, "octal") == 0) {
-    mode = 0;
-    return true;
+
+  std::printf("PROFILE: %-10s %12s %14s %8s %12s\n", "opcode", "instructions",
+              "clocks", "time", "wait");
+  std::vector<ct10::core::ProfileMnemonic> rows =
+      ct10::core::ProfileByMnemonic(profile);
+  std::stable_sort(rows.begin(), rows.end(),
+                   [](const ct10::core::ProfileMnemonic& a,
+                      const ct10::core::ProfileMnemonic& b) {
+                     return a.counts.clocks > b.counts.clocks;
+                   });
+  for (const ct10::core::ProfileMnemonic& row : rows) {
+    std::string label(row.mnemonic);
+    PrintProfileRow(label.c_str(), row.counts, total.clocks);
   }
-  if (std::strcmp(text, "hex") == 0) {
-    mode = 1;
-    return true;
+
+  std::vector<ct10::core::CallRoutine> routines =
+      ct10::core::CallRoutines(profile.calls());
+  if (routines.empty()) {
+    return;
   }
-  if (std::strcmp(text, "alpha") == 0) {
-    mode = 2;
-    return true;
+  std::stable_sort(routines.begin(), routines.end(),
+                   [](const ct10::core::CallRoutine& a,
+                      const ct10::core::CallRoutine& b) {
+                     return a.inclusive_clocks > b.inclusive_clocks;
+                   });
+  std::printf("PROFILE: %-10s %12s %14s %8s %14s\n", "subroutine", "calls",
+              "inclusive", "time", "exclusive");
+  for (const ct10::core::CallRoutine& routine : routines) {
+    std::printf("PROFILE: sub_%03X    %12llu %14llu %7.2f%% %14llu\n",
+                static_cast<unsigned>(routine.entry),
+                static_cast<unsigned long long>(routine.calls),
+                static_cast<unsigned long long>(routine.inclusive_clocks),
+                Percent(routine.inclusive_clocks, total.clocks),
+                static_cast<unsigned long long>(routine.exclusive_clocks));
   }
-  return false;
 }
 
-bool CompareOutput(const char* label,
-                   const std::vector<uint8_t>& actual,
-                   const std::vector<uint8_t>& expected) {
-  if (actual.size() != expected.size()) {
-    std::printf("FAIL: %s size %zu (expected %zu).\n",
-                label, actual.size(), expected.size());
+bool WriteCollapsedStacks(const std::string& path,
+                          const ct10::core::Profile& profile) {
+  std::string stacks = ct10::core::CollapsedStacks(profile.calls());
+  std::FILE* out = path == "-" ? stdout : std::fopen(path.c_str(), "w");
+  if (!out) {
     return false;
   }
-  for (size_t i = 0; i < expected.size(); ++i) {
-    if (actual[i] != expected[i]) {
-      std::printf("FAIL: %s byte %zu = 0x%02X (expected 0x%02X).\n",
-                  label, i,
-                  static_cast<unsigned>(actual[i]),
-                  static_cast<unsigned>(expected[i]));
-      return false;
+  bool ok = std::fwrite(stacks.data(), 1, stacks.size(), out) == stacks.size();
+  if (out != stdout) {
+    ok = std::fclose(out) == 0 && ok;
+  }
+  return ok;
+}
+
+struct Checkpointing {
+  ct10::core::CheckpointRecorder* recorder = nullptr;
+  uint64_t every = 0;
+  // Clocks already run before this process, when resuming.
+  uint64_t base_clocks = 0;
+};
+
+// Grading runs use the untraced engine; --trace-capacity keeps a ring trace
+// for the saved state and --trace-out streams every record to a file. With
+// --checkpoint the run goes in slices, one checkpoint after each.
+template <typename Engine>
+ct10::core::RunResult RunMachine(Engine execution,
+                                 bool fast_forward,
+                                 ct10::core::FunctionalEngine* functional,
+                                 const ct10::core::InstructionProbes& probes,
+                                 ct10::core::MicrocodeCoverage* microcode,
+                                 ct10::core::MachineState& state,
+                                 const ct10::core::TimingEngine& timing,
+                                 const ct10::core::RunBudget& budget,
+                                 const Checkpointing& checkpoints) {
+  execution.set_fast_forward(fast_forward);
+  execution.set_microcode_coverage(microcode);
+  ct10::core::BasicRunner<Engine> runner(execution, functional, probes);
+  if (!checkpoints.recorder) {
+    return runner.Run(state, timing, budget);
+  }
+  ct10::core::RunResult total;
+  while (true) {
+    uint64_t count = std::min(checkpoints.every, budget.count - total.clocks);
+    ct10::core::RunResult slice =
+        runner.Run(state, timing, {budget.unit, count});
+    total.reason = slice.reason;
+    total.clocks += slice.clocks;
+    total.distributor_counts += slice.distributor_counts;
+    total.instructions += slice.instructions;
+    total.micro_ops += slice.micro_ops;
+    total.wait_clocks += slice.wait_clocks;
+    checkpoints.recorder->Append(state,
+                                 checkpoints.base_clocks + total.clocks);
+    if (slice.reason != ct10::core::StopReason::BudgetExhausted ||
+        total.clocks >= budget.count) {
+      return total;
     }
   }
+}
+
+bool ParseDebugUnit(const std::string& text, ct10::core::BudgetUnit& unit) {
+  if (text == "clock") {
+    unit = ct10::core::BudgetUnit::Clocks;
+  } else if (text == "dist") {
+    unit = ct10::core::BudgetUnit::DistributorCounts;
+  } else if (text == "inst") {
+    unit = ct10::core::BudgetUnit::Instructions;
+  } else {
+    return false;
+  }
   return true;
 }
 
+const char* StopReasonName(ct10::core::StopReason reason) {
+  switch (reason) {
+    case ct10::core::StopReason::Halted:
+      return "halted";
+    case ct10::core::StopReason::IoWait:
+      return "io-wait";
+    case ct10::core::StopReason::Breakpoint:
+      return "breakpoint";
+    case ct10::core::StopReason::BudgetExhausted:
+    default:
+      return "budget";
+  }
+}
+
+void PrintDebugState(const ct10::core::ExecutionHistory& history,
+                     const ct10::core::MachineState& state) {
+  std::printf("@%llu %s D%u CP%d PAR=%03X OP=%02X ACC=%02X MAR=%03X%s\n",
+              static_cast<unsigned long long>(history.position()),
+              state.timing.acquisition ? "acq" : "exec",
+              static_cast<unsigned>(state.timing.distributor),
+              static_cast<int>(state.timing.phase),
+              static_cast<unsigned>(state.par.value()),
+              static_cast<unsigned>(state.opcode.value()),
+              static_cast<unsigned>(state.accumulator.value()),
+              static_cast<unsigned>(state.mar.value()),
+              state.mode.halted ? " halted" : "");
+}
+
+// Reads debugger commands from stdin, one per line, printing the machine
+// after each:
+//   run [CLOCKS]            until halt, breakpoint or CLOCKS (max steps)
+//   step clock|dist|inst [N]
+//   back clock|dist|inst [N]
+//   back-write ADDR         to just after the last write of ADDR
+//   goto CLOCK              any clock still held in the history
+//   break ADDR              toggles a breakpoint on PAR
+//   mem ADDR
+//   quit
+int RunDebugger(ct10::core::MachineState& state,
+                const ct10::core::TimingEngine& timing,
+                const ct10::app::GradingJob& job,
+                ct10::core::FunctionalEngine* functional) {
+  ct10::core::UntracedExecutionEngine execution;
+  execution.set_fast_forward(job.fast_forward);
+  ct10::core::UntracedRunner runner(execution, functional);
+  ct10::core::ExecutionHistory history;
+  history.Reset(state);
+  ct10::core::StopConditions breaks;
+  PrintDebugState(history, state);
+
+  std::string line;
+  while (std::getline(std::cin, line)) {
+    std::istringstream in(line);
+    std::string command;
+    std::string arg;
+    std::string count_text;
+    if (!(in >> command)) {
+      continue;
+    }
+    in >> arg >> count_text;
+    char* end = nullptr;
+    uint64_t value = std::strtoull(arg.c_str(), &end, 0);
+    bool numeric = !arg.empty() && *end == '\0';
+    uint64_t count =
+        count_text.empty() ? 1 : std::strtoull(count_text.c_str(), nullptr, 0);
+    bool address = numeric && value < ct10::core::Memory::kSize;
+    uint16_t cell = static_cast<uint16_t>(value);
+    ct10::core::BudgetUnit unit = ct10::core::BudgetUnit::Clocks;
+    bool ok = true;
+    if (command == "quit") {
+      break;
+    } else if (command == "run") {
+      ok = arg.empty() || numeric;
+      uint64_t clocks =
+          arg.empty() ? static_cast<uint64_t>(job.max_steps) : value;
+      if (ok) {
+        ct10::core::RunResult run = history.Run(
+            runner, state, timing, {ct10::core::BudgetUnit::Clocks, clocks},
+            breaks);
+        std::printf("stop: %s after %llu clocks\n",
+                    StopReasonName(run.reason),
+                    static_cast<unsigned long long>(run.clocks));
+      }
+    } else if (command == "step") {
+      ok = ParseDebugUnit(arg, unit) && count > 0;
+      if (ok) {
+        ct10::core::StopConditions stop;
+        stop.halt = false;
+        history.Run(runner, state, timing, {unit, count}, stop);
+      }
+    } else if (command == "back") {
+      ok = ParseDebugUnit(arg, unit) && count > 0;
+      if (ok && !history.StepBack(state, timing, unit, count)) {
+        std::printf("ERR: at the start of the history\n");
+      }
+    } else if (command == "goto") {
+      ok = numeric;
+      if (ok && !history.Seek(state, timing, value)) {
+        std::printf("ERR: clock outside %llu..%llu\n",
+                    static_cast<unsigned long long>(history.oldest()),
+                    static_cast<unsigned long long>(history.end()));
+      }
+    } else if (command == "back-write") {
+      ok = address;
+      if (ok && !history.RunBackToWrite(state, timing, cell)) {
+        std::printf("ERR: no earlier write to 0x%03X\n", cell);
+      }
+    } else if (command == "break") {
+      ok = address;
+      if (ok) {
+        breaks.breakpoints.flip(cell);
+        std::printf("break 0x%03X %s\n", cell,
+                    breaks.breakpoints.test(cell) ? "on" : "off");
+      }
+    } else if (command == "mem") {
+      ok = address;
+      if (ok) {
+        std::printf("mem[0x%03X] = 0x%02X\n", cell,
+                    static_cast<unsigned>(state.memory.Read(cell)));
+      }
+    } else {
+      ok = false;
+    }
+    if (!ok) {
+      std::printf("ERR: bad command: %s\n", line.c_str());
+      continue;
+    }
+    PrintDebugState(history, state);
+  }
+  return 0;
+}
+
 }  // namespace
 
 int main(int argc, char** argv) {
   ct10::core::MachineState state;
   ct10::core::TimingEngine timing;
-  ct10::core::ExecutionEngine execution;
+  ct10::core::FunctionalEngine functional;
 
+  ct10::app::GradingJob job;
   ct10::app::ProgramSpec program_spec;
-  bool has_program_spec = false;
-  std::string program_path;
-  std::string tape_path;
-  std::string terminal_in_path;
-  std::string expect_term_path;
-  std::string expect_printer_path;
-  int max_steps = 200000;
-  bool max_steps_set = false;
-  bool tape_alpha = false;
-  bool tape_hex = false;
-  bool terminal_alpha = true;
-  bool terminal_hex = false;
-  bool io_mode_set = false;
-  uint8_t io_mode = state.panel_input.io_mode;
+  std::string save_state_path;
+  std::string load_state_path;
+  ct10::core::StateSaveOptions save_options;
+  size_t trace_capacity = 0;
+  std::string trace_out_path;
+  bool sweep = false;
+  int sweep_address = -1;
+  std::string checkpoint_path;
+  std::string resume_path;
+  bool debug = false;
+  bool stats = false;
+  std::string stats_json_path;
+  bool profile_run = false;
+  std::string stacks_path;
+  std::string coverage_path;
+  std::string microcode_path;
+  std::string replay_path;
+  // About 4096 instructions.
+  uint64_t checkpoint_every = 96 * 4096;
 
   for (int i = 1; i < argc; ++i) {
     const char* arg = argv[i];
-    if (std::strcmp(arg, "--tape") == 0) {
+    std::string error;
+    ct10::app::JobOption option =
+        ct10::app::ParseJobOption(argc, argv, i, job, error);
+    if (option == ct10::app::JobOption::Invalid) {
+      std::printf("FAIL: %s\n", error.c_str());
+      return 3;
+    }
+    if (option == ct10::app::JobOption::Parsed) {
+      continue;
+    }
+    if (std::strcmp(arg, "--save-state") == 0) {
       if (i + 1 < argc) {
-        tape_path = argv[++i];
+        save_state_path = argv[++i];
       } else {
-        std::printf("FAIL: --tape requires a path.\n");
+        std::printf("FAIL: --save-state requires a path.\n");
         return 3;
       }
       continue;
     }
-    if (std::strcmp(arg, "--tape-alpha") == 0) {
-      tape_alpha = true;
-      tape_hex = false;
+    if (std::strcmp(arg, "--load-state") == 0) {
+      if (i + 1 < argc) {
+        load_state_path = argv[++i];
+      } else {
+        std::printf("FAIL: --load-state requires a path.\n");
+        return 3;
+      }
       continue;
     }
-    if (std::strcmp(arg, "--tape-hex") == 0) {
-      tape_hex = true;
-      tape_alpha = false;
+    if (std::strcmp(arg, "--compress-state") == 0) {
+      save_options.compress_streams = true;
       continue;
     }
-    if (std::strcmp(arg, "--terminal-in") == 0) {
+    if (std::strcmp(arg, "--trace-out") == 0) {
       if (i + 1 < argc) {
-        terminal_in_path = argv[++i];
+        trace_out_path = argv[++i];
       } else {
-        std::printf("FAIL: --terminal-in requires a path.\n");
+        std::printf("FAIL: --trace-out requires a path.\n");
         return 3;
       }
       continue;
     }
-    if (std::strcmp(arg, "--terminal-alpha") == 0) {
-      terminal_alpha = true;
-      terminal_hex = false;
+    if (std::strcmp(arg, "--trace-capacity") == 0) {
+      if (i + 1 < argc) {
+        if (!ParseTraceCapacity(argv[++i], trace_capacity)) {
+          std::printf("FAIL: invalid --trace-capacity value.\n");
+          return 3;
+        }
+      } else {
+        std::printf("FAIL: --trace-capacity requires a value.\n");
+        return 3;
+      }
       continue;
     }
-    if (std::strcmp(arg, "--terminal-hex") == 0) {
-      terminal_hex = true;
-      terminal_alpha = false;
+    if (std::strcmp(arg, "--checkpoint") == 0) {
+      if (i + 1 < argc) {
+        checkpoint_path = argv[++i];
+      } else {
+        std::printf("FAIL: --checkpoint requires a path.\n");
+        return 3;
+      }
       continue;
     }
-    if (std::strcmp(arg, "--max-steps") == 0) {
+    if (std::strcmp(arg, "--checkpoint-every") == 0) {
       if (i + 1 < argc) {
-        if (!ParseStepsValue(argv[++i], max_steps)) {
-          std::printf("FAIL: invalid --max-steps value.\n");
+        if (!ParseCheckpointInterval(argv[++i], checkpoint_every)) {
+          std::printf("FAIL: invalid --checkpoint-every value.\n");
           return 3;
         }
-        max_steps_set = true;
       } else {
-        std::printf("FAIL: --max-steps requires a value.\n");
+        std::printf("FAIL: --checkpoint-every requires a value.\n");
         return 3;
       }
       continue;
     }
-    if (std::strcmp(arg, "--expect-term") == 0) {
+    if (std::strcmp(arg, "--resume") == 0) {
       if (i + 1 < argc) {
-        expect_term_path = argv[++i];
+        resume_path = argv[++i];
       } else {
-        std::printf("FAIL: --expect-term requires a path.\n");
+        std::printf("FAIL: --resume requires a path.\n");
         return 3;
       }
       continue;
     }
-    if (std::strcmp(arg, "--expect-printer") == 0) {
+    if (std::strcmp(arg, "--sweep") == 0) {
       if (i + 1 < argc) {
-        expect_printer_path = argv[++i];
+        if (!ParseSweepAddress(argv[++i], sweep_address)) {
+          std::printf("FAIL: invalid --sweep address.\n");
+          return 3;
+        }
       } else {
-        std::printf("FAIL: --expect-printer requires a path.\n");
+        std::printf("FAIL: --sweep requires an address.\n");
         return 3;
       }
+      sweep = true;
       continue;
     }
-    if (std::strcmp(arg, "--io-mode") == 0) {
+    if (std::strcmp(arg, "--replay-panel") == 0) {
       if (i + 1 < argc) {
-        uint8_t parsed = 1;
-        if (!ParseIoMode(argv[++i], parsed)) {
-          std::printf("FAIL: invalid --io-mode (rexmt|off|hex|alpha).\n");
-          return 3;
-        }
-        io_mode = parsed;
-        io_mode_set = true;
+        replay_path = argv[++i];
+      } else {
+        std::printf("FAIL: --replay-panel requires a path.\n");
+        return 3;
+      }
+      continue;
+    }
+    if (std::strcmp(arg, "--stats") == 0) {
+      stats = true;
+      continue;
+    }
+    if (std::strcmp(arg, "--stats-json") == 0) {
+      if (i + 1 < argc) {
+        stats_json_path = argv[++i];
+      } else {
+        std::printf("FAIL: --stats-json requires a path.\n");
+        return 3;
+      }
+      continue;
+    }
+    if (std::strcmp(arg, "--profile") == 0) {
+      profile_run = true;
+      continue;
+    }
+    if (std::strcmp(arg, "--profile-stacks") == 0) {
+      if (i + 1 < argc) {
+        stacks_path = argv[++i];
+      } else {
+        std::printf("FAIL: --profile-stacks requires a path.\n");
+        return 3;
+      }
+      continue;
+    }
+    if (std::strcmp(arg, "--coverage") == 0) {
+      if (i + 1 < argc) {
+        coverage_path = argv[++i];
+      } else {
+        std::printf("FAIL: --coverage requires a path.\n");
+        return 3;
+      }
+      continue;
+    }
+    if (std::strcmp(arg, "--microcode-coverage") == 0) {
+      if (i + 1 < argc) {
+        microcode_path = argv[++i];
       } else {
-        std::printf("FAIL: --io-mode requires a value.\n");
+        std::printf("FAIL: --microcode-coverage requires a path.\n");
         return 3;
       }
       continue;
     }
-    if (IsNumber(arg) && !max_steps_set) {
-      if (ParseStepsValue(arg, max_steps)) {
-        max_steps_set = true;
+    if (std::strcmp(arg, "--debug") == 0) {
+      debug = true;
+      continue;
+    }
+    if (std::strcmp(arg, "--sweep-terminal") == 0) {
+      sweep = true;
+      sweep_address = -1;
+      continue;
+    }
+    if (ct10::app::IsNumber(arg) && !job.max_steps_set) {
+      if (ct10::app::ParseStepsValue(arg, job.max_steps)) {
+        job.max_steps_set = true;
       }
       continue;
     }
-    if (program_path.empty()) {
-      program_path = arg;
+    if (job.program_path.empty()) {
+      job.program_path = arg;
     }
   }
 
-  bool check_expected = program_path.empty();
-  if (check_expected) {
-    ct10::app::LoadGoldenProgram(state);
-  } else {
-    state.Reset();
-    state.memory.Clear();
-    ct10::app::ParseResult parse_result;
+  const ct10::app::FileReader read = ct10::app::ReadFileContent;
+  const ct10::app::ProgramSpec* spec = nullptr;
+  if (!job.program_path.empty()) {
     std::string error;
-    if (!LoadProgramFile(program_path, program_spec, parse_result, error)) {
+    if (!ct10::app::LoadProgramSpec(job.program_path, read, program_spec,
+                                    error)) {
       std::printf("FAIL: %s\n", error.c_str());
       return 3;
     }
-    has_program_spec = true;
-    for (const auto& write : program_spec.writes) {
-      if (write.address >= ct10::core::Memory::kSize) {
-        std::printf("FAIL: program write exceeds memory size.\n");
-        return 3;
-      }
-      state.memory.Write(write.address, write.value);
+    spec = &program_spec;
+  }
+  std::string message;
+  if (!ct10::app::PrepareJob(job, spec, read, state, message)) {
+    std::printf("%s\n", message.c_str());
+    return 3;
+  }
+
+  state.trace.set_capacity(trace_capacity);
+  timing.Reset(state.timing);
+
+  if ((stats || !stats_json_path.empty()) &&
+      (sweep || debug || !replay_path.empty())) {
+    std::printf(
+        "FAIL: --stats cannot be combined with sweeps, --debug or "
+        "--replay-panel.\n");
+    return 3;
+  }
+  if ((profile_run || !stacks_path.empty()) &&
+      (sweep || debug || !replay_path.empty())) {
+    std::printf(
+        "FAIL: --profile cannot be combined with sweeps, --debug or "
+        "--replay-panel.\n");
+    return 3;
+  }
+  if (!coverage_path.empty() && (sweep || debug || !replay_path.empty())) {
+    std::printf(
+        "FAIL: --coverage cannot be combined with sweeps, --debug or "
+        "--replay-panel.\n");
+    return 3;
+  }
+  if (!microcode_path.empty() && (sweep || debug || !replay_path.empty())) {
+    std::printf(
+        "FAIL: --microcode-coverage cannot be combined with sweeps, --debug "
+        "or --replay-panel.\n");
+    return 3;
+  }
+
+  if (sweep) {
+    if (!trace_out_path.empty() || trace_capacity > 0 ||
+        !save_state_path.empty() || !load_state_path.empty() ||
+        !checkpoint_path.empty() || !resume_path.empty() || debug ||
+        !replay_path.empty()) {
+      std::printf(
+          "FAIL: sweeps cannot be combined with tracing, checkpoints, "
+          "--debug, --replay-panel or saved states.\n");
+      return 3;
     }
-    uint16_t entry = program_spec.has_entry ? program_spec.entry : 0x000;
-    state.par.Load(entry);
-    check_expected = !program_spec.expects.empty();
+    return RunSweep(job, spec, state, timing, read, sweep_address);
   }
 
-  if (!io_mode_set) {
-    if (tape_alpha) {
-      io_mode = 3;
-    } else if (tape_hex) {
-      io_mode = 2;
-    } else if (!terminal_in_path.empty()) {
-      io_mode = terminal_alpha ? 3 : 2;
+  if (debug) {
+    if (!trace_out_path.empty() || !save_state_path.empty() ||
+        !load_state_path.empty() || !checkpoint_path.empty() ||
+        !resume_path.empty() || !replay_path.empty()) {
+      std::printf(
+          "FAIL: --debug cannot be combined with --trace-out, checkpoints, "
+          "--replay-panel or saved states.\n");
+      return 3;
     }
+    return RunDebugger(state, timing, job,
+                       job.use_functional ? &functional : nullptr);
   }
-  state.panel_input.io_mode = io_mode;
 
-  if (!tape_path.empty()) {
-    state.io.alpha_mode = tape_alpha;
-    state.io.hex_mode = tape_hex || !tape_alpha;
+  if (!replay_path.empty() &&
+      (!trace_out_path.empty() || !checkpoint_path.empty() ||
+       !resume_path.empty() || !load_state_path.empty())) {
+    std::printf(
+        "FAIL: --replay-panel cannot be combined with --trace-out, "
+        "checkpoints or --load-state.\n");
+    return 3;
+  }
+  if (!load_state_path.empty() && !resume_path.empty()) {
+    std::printf("FAIL: --load-state cannot be combined with --resume.\n");
+    return 3;
+  }
+
+  uint64_t max_steps = static_cast<uint64_t>(job.max_steps);
+  if (!load_state_path.empty()) {
     std::string error;
-    if (!ct10::app::LoadTapeText(tape_path, state.io, &error)) {
-      std::printf("FAIL: tape load failed: %s\n", error.c_str());
+    if (!ct10::core::LoadState(state, load_state_path, &error)) {
+      std::printf("FAIL: state load failed: %s\n", error.c_str());
       return 3;
     }
   }
-
-  if (!terminal_in_path.empty()) {
-    ct10::core::IOState temp_io;
-    temp_io.alpha_mode = terminal_alpha;
-    temp_io.hex_mode = terminal_hex || !terminal_alpha;
+  Checkpointing checkpoints;
+  if (!resume_path.empty()) {
     std::string error;
-    if (!ct10::app::LoadTapeText(terminal_in_path, temp_io, &error)) {
-      std::printf("FAIL: terminal input load failed: %s\n", error.c_str());
+    if (!ct10::core::LoadCheckpoints(resume_path, state,
+                                     checkpoints.base_clocks, &error)) {
+      std::printf("FAIL: resume failed: %s\n", error.c_str());
       return 3;
     }
-    state.io.terminal_input = std::move(temp_io.input_data);
-    state.io.terminal_input_pos = 0;
-    state.io.interrupt = false;
   }
-
-  timing.Reset(state.timing);
-
-  int steps = 0;
-  for (; steps < max_steps; ++steps) {
-    StepClock(timing, state, execution);
-    if (state.mode.halted) {
-      break;
+  ct10::core::CheckpointRecorder checkpoint_recorder;
+  if (!checkpoint_path.empty()) {
+    std::string error;
+    if (!checkpoint_recorder.Open(checkpoint_path, &error)) {
+      std::printf("FAIL: checkpoint open failed: %s\n", error.c_str());
+      return 3;
     }
+    checkpoint_recorder.Append(state, checkpoints.base_clocks);
+    checkpoints.recorder = &checkpoint_recorder;
+    checkpoints.every = checkpoint_every;
   }
 
-  if (!state.mode.halted) {
-    std::printf("FAIL: did not halt within %d clock steps.\n", max_steps);
-    std::printf("State: PAR=0x%03X OP=0x%02X MAR=0x%03X D=%u %s %s\n",
-                static_cast<unsigned>(state.par.value()),
-                static_cast<unsigned>(state.opcode.value()),
-                static_cast<unsigned>(state.mar.value()),
-                static_cast<unsigned>(state.timing.distributor),
-                state.timing.phase == ct10::core::ClockPhase::CP1
-                    ? "CP1"
-                    : (state.timing.phase == ct10::core::ClockPhase::CP2
-                           ? "CP2"
-                           : "CP3"),
-                state.timing.acquisition ? "acq" : "exec");
-    return 2;
+  // The runner would resume a halted machine, so a run resumed from its
+  // final checkpoint, or from a saved halted state, stays where it is.
+  ct10::core::RunBudget budget{
+      ct10::core::BudgetUnit::Clocks,
+      state.mode.halted
+          ? 0
+          : max_steps - std::min(max_steps, checkpoints.base_clocks)};
+  ct10::core::FunctionalEngine* engine_functional =
+      job.use_functional ? &functional : nullptr;
+  ct10::core::Profile profile;
+  ct10::core::Coverage coverage;
+  ct10::core::InstructionProbes probes;
+  if (profile_run || !stacks_path.empty()) {
+    probes.profile = &profile;
   }
-
-  if (check_expected && program_path.empty()) {
-    uint8_t result = state.memory.Read(ct10::app::kGoldenProgramResultAddress);
-    if (result != ct10::app::kGoldenProgramExpectedValue) {
-      std::printf("FAIL: memory[0x%02X] = 0x%02X (expected 0x%02X).\n",
-                  ct10::app::kGoldenProgramResultAddress, result,
-                  ct10::app::kGoldenProgramExpectedValue);
-      return 1;
+  if (!coverage_path.empty()) {
+    probes.coverage = &coverage;
+    // Runs over several tapes build up one file, checked before this run.
+    std::string error;
+    if (std::ifstream(coverage_path).good() &&
+        !ct10::core::LoadCoverage(coverage, coverage_path, &error)) {
+      std::printf("FAIL: coverage merge failed: %s\n", error.c_str());
+      return 3;
     }
-    std::printf(
-        "PASS: halted after %d clock steps. memory[0x%02X] = 0x%02X.\n",
-        steps + 1, ct10::app::kGoldenProgramResultAddress, result);
-    return 0;
   }
-
-  if (check_expected && !program_path.empty()) {
-    if (!has_program_spec) {
-      std::printf("FAIL: expectations missing program specification.\n");
+  ct10::core::MicrocodeCoverage microcode;
+  ct10::core::MicrocodeCoverage* run_microcode =
+      microcode_path.empty() ? nullptr : &microcode;
+  functional.set_microcode_coverage(run_microcode);
+  if (run_microcode) {
+    std::string error;
+    if (std::ifstream(microcode_path).good() &&
+        !ct10::core::LoadMicrocodeCoverage(microcode, microcode_path,
+                                           &error)) {
+      std::printf("FAIL: microcode coverage merge failed: %s\n",
+                  error.c_str());
       return 3;
     }
-    for (const auto& expect : program_spec.expects) {
-      uint8_t value = state.memory.Read(expect.address);
-      if (value != expect.value) {
-        std::printf("FAIL: memory[0x%02X] = 0x%02X (expected 0x%02X).\n",
-                    static_cast<unsigned>(expect.address),
-                    static_cast<unsigned>(value),
-                    static_cast<unsigned>(expect.value));
-        return 1;
-      }
+  }
+  DeviceBytes device_marks = DeviceMarks(state.io);
+  auto run_start = std::chrono::steady_clock::now();
+  ct10::core::RunResult run;
+  if (!replay_path.empty()) {
+    // The session carries its own start state and sets the clock count.
+    std::string error;
+    if (!ct10::app::ReplayPanelSession(replay_path, state, run.clocks,
+                                       &error)) {
+      std::printf("FAIL: panel replay failed: %s\n", error.c_str());
+      return 3;
+    }
+  } else if (!trace_out_path.empty()) {
+    if (job.use_functional) {
+      std::printf("FAIL: --trace-out requires --engine clock.\n");
+      return 3;
     }
+    ct10::core::TraceRecorder recorder;
+    std::string error;
+    if (!recorder.Open(trace_out_path, &error)) {
+      std::printf("FAIL: trace open failed: %s\n", error.c_str());
+      return 3;
+    }
+    run = RunMachine(ct10::core::StreamingExecutionEngine(recorder.sink()),
+                     job.fast_forward, nullptr, probes, run_microcode, state,
+                     timing, budget, checkpoints);
+    if (!recorder.Close(&error)) {
+      std::printf("FAIL: trace write failed: %s\n", error.c_str());
+      return 3;
+    }
+  } else if (trace_capacity > 0) {
+    run = RunMachine(ct10::core::ExecutionEngine(), job.fast_forward,
+                     engine_functional, probes, run_microcode, state, timing,
+                     budget, checkpoints);
+  } else {
+    run = RunMachine(ct10::core::UntracedExecutionEngine(), job.fast_forward,
+                     engine_functional, probes, run_microcode, state, timing,
+                     budget, checkpoints);
   }
 
-  if (!expect_term_path.empty()) {
-    std::vector<uint8_t> expected;
+  double wall_ms = std::chrono::duration<double, std::milli>(
+                       std::chrono::steady_clock::now() - run_start)
+                       .count();
+  DeviceBytes device_bytes = DeviceBytesSince(device_marks, state.io);
+
+  if (!checkpoint_path.empty()) {
     std::string error;
-    if (!LoadExpectedHexFile(expect_term_path, expected, error)) {
-      std::printf("FAIL: %s\n", error.c_str());
-      return 1;
+    if (!checkpoint_recorder.Close(&error)) {
+      std::printf("FAIL: checkpoint write failed: %s\n", error.c_str());
+      return 3;
     }
-    if (!CompareOutput("terminal output", state.io.terminal_output, expected)) {
-      return 1;
+  }
+
+  if (!save_state_path.empty()) {
+    std::string error;
+    if (!ct10::core::SaveState(state, save_state_path, &error,
+                               save_options)) {
+      std::printf("FAIL: save state failed: %s\n", error.c_str());
+      return 3;
     }
   }
 
-  if (!expect_printer_path.empty()) {
-    std::vector<uint8_t> expected;
+  ct10::app::GradeResult result =
+      ct10::app::GradeJob(job, spec, state,
+                          checkpoints.base_clocks + run.clocks, read);
+  std::printf("%s\n", result.message.c_str());
+  if (stats) {
+    PrintStats(run, wall_ms, device_bytes);
+  }
+  if (profile_run) {
+    PrintProfile(profile, state);
+  }
+  if (!stacks_path.empty() && !WriteCollapsedStacks(stacks_path, profile)) {
+    std::printf("FAIL: profile stacks write failed.\n");
+    return 3;
+  }
+  if (!coverage_path.empty()) {
     std::string error;
-    if (!LoadExpectedHexFile(expect_printer_path, expected, error)) {
-      std::printf("FAIL: %s\n", error.c_str());
-      return 1;
+    if (!ct10::core::SaveCoverage(coverage, coverage_path, &error)) {
+      std::printf("FAIL: coverage write failed: %s\n", error.c_str());
+      return 3;
     }
-    if (!CompareOutput("printer output", state.io.printer_output, expected)) {
-      return 1;
+  }
+  if (!microcode_path.empty()) {
+    std::string error;
+    if (!ct10::core::SaveMicrocodeCoverage(microcode, microcode_path,
+                                           &error)) {
+      std::printf("FAIL: microcode coverage write failed: %s\n",
+                  error.c_str());
+      return 3;
     }
   }
-
-  std::printf("PASS: halted after %d clock steps.\n", steps + 1);
-  return 0;
+  if (!stats_json_path.empty() &&
+      !WriteStatsJson(stats_json_path, run, wall_ms, device_bytes)) {
+    std::printf("FAIL: stats write failed.\n");
+    return 3;
+  }
+  return static_cast<int>(result.status);
 }
@@ -0,0 +1,275 @@
+#include "app/panel_controller.h"
+
+namespace ct10::app {
+namespace {
+
+constexpr uint64_t kDistributorCounts = 16;
+
+void RefreshPanelStatus(core::MachineState& state) {
+  state.status.sense = state.panel_input.sense;
+  state.status.interrupt = state.io.interrupt;
+}
+
+void ApplyRegisterLoad(core::MachineState& state) {
+  if (!state.panel_input.power_on) {
+    state.panel_input.load_pressed = false;
+    state.panel_input.load_target = core::LoadTarget::None;
+    return;
+  }
+  if (!state.panel_input.load_pressed) {
+    return;
+  }
+  uint16_t input = state.panel_input.input_switches;
+  uint8_t low8 = static_cast<uint8_t>(input & 0xFF);
+  uint16_t full10 = static_cast<uint16_t>(input & 0x3FF);
+  switch (state.panel_input.load_target) {
+    case core::LoadTarget::Accumulator:
+      state.accumulator.Load(low8);
+      break;
+    case core::LoadTarget::Buffer:
+      state.buffer.Load(low8);
+      break;
+    case core::LoadTarget::Countdown:
+      state.countdown.Load(low8);
+      break;
+    case core::LoadTarget::Distributor:
+      state.distributor.Load(static_cast<uint16_t>(low8 & 0x0F));
+      break;
+    case core::LoadTarget::Opcode:
+      state.opcode.Load(low8);
+      break;
+    case core::LoadTarget::Mar:
+      state.mar.Load(full10);
+      break;
+    case core::LoadTarget::Par:
+      state.par.Load(full10);
+      break;
+    case core::LoadTarget::Quotient:
+      state.quotient.Load(low8);
+      break;
+    case core::LoadTarget::Index:
+      state.index.Load(low8);
+      break;
+    case core::LoadTarget::None:
+    default:
+      break;
+  }
+  state.panel_input.load_pressed = false;
+  state.panel_input.load_target = core::LoadTarget::None;
+}
+
+bool ApplyManualMemory(core::MachineState& state) {
+  if (!state.panel_input.power_on) {
+    return false;
+  }
+  if (!state.panel_input.start) {
+    return false;
+  }
+  if (!state.panel_input.mem_read && !state.panel_input.mem_write) {
+    return false;
+  }
+  uint16_t address = state.mar.value();
+  if (state.panel_input.mem_write) {
+    uint8_t value = static_cast<uint8_t>(state.panel_input.input_switches & 0xFF);
+    state.memory.Write(address, value);
+    state.mar.Load(static_cast<uint16_t>(address + 1));
+  } else if (state.panel_input.mem_read) {
+    uint8_t value = state.memory.Read(address);
+    uint16_t upper = static_cast<uint16_t>(state.panel_input.input_switches & 0x300);
+    state.panel_input.input_switches =
+        static_cast<uint16_t>(upper | static_cast<uint16_t>(value));
+    state.mar.Load(static_cast<uint16_t>(address + 1));
+  }
+  return true;
+}
+
+}  // namespace
+
+void PanelController::Sync(const core::PanelInput& panel) {
+  last_power_on_ = panel.power_on;
+  last_read_intrp_ = panel.io_read && panel.io_intrp;
+  last_write_block_ = panel.io_write && panel.io_block;
+}
+
+core::RunBudget PanelController::Apply(core::MachineState& state,
+                                       core::TimingEngine& timing,
+                                       ModeController& mode,
+                                       const ResetHook& reset_hook,
+                                       bool step_clock,
+                                       bool step_distributor) {
+  RefreshPanelStatus(state);
+  ApplyPowerAndReset(state, timing, mode, reset_hook);
+  ApplyIoPreset(state);
+  ApplyRegisterLoad(state);
+
+  bool panel_step_dist = false;
+  bool panel_step_phase = false;
+  bool panel_step_inst = false;
+  if (state.panel_input.power_on) {
+    if (state.panel_input.stop) {
+      mode.SetMode(RunMode::Halted);
+    }
+    if (state.panel_input.start) {
+      if (!ApplyManualMemory(state)) {
+        switch (state.panel_input.mode) {
+          case 0:
+            panel_step_dist = true;
+            mode.SetMode(RunMode::Halted);
+            break;
+          case 1:
+            panel_step_phase = true;
+            mode.SetMode(RunMode::Halted);
+            break;
+          case 2:
+            panel_step_inst = true;
+            mode.SetMode(RunMode::Halted);
+            break;
+          case 3:
+          default:
+            mode.SetMode(RunMode::Continuous);
+            break;
+        }
+      } else {
+        mode.SetMode(RunMode::Halted);
+      }
+    }
+  } else {
+    mode.SetMode(RunMode::Halted);
+  }
+
+  state.mode.halted = mode.IsHalted();
+  if (!state.panel_input.power_on || !state.mode.halted) {
+    return {};
+  }
+  uint64_t distributor = state.timing.distributor;
+  if (panel_step_inst) {
+    // Through the rest of this half and the whole next one.
+    return {core::BudgetUnit::DistributorCounts,
+            2 * kDistributorCounts - distributor};
+  }
+  if (panel_step_phase) {
+    // To the end of the current acquisition or execution half.
+    return {core::BudgetUnit::DistributorCounts,
+            kDistributorCounts - distributor};
+  }
+  if (panel_step_dist || step_distributor) {
+    return {core::BudgetUnit::DistributorCounts, 1};
+  }
+  if (step_clock) {
+    return {core::BudgetUnit::Clocks, 1};
+  }
+  return {};
+}
+
+void PanelController::Settle(core::MachineState& state,
+                             ModeController& mode) {
+  if (state.mode.halted && !mode.IsHalted()) {
+    mode.SetMode(RunMode::Halted);
+  }
+  state.mode.halted = mode.IsHalted();
+}
+
+void PanelController::ApplyPowerAndReset(core::MachineState& state,
+                                         core::TimingEngine& timing,
+                                         ModeController& mode,
+                                         const ResetHook& reset_hook) {
+  bool power_on = state.panel_input.power_on;
+
+  if (power_on != last_power_on_) {
+    if (!power_on) {
+      state.ClearRegisters();
+      timing.Reset(state.timing);
+      mode.SetMode(RunMode::Halted);
+      state.mode.halted = true;
+      state.io.transfer_mode = core::IoTransferMode::None;
+      state.io.transfer_address = 0;
+      state.io.transfer_remaining = 0;
+      state.io.wait_cycles = 0;
+      state.panel_input.key_value = 0;
+      state.panel_input.last_key = 0;
+      state.panel_input.has_last_key = false;
+      state.panel_input.load_pressed = false;
+      state.panel_input.load_target = core::LoadTarget::None;
+    } else {
+      timing.Reset(state.timing);
+      mode.SetMode(RunMode::Halted);
+      state.mode.halted = true;
+      state.io.transfer_mode = core::IoTransferMode::None;
+      state.io.transfer_address = 0;
+      state.io.transfer_remaining = 0;
+      state.io.wait_cycles = 0;
+      state.panel_input.key_value = 0;
+      state.panel_input.last_key = 0;
+      state.panel_input.has_last_key = false;
+      state.panel_input.load_pressed = false;
+      state.panel_input.load_target = core::LoadTarget::None;
+    }
+    state.panel_input.ClearMomentary();
+    last_power_on_ = power_on;
+  }
+
+  if (!power_on) {
+    mode.SetMode(RunMode::Halted);
+    state.mode.halted = true;
+    return;
+  }
+
+  if (state.panel_input.reset && reset_hook) {
+    reset_hook(state);
+    timing.Reset(state.timing);
+    mode.SetMode(RunMode::Halted);
+    state.mode.halted = true;
+    state.io.transfer_mode = core::IoTransferMode::None;
+    state.io.transfer_address = 0;
+    state.io.transfer_remaining = 0;
+    state.io.wait_cycles = 0;
+    state.panel_input.input_switches = 0;
+    state.panel_input.key_value = 0;
+    state.panel_input.last_key = 0;
+    state.panel_input.has_last_key = false;
+  }
+
+  if (state.panel_input.clear) {
+    state.ClearRegisters();
+    timing.Reset(state.timing);
+    mode.SetMode(RunMode::Halted);
+    state.io.transfer_mode = core::IoTransferMode::None;
+    state.io.transfer_address = 0;
+    state.io.transfer_remaining = 0;
+    state.io.wait_cycles = 0;
+  }
+}
+
+void PanelController::ApplyIoPreset(core::MachineState& state) {
+  bool read_intrp = state.panel_input.io_read && state.panel_input.io_intrp;
+  bool write_block = state.panel_input.io_write && state.panel_input.io_block;
+
+  if (!state.panel_input.power_on) {
+    last_read_intrp_ = read_intrp;
+    last_write_block_ = write_block;
+    return;
+  }
+
+  if (read_intrp && !last_read_intrp_) {
+    state.opcode.Load(0xE8);
+    state.countdown.Load(0xFF);
+    state.timing.distributor = 0;
+    state.timing.phase = core::ClockPhase::CP1;
+    state.timing.acquisition = false;
+    state.distributor.Load(state.timing.distributor);
+  }
+
+  if (write_block && !last_write_block_) {
+    state.opcode.Load(0xD0);
+    state.countdown.Load(0xFF);
+    state.timing.distributor = 0;
+    state.timing.phase = core::ClockPhase::CP1;
+    state.timing.acquisition = false;
+    state.distributor.Load(state.timing.distributor);
+  }
+
+  last_read_intrp_ = read_intrp;
+  last_write_block_ = write_block;
+}
+
+}  // namespace ct10::app
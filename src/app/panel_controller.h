@@ -0,0 +1,49 @@
+#pragma once
+
+#include <functional>
+
+#include "app/mode_controller.h"
+#include "core/machine_state.h"
+#include "core/runner.h"
+#include "core/timing_engine.h"
+
+namespace ct10::app {
+
+// Applies one frame of front-panel input to the machine: power, reset and
+// clear, the I/O presets, register loads, manual memory access and the
+// start/stop switches. The frontend runs the machine afterwards; a frame
+// with no new input only refreshes the status lamps.
+class PanelController {
+ public:
+  using ResetHook = std::function<void(core::MachineState&)>;
+
+  // Takes the switches in panel as the ones seen last frame, for the
+  // controls that act when a switch changes.
+  void Sync(const core::PanelInput& panel);
+
+  // Applies state.panel_input and the step buttons, and sets
+  // state.mode.halted from mode. Returns the step to run when the machine is
+  // halted and powered, or a zero budget.
+  core::RunBudget Apply(core::MachineState& state,
+                        core::TimingEngine& timing,
+                        ModeController& mode,
+                        const ResetHook& reset_hook,
+                        bool step_clock,
+                        bool step_distributor);
+
+  // Carries a halt reached by the frame's run into mode.
+  static void Settle(core::MachineState& state, ModeController& mode);
+
+ private:
+  void ApplyPowerAndReset(core::MachineState& state,
+                          core::TimingEngine& timing,
+                          ModeController& mode,
+                          const ResetHook& reset_hook);
+  void ApplyIoPreset(core::MachineState& state);
+
+  bool last_power_on_ = true;
+  bool last_read_intrp_ = false;
+  bool last_write_block_ = false;
+};
+
+}  // namespace ct10::app
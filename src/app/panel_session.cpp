@@ -0,0 +1,416 @@
+#include "app/panel_session.h"
+
+#include <array>
+#include <cstring>
+#include <iterator>
+#include <span>
+
+#include "app/panel_controller.h"
+#include "core/checkpoint.h"
+#include "core/execution_engine.h"
+#include "core/functional_engine.h"
+#include "core/runner.h"
+#include "core/timing_engine.h"
+
+namespace ct10::app {
+namespace {
+
+constexpr size_t kHeaderBytes = sizeof(kPanelSessionMagic) + 4;
+constexpr uint8_t kStartRecord = 'S';
+constexpr uint8_t kFrameRecord = 'F';
+constexpr uint8_t kEndRecord = 'E';
+constexpr uint8_t kFrameEdited = 0x01;
+constexpr uint8_t kFrameReset = 0x02;
+constexpr uint8_t kStepClock = 0x01;
+constexpr uint8_t kStepDistributor = 0x02;
+
+using PanelBytes = std::array<uint8_t, kPanelSessionInputBytes>;
+
+PanelBytes PackPanel(const core::PanelInput& panel) {
+  return {panel.start,
+          panel.stop,
+          panel.clear,
+          panel.lamp_test,
+          panel.reset,
+          panel.power_on,
+          panel.key_pressed,
+          panel.has_last_key,
+          panel.key_value,
+          panel.last_key,
+          static_cast<uint8_t>(panel.input_switches & 0xFF),
+          static_cast<uint8_t>(panel.input_switches >> 8),
+          panel.io_mode,
+          panel.mode,
+          panel.mem_read,
+          panel.mem_write,
+          panel.load_pressed,
+          static_cast<uint8_t>(panel.load_target),
+          panel.rpt,
+          panel.sense,
+          panel.error_inst,
+          panel.error_add,
+          panel.error_div,
+          panel.io_read,
+          panel.io_write,
+          panel.io_intrp,
+          panel.io_block};
+}
+
+// False when a byte is out of range for its field.
+bool UnpackPanel(const uint8_t* bytes, core::PanelInput& panel) {
+  size_t i = 0;
+  panel.start = bytes[i++] != 0;
+  panel.stop = bytes[i++] != 0;
+  panel.clear = bytes[i++] != 0;
+  panel.lamp_test = bytes[i++] != 0;
+  panel.reset = bytes[i++] != 0;
+  panel.power_on = bytes[i++] != 0;
+  panel.key_pressed = bytes[i++] != 0;
+  panel.has_last_key = bytes[i++] != 0;
+  panel.key_value = bytes[i++];
+  panel.last_key = bytes[i++];
+  panel.input_switches = static_cast<uint16_t>(bytes[i] | (bytes[i + 1] << 8));
+  i += 2;
+  panel.io_mode = bytes[i++];
+  panel.mode = bytes[i++];
+  panel.mem_read = bytes[i++] != 0;
+  panel.mem_write = bytes[i++] != 0;
+  panel.load_pressed = bytes[i++] != 0;
+  if (bytes[i] > static_cast<uint8_t>(core::LoadTarget::Index)) {
+    return false;
+  }
+  panel.load_target = static_cast<core::LoadTarget>(bytes[i++]);
+  panel.rpt = bytes[i++] != 0;
+  panel.sense = bytes[i++] != 0;
+  panel.error_inst = bytes[i++] != 0;
+  panel.error_add = bytes[i++] != 0;
+  panel.error_div = bytes[i++] != 0;
+  panel.io_read = bytes[i++] != 0;
+  panel.io_write = bytes[i++] != 0;
+  panel.io_intrp = bytes[i++] != 0;
+  panel.io_block = bytes[i++] != 0;
+  return true;
+}
+
+bool UnpackRunMode(uint8_t byte, RunMode& mode) {
+  if (byte > static_cast<uint8_t>(RunMode::StepClock)) {
+    return false;
+  }
+  mode = static_cast<RunMode>(byte);
+  return true;
+}
+
+void PutU64(std::vector<uint8_t>& out, uint64_t value) {
+  for (int shift = 0; shift < 64; shift += 8) {
+    out.push_back(static_cast<uint8_t>(value >> shift));
+  }
+}
+
+uint64_t GetU64(const uint8_t* bytes) {
+  uint64_t value = 0;
+  for (int i = 7; i >= 0; --i) {
+    value = (value << 8) | bytes[i];
+  }
+  return value;
+}
+
+void AppendKeyframe(const core::MachineState& state,
+                    uint64_t clocks,
+                    std::vector<uint8_t>& out) {
+  core::CheckpointWriter writer;
+  writer.Append(state, clocks, out);
+}
+
+bool Fail(std::string* error, const char* message) {
+  if (error) {
+    *error = message;
+  }
+  return false;
+}
+
+}  // namespace
+
+bool PanelSessionRecorder::Open(const std::string& path,
+                                const core::MachineState& state,
+                                RunMode mode,
+                                std::string* error) {
+  out_.open(path, std::ios::binary | std::ios::trunc);
+  if (!out_) {
+    return Fail(error, "Unable to open session file for writing.");
+  }
+  std::vector<uint8_t> bytes(kPanelSessionMagic,
+                             kPanelSessionMagic + sizeof(kPanelSessionMagic));
+  for (size_t i = 0; i < 4; ++i) {
+    bytes.push_back(
+        static_cast<uint8_t>((kPanelSessionVersion >> (8 * i)) & 0xFF));
+  }
+  bytes.push_back(kStartRecord);
+  PutU64(bytes, 0);
+  bytes.push_back(static_cast<uint8_t>(mode));
+  AppendKeyframe(state, 0, bytes);
+  write_failed_ = false;
+  Write(bytes);
+  if (write_failed_) {
+    out_.close();
+    return Fail(error, "Failed to write session header.");
+  }
+
+  expected_.trace.set_capacity(0);
+  expected_.core() = state.core();
+  expected_.io = state.io;
+  expected_.panel_input = state.panel_input;
+  expected_mode_ = mode;
+  clocks_ = 0;
+  frames_ = 0;
+  return true;
+}
+
+bool PanelSessionRecorder::recording() const { return out_.is_open(); }
+
+void PanelSessionRecorder::BeginFrame(const core::MachineState& state,
+                                      RunMode mode,
+                                      bool step_clock,
+                                      bool step_distributor) {
+  if (!recording()) {
+    return;
+  }
+  frame_.clear();
+  reset_.clear();
+  flags_ = 0;
+
+  const core::PanelInput& panel = state.panel_input;
+  PanelBytes input = PackPanel(panel);
+  bool momentary = panel.start || panel.stop || panel.clear ||
+                   panel.lamp_test || panel.reset || panel.key_pressed ||
+                   panel.load_pressed;
+  // Every frame copies these into the status flags.
+  bool status = state.status.sense != panel.sense ||
+                state.status.interrupt != state.io.interrupt;
+  record_frame_ = momentary || status || step_clock || step_distributor ||
+                  mode != expected_mode_ ||
+                  input != PackPanel(expected_.panel_input);
+
+  expected_.panel_input = panel;
+  if (!core::SameCheckpointState(state, expected_)) {
+    flags_ |= kFrameEdited;
+    AppendKeyframe(state, clocks_, frame_);
+    record_frame_ = true;
+  }
+  frame_.insert(frame_.end(), input.begin(), input.end());
+  frame_.push_back(static_cast<uint8_t>(mode));
+  frame_.push_back(static_cast<uint8_t>((step_clock ? kStepClock : 0) |
+                                        (step_distributor ? kStepDistributor
+                                                          : 0)));
+}
+
+void PanelSessionRecorder::NoteReset(const core::MachineState& state) {
+  if (!recording()) {
+    return;
+  }
+  flags_ |= kFrameReset;
+  reset_.clear();
+  AppendKeyframe(state, clocks_, reset_);
+  record_frame_ = true;
+}
+
+void PanelSessionRecorder::EndFrame(const core::MachineState& state,
+                                    RunMode mode,
+                                    uint64_t clocks) {
+  if (!recording()) {
+    return;
+  }
+  if (record_frame_) {
+    std::vector<uint8_t> record;
+    record.reserve(1 + 8 + 1 + frame_.size() + reset_.size());
+    record.push_back(kFrameRecord);
+    PutU64(record, clocks_);
+    record.push_back(flags_);
+    record.insert(record.end(), frame_.begin(), frame_.end());
+    record.insert(record.end(), reset_.begin(), reset_.end());
+    Write(record);
+    ++frames_;
+    record_frame_ = false;
+  }
+  clocks_ += clocks;
+  expected_.core() = state.core();
+  expected_.io = state.io;
+  expected_.panel_input = state.panel_input;
+  expected_mode_ = mode;
+}
+
+bool PanelSessionRecorder::Close(std::string* error) {
+  if (!recording()) {
+    return true;
+  }
+  std::vector<uint8_t> record;
+  record.push_back(kEndRecord);
+  PutU64(record, clocks_);
+  Write(record);
+  out_.close();
+  if (write_failed_ || out_.fail()) {
+    return Fail(error, "Failed to write session file.");
+  }
+  return true;
+}
+
+uint64_t PanelSessionRecorder::clocks() const { return clocks_; }
+
+uint64_t PanelSessionRecorder::frames() const { return frames_; }
+
+void PanelSessionRecorder::Write(const std::vector<uint8_t>& bytes) {
+  if (write_failed_) {
+    return;
+  }
+  out_.write(reinterpret_cast<const char*>(bytes.data()),
+             static_cast<std::streamsize>(bytes.size()));
+  out_.flush();
+  write_failed_ = !out_;
+}
+
+bool ReplayPanelSession(const std::string& path,
+                        core::MachineState& state,
+                        uint64_t& clocks,
+                        std::string* error) {
+  std::ifstream in(path, std::ios::binary);
+  if (!in) {
+    return Fail(error, "Unable to open session file for reading.");
+  }
+  std::vector<uint8_t> bytes{std::istreambuf_iterator<char>(in),
+                             std::istreambuf_iterator<char>()};
+  std::span<const uint8_t> data(bytes);
+  if (bytes.size() < kHeaderBytes ||
+      std::memcmp(bytes.data(), kPanelSessionMagic,
+                  sizeof(kPanelSessionMagic)) != 0) {
+    return Fail(error, "Invalid session file header.");
+  }
+  uint32_t version = 0;
+  for (size_t i = 0; i < 4; ++i) {
+    version |= static_cast<uint32_t>(bytes[sizeof(kPanelSessionMagic) + i])
+               << (8 * i);
+  }
+  if (version != kPanelSessionVersion) {
+    return Fail(error, "Unsupported session file version.");
+  }
+
+  size_t pos = kHeaderBytes;
+  uint64_t record_clocks = 0;
+  if (bytes.size() - pos < 1 + 8 + 1 || bytes[pos] != kStartRecord) {
+    return Fail(error, "Session file does not start with a start record.");
+  }
+  RunMode run_mode = RunMode::Halted;
+  if (!UnpackRunMode(bytes[pos + 9], run_mode)) {
+    return Fail(error, "Session frame has an out-of-range field.");
+  }
+  ModeController mode;
+  mode.SetMode(run_mode);
+  pos += 1 + 8 + 1;
+  if (!core::ApplyCheckpoint(data, pos, state, record_clocks, error)) {
+    return false;
+  }
+  state.trace.Clear();
+
+  PanelController panel;
+  panel.Sync(state.panel_input);
+  core::TimingEngine timing;
+  core::UntracedExecutionEngine execution;
+  execution.set_fast_forward(true);
+  core::FunctionalEngine functional;
+  core::UntracedRunner runner(execution, &functional);
+  clocks = 0;
+
+  while (pos < bytes.size()) {
+    if (bytes.size() - pos < 1 + 8) {
+      return Fail(error, "Session record is truncated.");
+    }
+    uint8_t kind = bytes[pos];
+    record_clocks = GetU64(bytes.data() + pos + 1);
+    pos += 1 + 8;
+    if (kind != kFrameRecord && kind != kEndRecord) {
+      return Fail(error, "Unknown session record.");
+    }
+
+    // The frames between records only ran the machine on.
+    while (clocks < record_clocks) {
+      if (!state.panel_input.power_on || state.mode.halted) {
+        return Fail(error, "Replay stopped before the next recorded frame.");
+      }
+      core::RunResult run = runner.Run(
+          state, timing,
+          {core::BudgetUnit::Clocks, record_clocks - clocks});
+      clocks += run.clocks;
+      PanelController::Settle(state, mode);
+      if (run.clocks == 0) {
+        return Fail(error, "Replay stopped before the next recorded frame.");
+      }
+    }
+    if (clocks != record_clocks) {
+      return Fail(error, "Replay ran past a recorded frame.");
+    }
+    if (kind == kEndRecord) {
+      return true;
+    }
+
+    if (bytes.size() - pos < 1) {
+      return Fail(error, "Session frame is truncated.");
+    }
+    uint8_t flags = bytes[pos++];
+    uint64_t keyframe_clocks = 0;
+    if ((flags & kFrameEdited) &&
+        !core::ApplyCheckpoint(data, pos, state, keyframe_clocks, error)) {
+      return false;
+    }
+    if (bytes.size() - pos < kPanelSessionInputBytes + 2) {
+      return Fail(error, "Session frame is truncated.");
+    }
+    core::PanelInput input;
+    if (!UnpackPanel(bytes.data() + pos, input) ||
+        !UnpackRunMode(bytes[pos + kPanelSessionInputBytes], run_mode)) {
+      return Fail(error, "Session frame has an out-of-range field.");
+    }
+    state.panel_input = input;
+    pos += kPanelSessionInputBytes;
+    mode.SetMode(run_mode);
+    ++pos;
+    uint8_t steps = bytes[pos++];
+
+    // The recorded machine stands in for the reset hook.
+    PanelController::ResetHook reset_hook;
+    bool reset_ok = true;
+    std::string reset_error;
+    if (flags & kFrameReset) {
+      size_t reset_pos = pos;
+      uint32_t length = 0;
+      if (bytes.size() - pos >= 4) {
+        for (size_t i = 0; i < 4; ++i) {
+          length |= static_cast<uint32_t>(bytes[pos + i]) << (8 * i);
+        }
+      }
+      if (bytes.size() - pos < 4 || bytes.size() - pos - 4 < length) {
+        return Fail(error, "Session reset record is truncated.");
+      }
+      pos += 4 + length;
+      reset_hook = [&](core::MachineState& target) {
+        size_t at = reset_pos;
+        uint64_t reset_clocks = 0;
+        reset_ok = core::ApplyCheckpoint(data, at, target, reset_clocks,
+                                         &reset_error);
+      };
+    }
+
+    core::RunBudget step =
+        panel.Apply(state, timing, mode, reset_hook,
+                    (steps & kStepClock) != 0, (steps & kStepDistributor) != 0);
+    if (!reset_ok) {
+      return Fail(error, reset_error.c_str());
+    }
+    if (step.count > 0) {
+      core::StopConditions stop;
+      stop.halt = false;
+      clocks += runner.Run(state, timing, step, stop).clocks;
+    }
+    PanelController::Settle(state, mode);
+  }
+  return true;
+}
+
+}  // namespace ct10::app
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "app/mode_controller.h"
+#include "core/machine_state.h"
+
+namespace ct10::app {
+
+// A panel session file is an 8-byte magic and a u32 version, then records
+// of a kind byte and the clocks run since recording started (u64):
+//   'S' start: mode (u8), a checkpoint keyframe (core/checkpoint.h)
+//   'F' frame: flags (u8), a keyframe when the machine was changed off the
+//       panel, the panel switches (kPanelSessionInputBytes), mode (u8), step
+//       buttons (u8), a keyframe of the machine left by a panel reset
+//   'E' end
+// Only frames that could change the machine other than by running it are
+// recorded; the replay runs through the rest in one go. Values are little
+// endian.
+inline constexpr char kPanelSessionMagic[8] = {'C', 'T', '1', '0',
+                                               'P', 'N', 'L', '1'};
+inline constexpr uint32_t kPanelSessionVersion = 1;
+inline constexpr size_t kPanelSessionInputBytes = 27;
+
+// Records a GUI session frame by frame. BeginFrame goes after the frame's
+// input is in place and before PanelController::Apply, NoteReset in the
+// reset hook, and EndFrame after the frame's run has settled.
+class PanelSessionRecorder {
+ public:
+  bool Open(const std::string& path,
+            const core::MachineState& state,
+            RunMode mode,
+            std::string* error);
+  bool recording() const;
+
+  void BeginFrame(const core::MachineState& state,
+                  RunMode mode,
+                  bool step_clock,
+                  bool step_distributor);
+  void NoteReset(const core::MachineState& state);
+  void EndFrame(const core::MachineState& state,
+                RunMode mode,
+                uint64_t clocks);
+
+  // False when any write failed.
+  bool Close(std::string* error);
+
+  uint64_t clocks() const;
+  uint64_t frames() const;
+
+ private:
+  void Write(const std::vector<uint8_t>& bytes);
+
+  std::ofstream out_;
+  // The machine as the last frame left it, which is where a replay would
+  // be if this frame were not recorded.
+  core::MachineState expected_;
+  RunMode expected_mode_ = RunMode::Halted;
+  std::vector<uint8_t> frame_;
+  std::vector<uint8_t> reset_;
+  bool record_frame_ = false;
+  uint8_t flags_ = 0;
+  uint64_t clocks_ = 0;
+  uint64_t frames_ = 0;
+  bool write_failed_ = false;
+};
+
+// Replays a panel session from its start state with no frame pacing,
+// leaving state where the recording ended. clocks is the clocks run.
+bool ReplayPanelSession(const std::string& path,
+                        core::MachineState& state,
+                        uint64_t& clocks,
+                        std::string* error);
+
+}  // namespace ct10::app
@@ -8,6 +8,8 @@
 #include <string_view>
 #include <vector>
 
+#include "core/instruction_set.h"
+
 namespace ct10::app {
 
 struct ParseResult {
@@ -44,52 +46,21 @@ struct AssemblerOp {
   AsmAddressing addressing;
 };
 
-inline constexpr std::array<AssemblerOp, 44> kAssemblerOps = {{
-    {"SST", 0x00, AsmAddressing::Immediate},
-    {"LCI", 0x01, AsmAddressing::Immediate},
-    {"LAI", 0x02, AsmAddressing::Immediate},
-    {"INX", 0x03, AsmAddressing::Immediate},
-    {"SKI", 0x08, AsmAddressing::Immediate},
-    {"SKS", 0x09, AsmAddressing::Immediate},
-    {"SKF", 0x0A, AsmAddressing::Immediate},
-    {"SLA", 0x0B, AsmAddressing::Immediate},
-    {"SRA", 0x10, AsmAddressing::Immediate},
-    {"OCD", 0x11, AsmAddressing::Immediate},
-    {"LXI", 0x12, AsmAddressing::Immediate},
-    {"SLL", 0x13, AsmAddressing::Immediate},
-    {"SRL", 0x18, AsmAddressing::Immediate},
-    {"AND", 0x19, AsmAddressing::Immediate},
-    {"IOR", 0x1A, AsmAddressing::Immediate},
-    {"XOR", 0x1B, AsmAddressing::Immediate},
-    {"FLC", 0x28, AsmAddressing::Immediate},
-    {"FLS", 0xF8, AsmAddressing::Immediate},
-    {"LDA", 0x20, AsmAddressing::Paged},
-    {"LCC", 0x30, AsmAddressing::Paged},
-    {"LAN", 0x38, AsmAddressing::Paged},
-    {"LDQ", 0x40, AsmAddressing::Paged},
-    {"STA", 0x48, AsmAddressing::Paged},
-    {"STX", 0x50, AsmAddressing::Paged},
-    {"STQ", 0x58, AsmAddressing::Paged},
-    {"ADD", 0x60, AsmAddressing::Paged},
-    {"SUB", 0x68, AsmAddressing::Paged},
-    {"MPY", 0x70, AsmAddressing::Paged},
-    {"DIV", 0x78, AsmAddressing::Paged},
-    {"RAO", 0x80, AsmAddressing::Paged},
-    {"RSO", 0x88, AsmAddressing::Paged},
-    {"BUN", 0x90, AsmAddressing::Paged},
-    {"BST", 0x98, AsmAddressing::Paged},
-    {"BSB", 0xA0, AsmAddressing::Paged},
-    {"BPS", 0xA8, AsmAddressing::Paged},
-    {"BZE", 0xB0, AsmAddressing::Paged},
-    {"BNG", 0xB8, AsmAddressing::Paged},
-    {"BNC", 0xC0, AsmAddressing::Paged},
-    {"BXZ", 0xC8, AsmAddressing::Paged},
-    {"WDB", 0xD0, AsmAddressing::Paged},
-    {"MNO", 0xD8, AsmAddressing::Paged},
-    {"RDB", 0xE0, AsmAddressing::Paged},
-    {"RDI", 0xE8, AsmAddressing::Paged},
-    {"MNI", 0xF0, AsmAddressing::Paged},
-}};
+constexpr std::array<AssemblerOp, core::kInstructionSet.size()>
+BuildAssemblerOps() {
+  std::array<AssemblerOp, core::kInstructionSet.size()> ops{};
+  for (size_t i = 0; i < ops.size(); ++i) {
+    const core::InstructionSpec& spec = core::kInstructionSet[i];
+    ops[i] = {spec.mnemonic, spec.opcode,
+              spec.addressing == core::AddressingMode::Paged
+                  ? AsmAddressing::Paged
+                  : AsmAddressing::Immediate};
+  }
+  return ops;
+}
+
+inline constexpr std::array<AssemblerOp, core::kInstructionSet.size()>
+    kAssemblerOps = BuildAssemblerOps();
 
 inline bool ParseHexToken(const std::string& token,
                           uint16_t& value,
@@ -21,8 +21,12 @@ bool LoadTapeText(const std::string& path,
 
   std::ostringstream buffer;
   buffer << file.rdbuf();
-  std::string content = buffer.str();
+  return ParseTapeText(buffer.str(), io, error);
+}
 
+bool ParseTapeText(const std::string& content,
+                   core::IOState& io,
+                   std::string* error) {
   std::vector<uint8_t> bytes;
   ParseResult result;
   if (io.alpha_mode) {
@@ -9,6 +9,10 @@ namespace ct10::app {
 bool LoadTapeText(const std::string& path,
                   core::IOState& io,
                   std::string* error);
+// Same as LoadTapeText for tape text already read into memory.
+bool ParseTapeText(const std::string& content,
+                   core::IOState& io,
+                   std::string* error);
 bool SaveTapeText(const std::string& path,
                   const core::IOState& io,
                   std::string* error);
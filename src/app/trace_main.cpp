@@ -0,0 +1,227 @@
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "core/instruction_set.h"
+#include "core/microcode.h"
+#include "core/trace_file.h"
+
+namespace {
+
+struct Filter {
+  bool by_par = false;
+  bool by_opcode = false;
+  uint16_t par = 0;
+  uint8_t opcode = 0;
+
+  bool Matches(const ct10::core::InstructionRecord& record) const {
+    return (!by_par || record.par == par) &&
+           (!by_opcode || record.opcode == opcode);
+  }
+  bool active() const { return by_par || by_opcode; }
+};
+
+void PrintUsage() {
+  std::printf(
+      "usage: ct10_trace dump <trace> [--par ADDR] [--opcode OP] "
+      "[--instructions]\n"
+      "       ct10_trace summary <trace> [--par ADDR] [--opcode OP]\n");
+}
+
+bool ParseNumber(const char* text, long max, long& value) {
+  char* end = nullptr;
+  long parsed = std::strtol(text, &end, 0);
+  if (end == text || *end != '\0' || parsed < 0 || parsed > max) {
+    return false;
+  }
+  value = parsed;
+  return true;
+}
+
+std::string Mnemonic(uint8_t opcode) {
+  const ct10::core::InstructionSpec* spec =
+      ct10::core::FindInstruction(opcode);
+  return spec ? std::string(spec->mnemonic) : std::string("???");
+}
+
+std::string FlagString(const ct10::core::Flags& flags) {
+  std::string out = "-------";
+  if (flags.carry) out[0] = 'C';
+  if (flags.zero) out[1] = 'Z';
+  if (flags.greater) out[2] = 'G';
+  if (flags.less) out[3] = 'L';
+  if (flags.add_overflow) out[4] = 'A';
+  if (flags.divide_overflow) out[5] = 'D';
+  if (flags.inst_error) out[6] = 'E';
+  return out;
+}
+
+void PrintInstruction(const ct10::core::InstructionRecord& record) {
+  std::printf("PAR=0x%03X OP=0x%02X %-4s A=0x%02X Q=0x%02X X=0x%02X %s\n",
+              static_cast<unsigned>(record.par),
+              static_cast<unsigned>(record.opcode),
+              Mnemonic(record.opcode).c_str(),
+              static_cast<unsigned>(record.accumulator),
+              static_cast<unsigned>(record.quotient),
+              static_cast<unsigned>(record.index),
+              FlagString(record.flags).c_str());
+}
+
+void PrintMicroOp(const ct10::core::TraceEntry& entry) {
+  std::printf("  %s D%-2u CP%u %s\n", entry.acquisition ? "A" : "E",
+              static_cast<unsigned>(entry.distributor),
+              static_cast<unsigned>(entry.phase),
+              ct10::core::MicroOpName(entry.op));
+}
+
+int Dump(ct10::core::TraceReader& reader,
+         const Filter& filter,
+         bool instructions_only) {
+  ct10::core::TraceRecord record;
+  bool matched = !filter.active();
+  while (reader.Next(record)) {
+    if (record.kind == ct10::core::TraceRecordKind::Instruction) {
+      matched = filter.Matches(record.instruction);
+      if (matched) {
+        PrintInstruction(record.instruction);
+      }
+    } else if (matched && !instructions_only) {
+      PrintMicroOp(record.micro_op);
+    }
+  }
+  return 0;
+}
+
+template <size_t N>
+std::vector<std::pair<size_t, uint64_t>> SortedCounts(
+    const std::array<uint64_t, N>& counts) {
+  std::vector<std::pair<size_t, uint64_t>> sorted;
+  for (size_t i = 0; i < N; ++i) {
+    if (counts[i] > 0) {
+      sorted.emplace_back(i, counts[i]);
+    }
+  }
+  std::stable_sort(sorted.begin(), sorted.end(),
+                   [](const auto& a, const auto& b) {
+                     return a.second > b.second;
+                   });
+  return sorted;
+}
+
+int Summarize(ct10::core::TraceReader& reader, const Filter& filter) {
+  std::array<uint64_t, 256> opcodes{};
+  std::array<uint64_t, ct10::core::Memory::kSize> pars{};
+  std::array<uint64_t, ct10::core::kMicroOpCount> micro_ops{};
+  uint64_t instruction_count = 0;
+  uint64_t micro_op_count = 0;
+
+  ct10::core::TraceRecord record;
+  bool matched = !filter.active();
+  while (reader.Next(record)) {
+    if (record.kind == ct10::core::TraceRecordKind::Instruction) {
+      matched = filter.Matches(record.instruction);
+      if (matched) {
+        ++instruction_count;
+        ++opcodes[record.instruction.opcode];
+        ++pars[record.instruction.par & ct10::core::Memory::kAddressMask];
+      }
+    } else if (matched) {
+      ++micro_op_count;
+      size_t op = static_cast<size_t>(record.micro_op.op);
+      if (op < micro_ops.size()) {
+        ++micro_ops[op];
+      }
+    }
+  }
+
+  std::printf("instructions: %llu\n",
+              static_cast<unsigned long long>(instruction_count));
+  std::printf("micro-ops: %llu\n",
+              static_cast<unsigned long long>(micro_op_count));
+
+  std::printf("\nopcodes:\n");
+  for (const auto& [opcode, count] : SortedCounts(opcodes)) {
+    std::printf("  0x%02X %-4s %llu\n", static_cast<unsigned>(opcode),
+                Mnemonic(static_cast<uint8_t>(opcode)).c_str(),
+                static_cast<unsigned long long>(count));
+  }
+
+  std::printf("\nhottest PARs:\n");
+  auto sorted_pars = SortedCounts(pars);
+  if (sorted_pars.size() > 16) {
+    sorted_pars.resize(16);
+  }
+  for (const auto& [par, count] : sorted_pars) {
+    std::printf("  0x%03X %llu\n", static_cast<unsigned>(par),
+                static_cast<unsigned long long>(count));
+  }
+
+  std::printf("\nmicro-op histogram:\n");
+  for (const auto& [op, count] : SortedCounts(micro_ops)) {
+    std::printf("  %-24s %llu\n",
+                ct10::core::MicroOpName(static_cast<ct10::core::MicroOp>(op)),
+                static_cast<unsigned long long>(count));
+  }
+  return 0;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  if (argc < 3) {
+    PrintUsage();
+    return 2;
+  }
+  std::string command = argv[1];
+  if (command != "dump" && command != "summary") {
+    PrintUsage();
+    return 2;
+  }
+
+  Filter filter;
+  bool instructions_only = false;
+  for (int i = 3; i < argc; ++i) {
+    const char* arg = argv[i];
+    long value = 0;
+    if (std::strcmp(arg, "--par") == 0 && i + 1 < argc) {
+      if (!ParseNumber(argv[++i], ct10::core::Memory::kAddressMask, value)) {
+        std::printf("FAIL: invalid --par value.\n");
+        return 2;
+      }
+      filter.by_par = true;
+      filter.par = static_cast<uint16_t>(value);
+    } else if (std::strcmp(arg, "--opcode") == 0 && i + 1 < argc) {
+      if (!ParseNumber(argv[++i], 0xFF, value)) {
+        std::printf("FAIL: invalid --opcode value.\n");
+        return 2;
+      }
+      filter.by_opcode = true;
+      filter.opcode = static_cast<uint8_t>(value);
+    } else if (std::strcmp(arg, "--instructions") == 0) {
+      instructions_only = true;
+    } else {
+      PrintUsage();
+      return 2;
+    }
+  }
+
+  ct10::core::TraceReader reader;
+  std::string error;
+  if (!reader.Open(argv[2], &error)) {
+    std::printf("FAIL: %s\n", error.c_str());
+    return 1;
+  }
+
+  int status = command == "dump" ? Dump(reader, filter, instructions_only)
+                                 : Summarize(reader, filter);
+  if (!reader.error().empty()) {
+    std::printf("FAIL: %s\n", reader.error().c_str());
+    return 1;
+  }
+  return status;
+}
@@ -1,12 +1,10 @@
 #include "core/bus.h"
 
-#include <utility>
-
 namespace ct10::core {
 
-Bus::Bus(std::string name) : name_(std::move(name)) {}
+BusId Bus::id() const { return id_; }
 
-const std::string& Bus::name() const { return name_; }
+const char* Bus::name() const { return kBusNames[static_cast<size_t>(id_)]; }
 
 bool Bus::driven() const { return driven_; }
 
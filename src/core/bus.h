@@ -1,15 +1,26 @@
 #pragma once
 
+#include <array>
+#include <cstddef>
 #include <cstdint>
-#include <string>
 
 namespace ct10::core {
 
+enum class BusId : uint8_t {
+  X,
+  Y,
+  Z,
+  F,
+};
+
+inline constexpr std::array<const char*, 4> kBusNames = {"X", "Y", "Z", "F"};
+
 class Bus {
  public:
-  explicit Bus(std::string name);
+  constexpr explicit Bus(BusId id) : id_(id) {}
 
-  const std::string& name() const;
+  BusId id() const;
+  const char* name() const;
   bool driven() const;
   bool complemented() const;
   uint16_t value() const;
@@ -18,10 +29,10 @@ class Bus {
   void Clear();
 
  private:
-  std::string name_;
   uint16_t value_ = 0;
   bool driven_ = false;
   bool complemented_ = false;
+  BusId id_;
 };
 
 }  // namespace ct10::core
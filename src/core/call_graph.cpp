@@ -0,0 +1,149 @@
+#include "core/call_graph.h"
+
+#include <algorithm>
+#include <cstdio>
+
+namespace ct10::core {
+namespace {
+
+bool CalledFrom(const std::vector<CallNode>& nodes,
+                uint32_t node,
+                uint16_t entry) {
+  for (node = nodes[node].parent; node != 0; node = nodes[node].parent) {
+    if (nodes[node].entry == entry) {
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace
+
+CallGraph::CallGraph() : nodes_(1) {}
+
+void CallGraph::Clear() {
+  nodes_.assign(1, CallNode());
+  dropped_.clear();
+  current_ = 0;
+  depth_ = 0;
+  last_address_ = 0;
+  last_opcode_ = kNoOpcode;
+}
+
+const std::vector<CallNode>& CallGraph::nodes() const { return nodes_; }
+
+uint32_t CallGraph::current() const { return current_; }
+
+void CallGraph::Call(uint16_t entry) {
+  auto drop = [&] {
+    if (dropped_.size() >= kMaxDepth) {
+      dropped_.erase(dropped_.begin());
+    }
+    dropped_.push_back(entry);
+  };
+  if (depth_ >= kMaxDepth || !dropped_.empty()) {
+    drop();
+    return;
+  }
+  uint32_t child = nodes_[current_].first_child;
+  while (child != 0 && nodes_[child].entry != entry) {
+    child = nodes_[child].next_sibling;
+  }
+  if (child == 0) {
+    if (nodes_.size() >= kMaxNodes) {
+      drop();
+      return;
+    }
+    child = static_cast<uint32_t>(nodes_.size());
+    CallNode node;
+    node.entry = entry;
+    node.parent = current_;
+    node.next_sibling = nodes_[current_].first_child;
+    nodes_.push_back(node);
+    nodes_[current_].first_child = child;
+  }
+  ++nodes_[child].calls;
+  current_ = child;
+  ++depth_;
+}
+
+void CallGraph::Return(uint16_t entry) {
+  auto dropped = std::find(dropped_.rbegin(), dropped_.rend(), entry);
+  if (dropped != dropped_.rend()) {
+    dropped_.erase(std::prev(dropped.base()), dropped_.end());
+    return;
+  }
+  uint32_t depth = depth_;
+  for (uint32_t node = current_; node != 0; node = nodes_[node].parent) {
+    --depth;
+    if (nodes_[node].entry == entry) {
+      current_ = nodes_[node].parent;
+      depth_ = depth;
+      dropped_.clear();
+      return;
+    }
+  }
+}
+
+std::vector<CallRoutine> CallRoutines(const CallGraph& graph) {
+  const std::vector<CallNode>& nodes = graph.nodes();
+  // Children always come after their parents.
+  std::vector<uint64_t> subtree(nodes.size());
+  for (size_t i = nodes.size(); i-- > 0;) {
+    subtree[i] += nodes[i].clocks;
+    if (i != 0) {
+      subtree[nodes[i].parent] += subtree[i];
+    }
+  }
+
+  std::vector<CallRoutine> routines(Memory::kSize);
+  std::vector<bool> entered(Memory::kSize);
+  for (size_t i = 1; i < nodes.size(); ++i) {
+    const CallNode& node = nodes[i];
+    CallRoutine& routine = routines[node.entry];
+    entered[node.entry] = true;
+    routine.entry = node.entry;
+    routine.calls += node.calls;
+    routine.exclusive_clocks += node.clocks;
+    if (!CalledFrom(nodes, static_cast<uint32_t>(i), node.entry)) {
+      routine.inclusive_clocks += subtree[i];
+    }
+  }
+
+  std::vector<CallRoutine> rows;
+  for (size_t entry = 0; entry < routines.size(); ++entry) {
+    if (entered[entry]) {
+      rows.push_back(routines[entry]);
+    }
+  }
+  return rows;
+}
+
+std::string CollapsedStacks(const CallGraph& graph) {
+  const std::vector<CallNode>& nodes = graph.nodes();
+  std::string out;
+  std::vector<uint32_t> path;
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    if (nodes[i].clocks == 0) {
+      continue;
+    }
+    path.clear();
+    for (uint32_t node = static_cast<uint32_t>(i); node != 0;
+         node = nodes[node].parent) {
+      path.push_back(node);
+    }
+    out += "main";
+    for (size_t j = path.size(); j-- > 0;) {
+      char frame[16];
+      std::snprintf(frame, sizeof(frame), ";sub_%03X",
+                    static_cast<unsigned>(nodes[path[j]].entry));
+      out += frame;
+    }
+    out += ' ';
+    out += std::to_string(nodes[i].clocks);
+    out += '\n';
+  }
+  return out;
+}
+
+}  // namespace ct10::core
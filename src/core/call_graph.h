@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "core/memory.h"
+
+namespace ct10::core {
+
+// One calling context: the subroutine entered and the context it was called
+// from. Node 0 is the top level, outside any subroutine.
+struct CallNode {
+  // The BSB target, where the return BUN is planted; the body starts at
+  // entry + 2.
+  uint16_t entry = 0;
+  uint32_t parent = 0;
+  uint32_t first_child = 0;
+  uint32_t next_sibling = 0;
+  uint64_t calls = 0;
+  // Clocks spent in this context and not in a deeper one.
+  uint64_t clocks = 0;
+};
+
+// Shadow call stack rebuilt from BSB linkage, fed the same instruction
+// starts and clocks as Profile. An instruction that follows a BSB enters
+// the subroutine at its address - 2; one that follows the BUN planted at a
+// subroutine's entry has returned from it, and from any subroutine it called
+// that never returned. Clocks go to the context on top of the stack, so the
+// linkage BUN counts towards the subroutine it leaves.
+class CallGraph {
+ public:
+  // Calls deeper than this, or that would need more nodes, stay in their
+  // caller's context. Their entries are remembered, up to kMaxDepth of them,
+  // so their returns do not unwind an outer call of the same subroutine.
+  static constexpr size_t kMaxDepth = 64;
+  static constexpr size_t kMaxNodes = 1u << 16;
+
+  CallGraph();
+
+  void Clear();
+
+  void Begin(uint16_t address, uint8_t opcode) {
+    uint8_t last = static_cast<uint8_t>(last_opcode_ & 0xF8);
+    if (last == kBsb) {
+      Call(static_cast<uint16_t>((address - 2) & Memory::kAddressMask));
+    } else if (last == kBun && (current_ != 0 || !dropped_.empty())) {
+      Return(last_address_);
+    }
+    last_address_ = address & Memory::kAddressMask;
+    last_opcode_ = opcode;
+  }
+
+  void AddClocks(uint64_t clocks) { nodes_[current_].clocks += clocks; }
+
+  const std::vector<CallNode>& nodes() const;
+  // Index of the context now running.
+  uint32_t current() const;
+
+ private:
+  static constexpr uint8_t kBun = 0x90;
+  static constexpr uint8_t kBsb = 0xA0;
+  // Never a BSB or BUN, so the first instruction links nothing.
+  static constexpr uint8_t kNoOpcode = 0x00;
+
+  void Call(uint16_t entry);
+  void Return(uint16_t entry);
+
+  std::vector<CallNode> nodes_;
+  // Entries of the calls dropped above current_, innermost last.
+  std::vector<uint16_t> dropped_;
+  uint32_t current_ = 0;
+  uint32_t depth_ = 0;
+  uint16_t last_address_ = 0;
+  uint8_t last_opcode_ = kNoOpcode;
+};
+
+struct CallRoutine {
+  uint16_t entry = 0;
+  uint64_t calls = 0;
+  // Clocks from entry to return, counted once however deep the recursion.
+  uint64_t inclusive_clocks = 0;
+  uint64_t exclusive_clocks = 0;
+};
+
+// One row per subroutine entered, in entry address order.
+std::vector<CallRoutine> CallRoutines(const CallGraph& graph);
+
+// Collapsed stacks for flame graph tools: one "main;sub_040;sub_080 CLOCKS"
+// line per calling context that spent clocks of its own.
+std::string CollapsedStacks(const CallGraph& graph);
+
+}  // namespace ct10::core
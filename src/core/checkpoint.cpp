@@ -0,0 +1,523 @@
+#include "core/checkpoint.h"
+
+#include <cstring>
+#include <iterator>
+
+namespace ct10::core {
+namespace {
+
+using Streams = std::array<std::vector<uint8_t>*, kCheckpointStreams>;
+using ConstStreams =
+    std::array<const std::vector<uint8_t>*, kCheckpointStreams>;
+
+Streams StreamsOf(IOState& io) {
+  return {&io.input_data, &io.output_data, &io.terminal_input,
+          &io.terminal_output, &io.printer_output};
+}
+
+ConstStreams StreamsOf(const IOState& io) {
+  return {&io.input_data, &io.output_data, &io.terminal_input,
+          &io.terminal_output, &io.printer_output};
+}
+
+template <typename Machine>
+auto RegistersOf(Machine& state) {
+  return std::array{&state.accumulator, &state.buffer,   &state.quotient,
+                    &state.index,       &state.countdown, &state.mar,
+                    &state.par,         &state.opcode,   &state.distributor};
+}
+
+template <typename Machine>
+auto BusesOf(Machine& state) {
+  return std::array{&state.x_bus, &state.y_bus, &state.z_bus, &state.f_bus};
+}
+
+// Positions of the enumerated fields in GatherCheckpointFields order.
+constexpr size_t kDistributorField = 9 + 4 * 3;
+constexpr size_t kPhaseField = kDistributorField + 1;
+constexpr size_t kTransferModeField = kPhaseField + 3 + 7 + 4 + 8;
+constexpr size_t kLoadTargetField = kTransferModeField + 4 + 16;
+constexpr uint32_t kLastDistributor = 15;
+
+}  // namespace
+
+// GatherCheckpointFields and ScatterCheckpointFields must list the fields in
+// the same order.
+void GatherCheckpointFields(const MachineState& state,
+                            CheckpointFields& fields) {
+  size_t i = 0;
+  for (const Register* reg : RegistersOf(state)) {
+    fields[i++] = reg->value();
+  }
+  for (const Bus* bus : BusesOf(state)) {
+    fields[i++] = bus->value();
+    fields[i++] = bus->driven();
+    fields[i++] = bus->complemented();
+  }
+  fields[i++] = state.timing.distributor;
+  fields[i++] = static_cast<uint32_t>(state.timing.phase);
+  fields[i++] = state.timing.acquisition;
+  fields[i++] = state.mode.halted;
+
+  const Flags& flags = state.flags;
+  fields[i++] = flags.carry;
+  fields[i++] = flags.zero;
+  fields[i++] = flags.greater;
+  fields[i++] = flags.less;
+  fields[i++] = flags.add_overflow;
+  fields[i++] = flags.divide_overflow;
+  fields[i++] = flags.inst_error;
+
+  fields[i++] = state.status.interrupt;
+  fields[i++] = state.status.sense;
+  fields[i++] = state.status.flag;
+  fields[i++] = state.status.wait;
+
+  const IOState& io = state.io;
+  fields[i++] = static_cast<uint32_t>(io.input_pos);
+  fields[i++] = static_cast<uint32_t>(io.terminal_input_pos);
+  fields[i++] = io.interrupt;
+  fields[i++] = io.last_command;
+  fields[i++] = io.status;
+  fields[i++] = io.selected_device;
+  fields[i++] = io.hex_mode;
+  fields[i++] = io.alpha_mode;
+  fields[i++] = static_cast<uint32_t>(io.transfer_mode);
+  fields[i++] = io.transfer_address;
+  fields[i++] = io.transfer_remaining;
+  fields[i++] = io.wait_cycles;
+
+  const PanelInput& panel = state.panel_input;
+  fields[i++] = panel.start;
+  fields[i++] = panel.stop;
+  fields[i++] = panel.clear;
+  fields[i++] = panel.lamp_test;
+  fields[i++] = panel.reset;
+  fields[i++] = panel.power_on;
+  fields[i++] = panel.key_pressed;
+  fields[i++] = panel.has_last_key;
+  fields[i++] = panel.key_value;
+  fields[i++] = panel.last_key;
+  fields[i++] = panel.input_switches;
+  fields[i++] = panel.io_mode;
+  fields[i++] = panel.mode;
+  fields[i++] = panel.mem_read;
+  fields[i++] = panel.mem_write;
+  fields[i++] = panel.load_pressed;
+  fields[i++] = static_cast<uint32_t>(panel.load_target);
+  fields[i++] = panel.rpt;
+  fields[i++] = panel.sense;
+  fields[i++] = panel.error_inst;
+  fields[i++] = panel.error_add;
+  fields[i++] = panel.error_div;
+  fields[i++] = panel.io_read;
+  fields[i++] = panel.io_write;
+  fields[i++] = panel.io_intrp;
+  fields[i++] = panel.io_block;
+}
+
+void ScatterCheckpointFields(const CheckpointFields& fields,
+                             MachineState& state) {
+  size_t i = 0;
+  for (Register* reg : RegistersOf(state)) {
+    reg->Load(static_cast<uint16_t>(fields[i++]));
+  }
+  for (Bus* bus : BusesOf(state)) {
+    uint16_t value = static_cast<uint16_t>(fields[i++]);
+    bool driven = fields[i++] != 0;
+    bool complemented = fields[i++] != 0;
+    if (driven) {
+      bus->Drive(value, complemented);
+    } else {
+      bus->Clear();
+    }
+  }
+  state.timing.distributor = static_cast<uint8_t>(fields[i++]);
+  state.timing.phase = static_cast<ClockPhase>(fields[i++]);
+  state.timing.acquisition = fields[i++] != 0;
+  state.mode.halted = fields[i++] != 0;
+
+  Flags& flags = state.flags;
+  flags.carry = fields[i++] != 0;
+  flags.zero = fields[i++] != 0;
+  flags.greater = fields[i++] != 0;
+  flags.less = fields[i++] != 0;
+  flags.add_overflow = fields[i++] != 0;
+  flags.divide_overflow = fields[i++] != 0;
+  flags.inst_error = fields[i++] != 0;
+
+  state.status.interrupt = fields[i++] != 0;
+  state.status.sense = fields[i++] != 0;
+  state.status.flag = fields[i++] != 0;
+  state.status.wait = fields[i++] != 0;
+
+  IOState& io = state.io;
+  io.input_pos = fields[i++];
+  io.terminal_input_pos = fields[i++];
+  io.interrupt = fields[i++] != 0;
+  io.last_command = static_cast<uint8_t>(fields[i++]);
+  io.status = static_cast<uint8_t>(fields[i++]);
+  io.selected_device = static_cast<uint8_t>(fields[i++]);
+  io.hex_mode = fields[i++] != 0;
+  io.alpha_mode = fields[i++] != 0;
+  io.transfer_mode = static_cast<IoTransferMode>(fields[i++]);
+  io.transfer_address = static_cast<uint16_t>(fields[i++]);
+  io.transfer_remaining = static_cast<uint16_t>(fields[i++]);
+  io.wait_cycles = static_cast<uint8_t>(fields[i++]);
+
+  PanelInput& panel = state.panel_input;
+  panel.start = fields[i++] != 0;
+  panel.stop = fields[i++] != 0;
+  panel.clear = fields[i++] != 0;
+  panel.lamp_test = fields[i++] != 0;
+  panel.reset = fields[i++] != 0;
+  panel.power_on = fields[i++] != 0;
+  panel.key_pressed = fields[i++] != 0;
+  panel.has_last_key = fields[i++] != 0;
+  panel.key_value = static_cast<uint8_t>(fields[i++]);
+  panel.last_key = static_cast<uint8_t>(fields[i++]);
+  panel.input_switches = static_cast<uint16_t>(fields[i++]);
+  panel.io_mode = static_cast<uint8_t>(fields[i++]);
+  panel.mode = static_cast<uint8_t>(fields[i++]);
+  panel.mem_read = fields[i++] != 0;
+  panel.mem_write = fields[i++] != 0;
+  panel.load_pressed = fields[i++] != 0;
+  panel.load_target = static_cast<LoadTarget>(fields[i++]);
+  panel.rpt = fields[i++] != 0;
+  panel.sense = fields[i++] != 0;
+  panel.error_inst = fields[i++] != 0;
+  panel.error_add = fields[i++] != 0;
+  panel.error_div = fields[i++] != 0;
+  panel.io_read = fields[i++] != 0;
+  panel.io_write = fields[i++] != 0;
+  panel.io_intrp = fields[i++] != 0;
+  panel.io_block = fields[i++] != 0;
+}
+
+bool ValidCheckpointFields(const CheckpointFields& fields) {
+  return fields[kDistributorField] <= kLastDistributor &&
+         fields[kPhaseField] >= static_cast<uint32_t>(ClockPhase::CP1) &&
+         fields[kPhaseField] <= static_cast<uint32_t>(ClockPhase::CP3) &&
+         fields[kTransferModeField] <=
+             static_cast<uint32_t>(IoTransferMode::ReadInterrupt) &&
+         fields[kLoadTargetField] <= static_cast<uint32_t>(LoadTarget::Index);
+}
+
+namespace {
+
+void PutU32(std::vector<uint8_t>& out, uint32_t value) {
+  for (int shift = 0; shift < 32; shift += 8) {
+    out.push_back(static_cast<uint8_t>(value >> shift));
+  }
+}
+
+void PutU64(std::vector<uint8_t>& out, uint64_t value) {
+  for (int shift = 0; shift < 64; shift += 8) {
+    out.push_back(static_cast<uint8_t>(value >> shift));
+  }
+}
+
+uint32_t GetU32(const uint8_t* bytes) {
+  return static_cast<uint32_t>(bytes[0]) |
+         (static_cast<uint32_t>(bytes[1]) << 8) |
+         (static_cast<uint32_t>(bytes[2]) << 16) |
+         (static_cast<uint32_t>(bytes[3]) << 24);
+}
+
+uint64_t GetU64(const uint8_t* bytes) {
+  return static_cast<uint64_t>(GetU32(bytes)) |
+         (static_cast<uint64_t>(GetU32(bytes + 4)) << 32);
+}
+
+// Bounds-checked cursor over one record.
+class RecordReader {
+ public:
+  RecordReader(const uint8_t* data, size_t size) : data_(data), size_(size) {}
+
+  const uint8_t* Take(size_t count) {
+    if (size_ - pos_ < count) {
+      return nullptr;
+    }
+    const uint8_t* bytes = data_ + pos_;
+    pos_ += count;
+    return bytes;
+  }
+
+  bool done() const { return pos_ == size_; }
+
+ private:
+  const uint8_t* data_;
+  size_t size_;
+  size_t pos_ = 0;
+};
+
+bool Fail(std::string* error, const char* message) {
+  if (error) {
+    *error = message;
+  }
+  return false;
+}
+
+}  // namespace
+
+bool SameCheckpointState(const MachineState& a, const MachineState& b) {
+  CheckpointFields a_fields;
+  CheckpointFields b_fields;
+  GatherCheckpointFields(a, a_fields);
+  GatherCheckpointFields(b, b_fields);
+  if (a_fields != b_fields || a.memory.cells() != b.memory.cells()) {
+    return false;
+  }
+  ConstStreams a_streams = StreamsOf(a.io);
+  ConstStreams b_streams = StreamsOf(b.io);
+  for (size_t i = 0; i < kCheckpointStreams; ++i) {
+    if (*a_streams[i] != *b_streams[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void CheckpointWriter::Append(const MachineState& state,
+                              uint64_t clocks,
+                              std::vector<uint8_t>& out) {
+  size_t start = out.size();
+  PutU32(out, 0);
+  out.push_back(keyframe_ ? kCheckpointKeyframe : 0);
+  PutU64(out, clocks);
+
+  uint8_t page_mask = 0;
+  for (uint16_t page = 0; page < Memory::kPages; ++page) {
+    uint64_t generation = state.memory.generation(page);
+    if (keyframe_ || generation != generations_[page]) {
+      page_mask |= static_cast<uint8_t>(1u << page);
+      generations_[page] = generation;
+    }
+  }
+  out.push_back(page_mask);
+  const uint8_t* cells = state.memory.cells().data();
+  for (uint16_t page = 0; page < Memory::kPages; ++page) {
+    if (page_mask & (1u << page)) {
+      out.insert(out.end(), cells + page * Memory::kPageSize,
+                 cells + (page + 1) * Memory::kPageSize);
+    }
+  }
+
+  CheckpointFields fields;
+  GatherCheckpointFields(state, fields);
+  size_t mask_at = out.size();
+  out.resize(mask_at + kCheckpointFieldMaskBytes, 0);
+  for (size_t i = 0; i < kCheckpointFieldCount; ++i) {
+    if (keyframe_ || fields[i] != fields_[i]) {
+      out[mask_at + i / 8] |= static_cast<uint8_t>(1u << (i % 8));
+      PutU32(out, fields[i]);
+    }
+  }
+  fields_ = fields;
+
+  ConstStreams streams = StreamsOf(state.io);
+  for (size_t i = 0; i < kCheckpointStreams; ++i) {
+    const std::vector<uint8_t>& stream = *streams[i];
+    // A stream shorter than last time was replaced, so it is sent whole.
+    size_t from = keyframe_ || stream.size() < stream_sizes_[i]
+                      ? 0
+                      : stream_sizes_[i];
+    PutU32(out, static_cast<uint32_t>(from));
+    PutU32(out, static_cast<uint32_t>(stream.size() - from));
+    out.insert(out.end(), stream.begin() + static_cast<std::ptrdiff_t>(from),
+               stream.end());
+    stream_sizes_[i] = stream.size();
+  }
+
+  uint32_t length = static_cast<uint32_t>(out.size() - start - 4);
+  for (int i = 0; i < 4; ++i) {
+    out[start + i] = static_cast<uint8_t>(length >> (8 * i));
+  }
+  keyframe_ = false;
+}
+
+void CheckpointWriter::Reset() { keyframe_ = true; }
+
+bool ApplyCheckpoint(std::span<const uint8_t> bytes,
+                     size_t& pos,
+                     MachineState& state,
+                     uint64_t& clocks,
+                     std::string* error) {
+  if (bytes.size() - pos < 4) {
+    return Fail(error, "Checkpoint record is truncated.");
+  }
+  uint32_t length = GetU32(bytes.data() + pos);
+  if (bytes.size() - pos - 4 < length) {
+    return Fail(error, "Checkpoint record is truncated.");
+  }
+  RecordReader record(bytes.data() + pos + 4, length);
+
+  const uint8_t* header = record.Take(1 + 8 + 1);
+  if (!header) {
+    return Fail(error, "Checkpoint record header is truncated.");
+  }
+  uint64_t record_clocks = GetU64(header + 1);
+  uint8_t page_mask = header[9];
+  if (page_mask & ~Memory::kAllPages) {
+    return Fail(error, "Checkpoint record has an invalid page mask.");
+  }
+  // The whole record is read and checked before any of it reaches state.
+  std::array<const uint8_t*, Memory::kPages> pages{};
+  for (uint16_t page = 0; page < Memory::kPages; ++page) {
+    if ((page_mask & (1u << page)) == 0) {
+      continue;
+    }
+    pages[page] = record.Take(Memory::kPageSize);
+    if (!pages[page]) {
+      return Fail(error, "Checkpoint memory page is truncated.");
+    }
+  }
+
+  const uint8_t* mask = record.Take(kCheckpointFieldMaskBytes);
+  if (!mask) {
+    return Fail(error, "Checkpoint field mask is truncated.");
+  }
+  CheckpointFields fields;
+  GatherCheckpointFields(state, fields);
+  for (size_t i = 0; i < kCheckpointFieldCount; ++i) {
+    if (mask[i / 8] & (1u << (i % 8))) {
+      const uint8_t* value = record.Take(4);
+      if (!value) {
+        return Fail(error, "Checkpoint fields are truncated.");
+      }
+      fields[i] = GetU32(value);
+    }
+  }
+
+  if (!ValidCheckpointFields(fields)) {
+    return Fail(error, "Checkpoint record has an out-of-range field.");
+  }
+
+  struct StreamTail {
+    uint32_t from = 0;
+    uint32_t count = 0;
+    const uint8_t* data = nullptr;
+  };
+  std::array<StreamTail, kCheckpointStreams> tails;
+  Streams streams = StreamsOf(state.io);
+  for (size_t i = 0; i < kCheckpointStreams; ++i) {
+    const uint8_t* range = record.Take(8);
+    if (!range) {
+      return Fail(error, "Checkpoint I/O stream is truncated.");
+    }
+    StreamTail& tail = tails[i];
+    tail.from = GetU32(range);
+    tail.count = GetU32(range + 4);
+    tail.data = record.Take(tail.count);
+    if (tail.from > streams[i]->size() || !tail.data) {
+      return Fail(error, "Checkpoint I/O stream does not fit.");
+    }
+  }
+  if (!record.done()) {
+    return Fail(error, "Checkpoint record has trailing bytes.");
+  }
+
+  for (uint16_t page = 0; page < Memory::kPages; ++page) {
+    if (pages[page]) {
+      state.memory.LoadPage(
+          page, std::span<const uint8_t, Memory::kPageSize>(
+                    pages[page], Memory::kPageSize));
+    }
+  }
+  for (size_t i = 0; i < kCheckpointStreams; ++i) {
+    std::vector<uint8_t>& stream = *streams[i];
+    stream.resize(tails[i].from);
+    stream.insert(stream.end(), tails[i].data,
+                  tails[i].data + tails[i].count);
+  }
+  ScatterCheckpointFields(fields, state);
+  clocks = record_clocks;
+  pos += 4 + length;
+  return true;
+}
+
+bool CheckpointRecorder::Open(const std::string& path, std::string* error) {
+  out_.open(path, std::ios::binary | std::ios::trunc);
+  if (!out_) {
+    return Fail(error, "Unable to open checkpoint file for writing.");
+  }
+  uint8_t header[kCheckpointHeaderBytes] = {};
+  std::memcpy(header, kCheckpointMagic, sizeof(kCheckpointMagic));
+  for (size_t i = 0; i < 4; ++i) {
+    header[sizeof(kCheckpointMagic) + i] =
+        static_cast<uint8_t>((kCheckpointVersion >> (8 * i)) & 0xFF);
+  }
+  out_.write(reinterpret_cast<const char*>(header), sizeof(header));
+  write_failed_ = !out_;
+  writer_.Reset();
+  if (write_failed_) {
+    return Fail(error, "Failed to write checkpoint header.");
+  }
+  return true;
+}
+
+void CheckpointRecorder::Append(const MachineState& state, uint64_t clocks) {
+  if (!out_.is_open() || write_failed_) {
+    return;
+  }
+  record_.clear();
+  writer_.Append(state, clocks, record_);
+  out_.write(reinterpret_cast<const char*>(record_.data()),
+             static_cast<std::streamsize>(record_.size()));
+  out_.flush();
+  if (!out_) {
+    write_failed_ = true;
+  }
+}
+
+bool CheckpointRecorder::Close(std::string* error) {
+  if (!out_.is_open()) {
+    return true;
+  }
+  out_.close();
+  if (write_failed_ || out_.fail()) {
+    return Fail(error, "Failed to write checkpoint file.");
+  }
+  return true;
+}
+
+bool LoadCheckpoints(const std::string& path,
+                     MachineState& state,
+                     uint64_t& clocks,
+                     std::string* error) {
+  std::ifstream in(path, std::ios::binary);
+  if (!in) {
+    return Fail(error, "Unable to open checkpoint file for reading.");
+  }
+  std::vector<uint8_t> bytes{std::istreambuf_iterator<char>(in),
+                             std::istreambuf_iterator<char>()};
+  if (bytes.size() < kCheckpointHeaderBytes ||
+      std::memcmp(bytes.data(), kCheckpointMagic, sizeof(kCheckpointMagic)) !=
+          0) {
+    return Fail(error, "Invalid checkpoint file header.");
+  }
+  if (GetU32(bytes.data() + sizeof(kCheckpointMagic)) != kCheckpointVersion) {
+    return Fail(error, "Unsupported checkpoint file version.");
+  }
+
+  size_t pos = kCheckpointHeaderBytes;
+  bool any = false;
+  while (bytes.size() - pos >= 4 &&
+         bytes.size() - pos - 4 >= GetU32(bytes.data() + pos)) {
+    if (!any && (GetU32(bytes.data() + pos) == 0 ||
+                 (bytes[pos + 4] & kCheckpointKeyframe) == 0)) {
+      return Fail(error, "Checkpoint file does not start with a keyframe.");
+    }
+    if (!ApplyCheckpoint(bytes, pos, state, clocks, error)) {
+      return false;
+    }
+    any = true;
+  }
+  if (!any) {
+    return Fail(error, "Checkpoint file holds no complete checkpoint.");
+  }
+  state.trace.Clear();
+  return true;
+}
+
+}  // namespace ct10::core
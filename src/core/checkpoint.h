@@ -0,0 +1,103 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "core/machine_state.h"
+#include "core/memory.h"
+
+namespace ct10::core {
+
+// Delta checkpoints: a u32 record length, then
+//   flags (bit 0 keyframe), clocks (u64),
+//   page mask (u8), then 256 bytes for each page in the mask,
+//   field mask (kCheckpointFieldMaskBytes), then a u32 for each field in it,
+//   and for each I/O stream: start (u32), count (u32), count bytes.
+// A stream is cut back to start and the bytes appended, so output that only
+// grows costs just the new bytes. A keyframe carries every page, field and
+// stream; later records only what changed since the record before. All
+// values are little endian. The trace is not checkpointed.
+//
+// A checkpoint file is an 8-byte magic and a u32 version, then records.
+inline constexpr char kCheckpointMagic[8] = {'C', 'T', '1', '0',
+                                             'C', 'K', 'P', '1'};
+inline constexpr uint32_t kCheckpointVersion = 1;
+inline constexpr size_t kCheckpointHeaderBytes = sizeof(kCheckpointMagic) + 4;
+
+inline constexpr uint8_t kCheckpointKeyframe = 0x01;
+inline constexpr size_t kCheckpointFieldCount = 74;
+inline constexpr size_t kCheckpointFieldMaskBytes =
+    (kCheckpointFieldCount + 7) / 8;
+inline constexpr size_t kCheckpointStreams = 5;
+
+// Registers, buses, flags, timing, I/O positions and panel switches.
+using CheckpointFields = std::array<uint32_t, kCheckpointFieldCount>;
+
+// Copies the fields in checkpoint order, the order the state file keeps
+// them in too.
+void GatherCheckpointFields(const MachineState& state,
+                            CheckpointFields& fields);
+void ScatterCheckpointFields(const CheckpointFields& fields,
+                             MachineState& state);
+// False when the distributor, phase, transfer mode or load target is out of
+// range; such fields must not be scattered.
+bool ValidCheckpointFields(const CheckpointFields& fields);
+
+// True when the two machines would be checkpointed identically.
+bool SameCheckpointState(const MachineState& a, const MachineState& b);
+
+// Appends checkpoint records for one machine. Pages are compared by memory
+// generation and streams by length, so a checkpoint costs what changed.
+// Call Reset when the machine is replaced wholesale (state load, fork spawn,
+// a tape or terminal buffer swapped out) so the next record is a keyframe.
+class CheckpointWriter {
+ public:
+  void Append(const MachineState& state,
+              uint64_t clocks,
+              std::vector<uint8_t>& out);
+  void Reset();
+
+ private:
+  std::array<uint64_t, Memory::kPages> generations_{};
+  CheckpointFields fields_{};
+  std::array<size_t, kCheckpointStreams> stream_sizes_{};
+  bool keyframe_ = true;
+};
+
+// Applies the record at bytes[pos] to state and moves pos past it. A delta
+// record needs state to hold the machine at the record before it.
+bool ApplyCheckpoint(std::span<const uint8_t> bytes,
+                     size_t& pos,
+                     MachineState& state,
+                     uint64_t& clocks,
+                     std::string* error);
+
+// Writes a checkpoint file, flushing each record so a crashed run can be
+// resumed from its last checkpoint.
+class CheckpointRecorder {
+ public:
+  bool Open(const std::string& path, std::string* error);
+  void Append(const MachineState& state, uint64_t clocks);
+  // False when any write failed.
+  bool Close(std::string* error);
+
+ private:
+  std::ofstream out_;
+  CheckpointWriter writer_;
+  std::vector<uint8_t> record_;
+  bool write_failed_ = false;
+};
+
+// Applies every complete record in a checkpoint file, leaving state at the
+// last one. A record cut short at the end of the file is ignored.
+bool LoadCheckpoints(const std::string& path,
+                     MachineState& state,
+                     uint64_t& clocks,
+                     std::string* error);
+
+}  // namespace ct10::core
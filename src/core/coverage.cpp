@@ -0,0 +1,131 @@
+#include "core/coverage.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+namespace ct10::core {
+namespace {
+
+constexpr char kCoverageHeader[] = "# CT-10 coverage";
+
+bool Fail(std::string* error, const char* message) {
+  if (error) {
+    *error = message;
+  }
+  return false;
+}
+
+}  // namespace
+
+void Coverage::Clear() { *this = Coverage(); }
+
+void Coverage::Merge(const Coverage& other) {
+  executed_ |= other.executed_;
+  taken_ |= other.taken_;
+  fell_through_ |= other.fell_through_;
+}
+
+void Coverage::Mark(uint16_t address, bool taken, bool fell_through) {
+  address &= Memory::kAddressMask;
+  executed_.set(address);
+  taken_[address] = taken_[address] || taken;
+  fell_through_[address] = fell_through_[address] || fell_through;
+}
+
+bool Coverage::executed(uint16_t address) const {
+  return executed_.test(address & Memory::kAddressMask);
+}
+
+bool Coverage::taken(uint16_t address) const {
+  return taken_.test(address & Memory::kAddressMask);
+}
+
+bool Coverage::fell_through(uint16_t address) const {
+  return fell_through_.test(address & Memory::kAddressMask);
+}
+
+size_t Coverage::executed_count() const { return executed_.count(); }
+
+bool SaveCoverage(const Coverage& coverage,
+                  const std::string& path,
+                  std::string* error) {
+  size_t both = 0;
+  size_t taken_only = 0;
+  size_t fell_through_only = 0;
+  for (uint16_t address = 0; address < Memory::kSize; ++address) {
+    bool taken = coverage.taken(address);
+    bool fell_through = coverage.fell_through(address);
+    both += taken && fell_through;
+    taken_only += taken && !fell_through;
+    fell_through_only += !taken && fell_through;
+  }
+
+  std::ofstream out(path);
+  if (!out) {
+    return Fail(error, "Unable to open coverage file for writing.");
+  }
+  out << kCoverageHeader << ": " << coverage.executed_count() << " of "
+      << Memory::kSize << " addresses executed; conditionals " << both
+      << " both ways, " << taken_only << " taken only, " << fell_through_only
+      << " fell through only\n";
+  for (uint16_t address = 0; address < Memory::kSize; ++address) {
+    if (!coverage.executed(address)) {
+      continue;
+    }
+    char line[16];
+    std::snprintf(line, sizeof(line), "%03X X%s%s\n",
+                  static_cast<unsigned>(address),
+                  coverage.taken(address) ? " T" : "",
+                  coverage.fell_through(address) ? " N" : "");
+    out << line;
+  }
+  if (!out) {
+    return Fail(error, "Failed to write coverage file.");
+  }
+  return true;
+}
+
+bool LoadCoverage(Coverage& coverage,
+                  const std::string& path,
+                  std::string* error) {
+  std::ifstream in(path);
+  if (!in) {
+    return Fail(error, "Unable to open coverage file for reading.");
+  }
+  std::string line;
+  if (!std::getline(in, line) || line.rfind(kCoverageHeader, 0) != 0) {
+    return Fail(error, "Invalid coverage file header.");
+  }
+
+  Coverage loaded;
+  while (std::getline(in, line)) {
+    std::istringstream fields(line);
+    std::string token;
+    if (!(fields >> token)) {
+      continue;
+    }
+    char* end = nullptr;
+    unsigned long address = std::strtoul(token.c_str(), &end, 16);
+    if (end == token.c_str() || *end != '\0' || address >= Memory::kSize) {
+      return Fail(error, "Invalid coverage file address.");
+    }
+    bool taken = false;
+    bool fell_through = false;
+    while (fields >> token) {
+      if (token == "T") {
+        taken = true;
+      } else if (token == "N") {
+        fell_through = true;
+      } else if (token != "X") {
+        return Fail(error, "Invalid coverage file mark.");
+      }
+    }
+    loaded.Mark(static_cast<uint16_t>(address), taken, fell_through);
+  }
+  coverage.Merge(loaded);
+  return true;
+}
+
+}  // namespace ct10::core
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <bitset>
+#include <cstdint>
+#include <string>
+
+#include "core/memory.h"
+
+namespace ct10::core {
+
+// Conditional branches (BPS, BZE, BNG, BNC, BXZ) and skips (SKI, SKS, SKF).
+constexpr bool IsConditionalOpcode(uint8_t opcode) {
+  uint8_t op = static_cast<uint8_t>(opcode & 0xF8);
+  return (op >= 0xA8 && op <= 0xC8) || (opcode >= 0x08 && opcode <= 0x0A);
+}
+
+// Which addresses started an instruction, and which way each conditional
+// branch or skip went, as bitmaps over memory. An outcome is judged by where
+// the next instruction starts: anywhere but the following cell counts as
+// taken. Coverage from separate runs of a program combines with Merge.
+class Coverage {
+ public:
+  void Clear();
+
+  void Begin(uint16_t address, uint8_t opcode) {
+    address &= Memory::kAddressMask;
+    if (pending_) {
+      uint16_t next = (branch_ + 2) & Memory::kAddressMask;
+      (address == next ? fell_through_ : taken_).set(branch_);
+    }
+    executed_.set(address);
+    pending_ = IsConditionalOpcode(opcode);
+    branch_ = address;
+  }
+
+  void Merge(const Coverage& other);
+  // Adds an executed address and its outcomes, as read from a file.
+  void Mark(uint16_t address, bool taken, bool fell_through);
+
+  bool executed(uint16_t address) const;
+  // Conditional instructions only.
+  bool taken(uint16_t address) const;
+  bool fell_through(uint16_t address) const;
+
+  size_t executed_count() const;
+
+ private:
+  std::bitset<Memory::kSize> executed_;
+  std::bitset<Memory::kSize> taken_;
+  std::bitset<Memory::kSize> fell_through_;
+  uint16_t branch_ = 0;
+  bool pending_ = false;
+};
+
+// A coverage file is a text report that can be read back for merging: a
+// summary comment, then one line per executed address, "ADDR X" plus T when
+// a conditional there was taken and N when it fell through.
+bool SaveCoverage(const Coverage& coverage,
+                  const std::string& path,
+                  std::string* error);
+// Merges the file into coverage.
+bool LoadCoverage(Coverage& coverage,
+                  const std::string& path,
+                  std::string* error);
+
+}  // namespace ct10::core
@@ -1,45 +1,10 @@
 #include "core/execution_engine.h"
 
-#include "core/microcode_table.h"
+#include "core/machine_ops.h"
 
 namespace ct10::core {
 namespace {
 
-uint8_t ToByte(uint16_t value) {
-  return static_cast<uint8_t>(value & 0xFF);
-}
-
-uint16_t FormPageAddress(uint8_t opcode, uint8_t low) {
-  uint16_t page = static_cast<uint16_t>(opcode & 0x03);
-  return static_cast<uint16_t>((page << 8) | low);
-}
-
-uint8_t PageBitsFromAddress(uint16_t address) {
-  return static_cast<uint8_t>((address >> 8) & 0x03);
-}
-
-uint8_t EncodeBunOpcode(uint16_t address) {
-  return static_cast<uint8_t>(0x90 | PageBitsFromAddress(address));
-}
-
-bool IsIndexed(uint8_t opcode) {
-  return (opcode & 0x04u) != 0;
-}
-
-uint8_t BuildStatusByte(const MachineState& state) {
-  uint8_t status = 0;
-  if (state.status.interrupt) {
-    status |= 0x01;
-  }
-  if (state.status.sense) {
-    status |= 0x02;
-  }
-  if (state.status.flag) {
-    status |= 0x04;
-  }
-  return status;
-}
-
 bool IsManualTransfer(IoTransferMode mode) {
   return mode == IoTransferMode::ManualOutput ||
          mode == IoTransferMode::ManualInput;
@@ -211,94 +176,7 @@ void HandleIo(MachineState& state) {
   state.io.status = BuildStatusByte(state);
 }
 
-}  // namespace
-
-void ExecutionEngine::Step(MachineState& state) const {
-  if (state.mode.halted) {
-    return;
-  }
-
-  if (state.io.transfer_mode != IoTransferMode::None) {
-    state.status.wait = true;
-    if (IsManualTransfer(state.io.transfer_mode)) {
-      state.mode.halted = true;
-      if (!state.panel_input.start) {
-        return;
-      }
-      TransferStep(state);
-      return;
-    }
-    if (state.io.wait_cycles > 0) {
-      --state.io.wait_cycles;
-      return;
-    }
-    TransferStep(state);
-    if (state.io.transfer_mode != IoTransferMode::None) {
-      state.io.wait_cycles = 1;
-    }
-    return;
-  }
-
-  state.status.wait = false;
-
-  if (!state.timing.acquisition &&
-      state.timing.distributor == 0 &&
-      state.timing.phase == ClockPhase::CP1) {
-    state.flags.add_overflow = false;
-    state.flags.divide_overflow = false;
-    state.flags.inst_error = false;
-  }
-
-  switch (state.panel_input.io_mode) {
-    case 1:
-      state.io.hex_mode = true;
-      state.io.alpha_mode = false;
-      break;
-    case 2:
-      state.io.hex_mode = false;
-      state.io.alpha_mode = true;
-      break;
-    default:
-      state.io.hex_mode = false;
-      state.io.alpha_mode = false;
-      break;
-  }
-
-  state.status.sense = state.panel_input.sense;
-  state.status.interrupt = state.io.interrupt;
-  state.io.status = BuildStatusByte(state);
-
-  if (state.timing.phase == ClockPhase::CP1) {
-    state.x_bus.Clear();
-    state.y_bus.Clear();
-    state.z_bus.Clear();
-  } else if (state.timing.phase == ClockPhase::CP2) {
-    state.f_bus.Clear();
-  }
-
-  const auto& steps = state.timing.acquisition
-                          ? MicrocodeTable::Acquisition()
-                          : MicrocodeTable::Execution(ToByte(state.opcode.value()));
-  if (!state.timing.acquisition && steps.empty()) {
-    state.flags.inst_error = true;
-    if (!state.panel_input.error_inst) {
-      state.mode.halted = true;
-      return;
-    }
-  }
-
-  for (const auto& step : steps) {
-    if (step.distributor == state.timing.distributor &&
-        step.phase == state.timing.phase) {
-      ExecuteMicroOp(step.op, state);
-      state.AddTrace(step.op);
-    }
-  }
-
-  state.distributor.Load(state.timing.distributor);
-}
-
-void ExecutionEngine::ExecuteMicroOp(MicroOp op, MachineState& state) const {
+void ExecuteMicroOp(MicroOp op, MachineState& state) {
   switch (op) {
     case MicroOp::PAR_TO_MAR: {
       uint16_t value = state.par.value();
@@ -323,10 +201,7 @@ void ExecutionEngine::ExecuteMicroOp(MicroOp op, MachineState& state) const {
       state.opcode.Load(state.buffer.value());
       break;
     case MicroOp::PAR_INC:
-      if (!(state.panel_input.rpt &&
-            (state.panel_input.mode == 1 || state.panel_input.mode == 2))) {
-        state.par.Increment();
-      }
+      IncrementPar(state);
       break;
     case MicroOp::FORM_EFFECTIVE_ADDRESS: {
       uint16_t addr = FormPageAddress(ToByte(state.opcode.value()),
@@ -402,45 +277,20 @@ void ExecutionEngine::ExecuteMicroOp(MicroOp op, MachineState& state) const {
     case MicroOp::STORE_Q_TO_MEM:
       state.memory.Write(state.mar.value(), ToByte(state.quotient.value()));
       break;
-    case MicroOp::COPY_MEM_TO_MEM_PLUS_ONE: {
-      uint16_t addr = state.mar.value();
-      uint8_t value = state.memory.Read(addr);
-      uint16_t next = static_cast<uint16_t>(addr + 1);
-      state.memory.Write(next, value);
-      state.mar.Load(next);
+    case MicroOp::COPY_MEM_TO_MEM_PLUS_ONE:
+      CopyMemoryToNext(state);
       break;
-    }
     case MicroOp::INCREMENT_X_BY_BUFFER:
       state.index.Load(state.index.value() + state.buffer.value());
       break;
-    case MicroOp::ALU_ADD_TO_F: {
-      uint8_t a = ToByte(state.y_bus.value());
-      uint8_t b = ToByte(state.x_bus.value());
-      uint16_t sum = static_cast<uint16_t>(a) + static_cast<uint16_t>(b);
-      uint8_t result = static_cast<uint8_t>(sum & 0xFF);
-      state.f_bus.Drive(result);
-      state.flags.carry = sum > 0xFF;
-      state.flags.add_overflow =
-          ((a ^ result) & (b ^ result) & 0x80) != 0;
-      if (state.flags.add_overflow && !state.panel_input.error_add) {
-        state.mode.halted = true;
-      }
+    case MicroOp::ALU_ADD_TO_F:
+      state.f_bus.Drive(AluAdd(state, ToByte(state.y_bus.value()),
+                               ToByte(state.x_bus.value())));
       break;
-    }
-    case MicroOp::ALU_SUB_TO_F: {
-      uint8_t a = ToByte(state.y_bus.value());
-      uint8_t b = ToByte(state.x_bus.value());
-      int16_t diff = static_cast<int16_t>(a) - static_cast<int16_t>(b);
-      uint8_t result = static_cast<uint8_t>(diff & 0xFF);
-      state.f_bus.Drive(result);
-      state.flags.carry = diff >= 0;
-      state.flags.add_overflow =
-          ((a ^ b) & (a ^ result) & 0x80) != 0;
-      if (state.flags.add_overflow && !state.panel_input.error_add) {
-        state.mode.halted = true;
-      }
+    case MicroOp::ALU_SUB_TO_F:
+      state.f_bus.Drive(AluSubtract(state, ToByte(state.y_bus.value()),
+                                    ToByte(state.x_bus.value())));
       break;
-    }
     case MicroOp::ALU_AND: {
       uint8_t result = static_cast<uint8_t>(ToByte(state.accumulator.value()) &
                                             ToByte(state.buffer.value()));
@@ -459,173 +309,44 @@ void ExecutionEngine::ExecuteMicroOp(MicroOp op, MachineState& state) const {
       state.accumulator.Load(result);
       break;
     }
-    case MicroOp::SHIFT_SLA: {
-      uint16_t value = static_cast<uint16_t>((state.accumulator.value() << 8) |
-                                             ToByte(state.quotient.value()));
-      uint8_t count = ToByte(state.buffer.value());
-      if (count >= 16) {
-        value = 0;
-      } else {
-        value = static_cast<uint16_t>(value << count);
-      }
-      state.accumulator.Load(static_cast<uint8_t>((value >> 8) & 0xFF));
-      state.quotient.Load(static_cast<uint8_t>(value & 0xFF));
+    case MicroOp::SHIFT_SLA:
+      ShiftLeftArithmetic(state, ToByte(state.buffer.value()));
       break;
-    }
-    case MicroOp::SHIFT_SRA: {
-      int16_t value = static_cast<int16_t>((state.accumulator.value() << 8) |
-                                           ToByte(state.quotient.value()));
-      uint8_t count = ToByte(state.buffer.value());
-      if (count >= 16) {
-        value = (value < 0) ? static_cast<int16_t>(-1) : 0;
-      } else {
-        value = static_cast<int16_t>(value >> count);
-      }
-      state.accumulator.Load(static_cast<uint8_t>((value >> 8) & 0xFF));
-      state.quotient.Load(static_cast<uint8_t>(value & 0xFF));
+    case MicroOp::SHIFT_SRA:
+      ShiftRightArithmetic(state, ToByte(state.buffer.value()));
       break;
-    }
-    case MicroOp::SHIFT_SLL: {
-      uint8_t value = ToByte(state.accumulator.value());
-      uint8_t count = ToByte(state.buffer.value());
-      if (count >= 8) {
-        value = 0;
-      } else {
-        value = static_cast<uint8_t>(value << count);
-      }
-      state.accumulator.Load(value);
+    case MicroOp::SHIFT_SLL:
+      ShiftLeftLogical(state, ToByte(state.buffer.value()));
       break;
-    }
-    case MicroOp::SHIFT_SRL: {
-      uint8_t value = ToByte(state.accumulator.value());
-      uint8_t count = ToByte(state.buffer.value());
-      if (count >= 8) {
-        value = 0;
-      } else {
-        value = static_cast<uint8_t>(value >> count);
-      }
-      state.accumulator.Load(value);
+    case MicroOp::SHIFT_SRL:
+      ShiftRightLogical(state, ToByte(state.buffer.value()));
       break;
-    }
-    case MicroOp::MULTIPLY: {
-      int16_t a = static_cast<int8_t>(ToByte(state.accumulator.value()));
-      int16_t b = static_cast<int8_t>(ToByte(state.buffer.value()));
-      int16_t product = static_cast<int16_t>(a * b);
-      state.accumulator.Load(static_cast<uint8_t>((product >> 8) & 0xFF));
-      state.quotient.Load(static_cast<uint8_t>(product & 0xFF));
+    case MicroOp::MULTIPLY:
+      Multiply(state, ToByte(state.buffer.value()));
       break;
-    }
-    case MicroOp::DIVIDE: {
-      int16_t dividend = static_cast<int16_t>((state.accumulator.value() << 8) |
-                                              ToByte(state.quotient.value()));
-      int16_t divisor = static_cast<int8_t>(ToByte(state.buffer.value()));
-      if (divisor == 0) {
-        state.flags.divide_overflow = true;
-        if (!state.panel_input.error_div) {
-          state.mode.halted = true;
-        }
-        break;
-      }
-      int16_t quotient = static_cast<int16_t>(dividend / divisor);
-      int16_t remainder = static_cast<int16_t>(dividend % divisor);
-      if (quotient < -128 || quotient > 127) {
-        state.flags.divide_overflow = true;
-        if (!state.panel_input.error_div) {
-          state.mode.halted = true;
-        }
-        break;
-      }
-      state.flags.divide_overflow = false;
-      state.quotient.Load(static_cast<uint8_t>(quotient & 0xFF));
-      state.accumulator.Load(static_cast<uint8_t>(remainder & 0xFF));
+    case MicroOp::DIVIDE:
+      Divide(state, ToByte(state.buffer.value()));
       break;
-    }
-    case MicroOp::RAO: {
-      uint8_t value = ToByte(state.buffer.value());
-      uint16_t sum = static_cast<uint16_t>(value) + 1u;
-      uint8_t result = static_cast<uint8_t>(sum & 0xFF);
-      state.memory.Write(state.mar.value(), result);
-      state.accumulator.Load(result);
-      state.flags.carry = value == 0xFF;
+    case MicroOp::RAO:
+      ReplaceAddOne(state, state.mar.value(), ToByte(state.buffer.value()));
       break;
-    }
-    case MicroOp::RSO: {
-      uint8_t value = ToByte(state.buffer.value());
-      int16_t diff = static_cast<int16_t>(value) - 1;
-      uint8_t result = static_cast<uint8_t>(diff & 0xFF);
-      state.memory.Write(state.mar.value(), result);
-      state.accumulator.Load(result);
-      state.flags.carry = value == 0x00;
+    case MicroOp::RSO:
+      ReplaceSubtractOne(state, state.mar.value(),
+                         ToByte(state.buffer.value()));
       break;
-    }
-    case MicroOp::BRANCH: {
-      uint8_t op = ToByte(state.opcode.value()) & 0xF8;
-      bool take = false;
-      switch (op) {
-        case 0x90:
-          take = true;
-          break;
-        case 0x98:
-          take = true;
-          state.mode.halted = true;
-          break;
-        case 0xA0:
-          take = true;
-          break;
-        case 0xA8:
-          take = state.flags.greater;
-          break;
-        case 0xB0:
-          take = state.flags.zero;
-          break;
-        case 0xB8:
-          take = state.flags.less;
-          break;
-        case 0xC0:
-          take = !state.flags.carry;
-          break;
-        case 0xC8:
-          take = state.index.value() == 0;
-          break;
-        default:
-          break;
-      }
-      if (op == 0xA0) {
-        uint16_t addr = state.mar.value();
-        state.memory.Write(addr, EncodeBunOpcode(state.par.value()));
-        state.memory.Write(static_cast<uint16_t>(addr + 1),
-                           static_cast<uint8_t>(state.par.value() & 0xFF));
-        state.par.Load(static_cast<uint16_t>(addr + 2));
-      } else if (take) {
-        state.par.Load(state.mar.value());
-      }
+    case MicroOp::BRANCH:
+      Branch(state, ToByte(state.opcode.value()));
       break;
-    }
-    case MicroOp::SKIP_IF_INTERRUPT: {
-      state.countdown.Load(state.buffer.value());
-      if (state.status.interrupt) {
-        state.par.Load(state.par.value() +
-                       static_cast<uint16_t>(2u * ToByte(state.buffer.value())));
-      }
+    case MicroOp::SKIP_IF_INTERRUPT:
+      SkipIf(state, state.status.interrupt, ToByte(state.buffer.value()));
       state.io.interrupt = false;
       break;
-    }
-    case MicroOp::SKIP_IF_SENSE: {
-      state.countdown.Load(state.buffer.value());
-      if (state.status.sense) {
-        state.par.Load(state.par.value() +
-                       static_cast<uint16_t>(2u * ToByte(state.buffer.value())));
-      }
+    case MicroOp::SKIP_IF_SENSE:
+      SkipIf(state, state.status.sense, ToByte(state.buffer.value()));
       break;
-    }
-    case MicroOp::SKIP_IF_FLAG: {
-      state.countdown.Load(state.buffer.value());
-      if (state.status.flag) {
-        state.par.Load(state.par.value() +
-                       static_cast<uint16_t>(2u * ToByte(state.buffer.value())));
-      }
+    case MicroOp::SKIP_IF_FLAG:
+      SkipIf(state, state.status.flag, ToByte(state.buffer.value()));
       break;
-    }
     case MicroOp::FLAG_SET:
       state.status.flag = true;
       break;
@@ -637,39 +358,24 @@ void ExecutionEngine::ExecuteMicroOp(MicroOp op, MachineState& state) const {
       break;
     case MicroOp::IO_NOOP:
       if (ToByte(state.opcode.value()) == 0x11) {
-        uint8_t cmd = ToByte(state.buffer.value());
-        state.io.last_command = cmd;
-        state.io.selected_device = static_cast<uint8_t>(cmd & 0x07);
-        state.io.hex_mode = (cmd & 0x08) != 0;
-        state.io.alpha_mode = (cmd & 0x10) != 0;
+        SelectDevice(state, ToByte(state.buffer.value()));
       }
       HandleIo(state);
       break;
     case MicroOp::ALU_DIV:
     case MicroOp::ALU_MUL:
       break;
-    case MicroOp::UPDATE_FLAGS: {
-      uint8_t value = ToByte(state.accumulator.value());
-      state.flags.zero = value == 0;
-      state.flags.greater = (value & 0x80) == 0 && value != 0;
-      state.flags.less = (value & 0x80) != 0;
+    case MicroOp::UPDATE_FLAGS:
+      UpdateFlags(state, ToByte(state.accumulator.value()));
       break;
-    }
-    case MicroOp::UPDATE_FLAGS_Q: {
-      uint8_t value = ToByte(state.quotient.value());
-      state.flags.zero = value == 0;
-      state.flags.greater = (value & 0x80) == 0 && value != 0;
-      state.flags.less = (value & 0x80) != 0;
+    case MicroOp::UPDATE_FLAGS_Q:
+      UpdateFlags(state, ToByte(state.quotient.value()));
       break;
-    }
-    case MicroOp::UPDATE_FLAGS_AQ: {
-      uint16_t value = static_cast<uint16_t>((state.accumulator.value() << 8) |
-                                             ToByte(state.quotient.value()));
-      state.flags.zero = value == 0;
-      state.flags.greater = (value & 0x8000) == 0 && value != 0;
-      state.flags.less = (value & 0x8000) != 0;
+    case MicroOp::UPDATE_FLAGS_AQ:
+      UpdateFlagsWord(state, static_cast<uint16_t>(
+                                 (state.accumulator.value() << 8) |
+                                 ToByte(state.quotient.value())));
       break;
-    }
     case MicroOp::UPDATE_OVERFLOW:
       break;
     case MicroOp::HALT:
@@ -678,4 +384,164 @@ void ExecutionEngine::ExecuteMicroOp(MicroOp op, MachineState& state) const {
   }
 }
 
+}  // namespace
+
+template <typename TraceSink>
+BasicExecutionEngine<TraceSink>::BasicExecutionEngine(TraceSink sink)
+    : dispatch_(&MicrocodeDispatch::Instance()), sink_(sink) {}
+
+template <typename TraceSink>
+uint32_t BasicExecutionEngine<TraceSink>::Step(MachineState& state) const {
+  if (state.mode.halted) {
+    return 0;
+  }
+
+  if (state.io.transfer_mode != IoTransferMode::None) {
+    state.status.wait = true;
+    if (IsManualTransfer(state.io.transfer_mode)) {
+      state.mode.halted = true;
+      if (!state.panel_input.start) {
+        return 0;
+      }
+      TransferStep(state);
+      return 0;
+    }
+    if (state.io.wait_cycles > 0) {
+      --state.io.wait_cycles;
+      return 0;
+    }
+    TransferStep(state);
+    if (state.io.transfer_mode != IoTransferMode::None) {
+      state.io.wait_cycles = 1;
+    }
+    return 0;
+  }
+
+  state.status.wait = false;
+
+  if (!state.timing.acquisition &&
+      state.timing.distributor == 0 &&
+      state.timing.phase == ClockPhase::CP1) {
+    state.flags.add_overflow = false;
+    state.flags.divide_overflow = false;
+    state.flags.inst_error = false;
+  }
+
+  LatchPanelStatus(state);
+
+  if (state.timing.phase == ClockPhase::CP1) {
+    state.x_bus.Clear();
+    state.y_bus.Clear();
+    state.z_bus.Clear();
+  } else if (state.timing.phase == ClockPhase::CP2) {
+    state.f_bus.Clear();
+  }
+
+  uint8_t opcode = ToByte(state.opcode.value());
+  if (!state.timing.acquisition && !dispatch_->HasExecution(opcode)) {
+    state.flags.inst_error = true;
+    if (!state.panel_input.error_inst) {
+      state.mode.halted = true;
+      return 0;
+    }
+  }
+
+  if constexpr (TraceSink::kEnabled) {
+    if (state.timing.acquisition && state.timing.distributor == 0 &&
+        state.timing.phase == ClockPhase::CP1) {
+      sink_.Instruction(state);
+    }
+  }
+
+  std::span<const MicroOp> ops = dispatch_->Slot(
+      state.timing.acquisition, opcode, state.timing.distributor,
+      state.timing.phase);
+  for (MicroOp op : ops) {
+    ExecuteMicroOp(op, state);
+    if constexpr (TraceSink::kEnabled) {
+      sink_.Record(state, op);
+    }
+  }
+  if (microcode_coverage_) {
+    microcode_coverage_->Mark(ops);
+  }
+
+  state.distributor.Load(state.timing.distributor);
+  return static_cast<uint32_t>(ops.size());
+}
+
+template <typename TraceSink>
+uint32_t BasicExecutionEngine<TraceSink>::FastForward(
+    MachineState& state,
+    const TimingEngine& timing,
+    uint32_t max_clocks) const {
+  if (!fast_forward_ || max_clocks == 0 || state.mode.halted ||
+      state.io.transfer_mode != IoTransferMode::None) {
+    return 0;
+  }
+
+  uint32_t clocks = dispatch_->IdleRun(state.timing.acquisition,
+                                       ToByte(state.opcode.value()),
+                                       state.timing.distributor,
+                                       state.timing.phase);
+  if (clocks > max_clocks) {
+    clocks = max_clocks;
+  }
+  if (clocks == 0) {
+    return 0;
+  }
+
+  state.status.wait = false;
+  LatchPanelStatus(state);
+
+  ClockPhase phase = state.timing.phase;
+  for (uint32_t i = 0; i < clocks && i < 3; ++i) {
+    if (phase == ClockPhase::CP1) {
+      state.x_bus.Clear();
+      state.y_bus.Clear();
+      state.z_bus.Clear();
+    } else if (phase == ClockPhase::CP2) {
+      state.f_bus.Clear();
+    }
+    phase = phase == ClockPhase::CP3
+                ? ClockPhase::CP1
+                : static_cast<ClockPhase>(static_cast<uint8_t>(phase) + 1);
+  }
+
+  timing.AdvanceBy(state.timing, clocks - 1);
+  state.distributor.Load(state.timing.distributor);
+  timing.Advance(state.timing);
+  return clocks;
+}
+
+template <typename TraceSink>
+void BasicExecutionEngine<TraceSink>::set_fast_forward(bool enabled) {
+  fast_forward_ = enabled;
+}
+
+template <typename TraceSink>
+bool BasicExecutionEngine<TraceSink>::fast_forward() const {
+  return fast_forward_;
+}
+
+template <typename TraceSink>
+void BasicExecutionEngine<TraceSink>::set_microcode_coverage(
+    MicrocodeCoverage* coverage) {
+  microcode_coverage_ = coverage;
+}
+
+template <typename TraceSink>
+void BasicExecutionEngine<TraceSink>::set_trace_sink(TraceSink sink) {
+  sink_ = sink;
+}
+
+template <typename TraceSink>
+const TraceSink& BasicExecutionEngine<TraceSink>::trace_sink() const {
+  return sink_;
+}
+
+template class BasicExecutionEngine<RingTraceSink>;
+template class BasicExecutionEngine<NullTraceSink>;
+template class BasicExecutionEngine<StreamingTraceSink>;
+
 }  // namespace ct10::core
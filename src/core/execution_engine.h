@@ -2,15 +2,55 @@
 
 #include "core/machine_state.h"
 #include "core/microcode.h"
+#include "core/microcode_coverage.h"
+#include "core/microcode_table.h"
+#include "core/timing_engine.h"
+#include "core/trace_sink.h"
 
 namespace ct10::core {
 
-class ExecutionEngine {
+// Clock-level engine. TraceSink receives every executed micro-op; see
+// trace_sink.h for the available sinks.
+template <typename TraceSink>
+class BasicExecutionEngine {
  public:
-  void Step(MachineState& state) const;
+  explicit BasicExecutionEngine(TraceSink sink = TraceSink());
+
+  // Runs one clock and returns the micro-ops it executed, none on a halted
+  // or I/O wait clock.
+  uint32_t Step(MachineState& state) const;
+
+  // When fast-forward is enabled, skips up to max_clocks upcoming clocks that
+  // schedule no micro-op, applying their bus clears and distributor load, and
+  // returns the number of clocks skipped. Call after TimingEngine::Advance.
+  uint32_t FastForward(MachineState& state,
+                       const TimingEngine& timing,
+                       uint32_t max_clocks) const;
+
+  void set_fast_forward(bool enabled);
+  bool fast_forward() const;
+
+  // Marks every slot Step runs; null stops collecting.
+  void set_microcode_coverage(MicrocodeCoverage* coverage);
+
+  void set_trace_sink(TraceSink sink);
+  const TraceSink& trace_sink() const;
 
  private:
-  void ExecuteMicroOp(MicroOp op, MachineState& state) const;
+  const MicrocodeDispatch* dispatch_ = nullptr;
+  bool fast_forward_ = false;
+  MicrocodeCoverage* microcode_coverage_ = nullptr;
+  TraceSink sink_;
 };
 
+// Records into MachineState::trace for the GUI.
+using ExecutionEngine = BasicExecutionEngine<RingTraceSink>;
+// Records nothing; for grading and batch runs.
+using UntracedExecutionEngine = BasicExecutionEngine<NullTraceSink>;
+using StreamingExecutionEngine = BasicExecutionEngine<StreamingTraceSink>;
+
+extern template class BasicExecutionEngine<RingTraceSink>;
+extern template class BasicExecutionEngine<NullTraceSink>;
+extern template class BasicExecutionEngine<StreamingTraceSink>;
+
 }  // namespace ct10::core
@@ -0,0 +1,289 @@
+#include "core/execution_history.h"
+
+#include <span>
+
+namespace ct10::core {
+namespace {
+
+constexpr uint64_t kClocksPerDistributorCount = 3;
+constexpr uint64_t kClocksPerInstruction = 96;
+
+}  // namespace
+
+ExecutionHistory::ExecutionHistory(uint64_t interval, size_t max_checkpoints)
+    : interval_(std::max<uint64_t>(interval, 1)),
+      max_checkpoints_(std::max<size_t>(max_checkpoints, kKeyframeEvery + 1)) {
+  execution_.set_fast_forward(true);
+  seen_.trace.set_capacity(0);
+  scratch_.trace.set_capacity(0);
+}
+
+void ExecutionHistory::Reset(const MachineState& state) {
+  segments_.clear();
+  checkpoint_count_ = 0;
+  rebase_ = true;
+  position_ = 0;
+  end_ = 0;
+  ++epoch_;
+  Record(state);
+  Saw(state);
+}
+
+void ExecutionHistory::Sync(const MachineState& state) {
+  if (segments_.empty()) {
+    Reset(state);
+    return;
+  }
+  // Halted is an output of a run, not an input: the runner resumes a halted
+  // machine, and the GUI rewrites it every frame.
+  seen_.mode.halted = state.mode.halted;
+  if (SameCheckpointState(state, seen_)) {
+    return;
+  }
+  Truncate();
+  Record(state);
+  Saw(state);
+}
+
+bool ExecutionHistory::Seek(MachineState& state,
+                            const TimingEngine& timing,
+                            uint64_t clock) {
+  Sync(state);
+  Location location;
+  if (clock > end_ || !Latest(clock, location)) {
+    return false;
+  }
+  Restore(location, state);
+  Replay(state, timing, clock - At(location).clock);
+  position_ = clock;
+  ++epoch_;
+  Saw(state);
+  return true;
+}
+
+bool ExecutionHistory::StepBack(MachineState& state,
+                                const TimingEngine& timing,
+                                BudgetUnit unit,
+                                uint64_t count) {
+  Sync(state);
+  if (count == 0 || position_ <= oldest()) {
+    return false;
+  }
+  uint64_t back = count;
+  if (unit != BudgetUnit::Clocks) {
+    uint64_t period = unit == BudgetUnit::DistributorCounts
+                          ? kClocksPerDistributorCount
+                          : kClocksPerInstruction;
+    // Back to the boundary this count or instruction started on, then whole
+    // periods before it.
+    uint64_t into = InstructionPosition(state.timing) % period;
+    back = (into == 0 ? period : into) + (count - 1) * period;
+  }
+  uint64_t target = position_ - std::min(back, position_ - oldest());
+  return Seek(state, timing, target);
+}
+
+bool ExecutionHistory::RunBackToWrite(MachineState& state,
+                                      const TimingEngine& timing,
+                                      uint16_t address) {
+  Sync(state);
+  Location location;
+  if (position_ == 0 || !Latest(position_ - 1, location)) {
+    return false;
+  }
+  uint16_t page = Memory::PageOf(address);
+  // A write that finishes on the current clock is the one already shown, so
+  // repeating the search keeps moving back.
+  uint64_t end = position_ - 1;
+  uint64_t end_epoch = epoch_;
+  uint64_t end_generation = state.memory.generation(page);
+  // Walk the intervals between checkpoints newest first, replaying only
+  // those whose page generation moved.
+  while (true) {
+    const Checkpoint& checkpoint = At(location);
+    bool untouched = checkpoint.epoch == end_epoch &&
+                     checkpoint.generations[page] == end_generation;
+    uint64_t clock = 0;
+    if (checkpoint.clock < end && !untouched &&
+        FindWrite(location, end, timing, address, clock)) {
+      return Seek(state, timing, clock);
+    }
+    end = checkpoint.clock;
+    end_epoch = checkpoint.epoch;
+    end_generation = checkpoint.generations[page];
+    if (!Previous(location)) {
+      return false;
+    }
+  }
+}
+
+uint64_t ExecutionHistory::position() const { return position_; }
+
+uint64_t ExecutionHistory::oldest() const {
+  return segments_.empty() ? 0 : segments_.front().checkpoints.front().clock;
+}
+
+uint64_t ExecutionHistory::end() const { return end_; }
+
+size_t ExecutionHistory::checkpoints() const { return checkpoint_count_; }
+
+size_t ExecutionHistory::bytes() const {
+  size_t total = 0;
+  for (const Segment& segment : segments_) {
+    total += segment.bytes.size() +
+             segment.checkpoints.size() * sizeof(Checkpoint);
+  }
+  return total;
+}
+
+void ExecutionHistory::Record(const MachineState& state) {
+  if (rebase_ || segments_.empty() ||
+      segments_.back().checkpoints.size() >= kKeyframeEvery) {
+    segments_.emplace_back();
+    writer_.Reset();
+    rebase_ = false;
+  }
+  Segment& segment = segments_.back();
+  Checkpoint checkpoint;
+  checkpoint.clock = position_;
+  checkpoint.offset = segment.bytes.size();
+  checkpoint.epoch = epoch_;
+  for (uint16_t page = 0; page < Memory::kPages; ++page) {
+    checkpoint.generations[page] = state.memory.generation(page);
+  }
+  writer_.Append(state, position_, segment.bytes);
+  segment.checkpoints.push_back(checkpoint);
+  ++checkpoint_count_;
+
+  while (checkpoint_count_ > max_checkpoints_ && segments_.size() > 1) {
+    checkpoint_count_ -= segments_.front().checkpoints.size();
+    segments_.pop_front();
+  }
+}
+
+void ExecutionHistory::Saw(const MachineState& state) {
+  seen_.core() = state.core();
+  seen_.io = state.io;
+  seen_.panel_input = state.panel_input;
+}
+
+void ExecutionHistory::Truncate() {
+  if (position_ >= end_) {
+    return;
+  }
+  while (segments_.size() > 1 &&
+         segments_.back().checkpoints.front().clock > position_) {
+    checkpoint_count_ -= segments_.back().checkpoints.size();
+    segments_.pop_back();
+  }
+  Segment& segment = segments_.back();
+  while (segment.checkpoints.size() > 1 &&
+         segment.checkpoints.back().clock > position_) {
+    segment.bytes.resize(segment.checkpoints.back().offset);
+    segment.checkpoints.pop_back();
+    --checkpoint_count_;
+  }
+  end_ = position_;
+  rebase_ = true;
+}
+
+bool ExecutionHistory::Latest(uint64_t clock, Location& location) const {
+  for (size_t s = segments_.size(); s-- > 0;) {
+    const std::vector<Checkpoint>& checkpoints = segments_[s].checkpoints;
+    for (size_t i = checkpoints.size(); i-- > 0;) {
+      if (checkpoints[i].clock <= clock) {
+        location = {s, i};
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+const ExecutionHistory::Checkpoint& ExecutionHistory::At(
+    const Location& location) const {
+  return segments_[location.segment].checkpoints[location.index];
+}
+
+bool ExecutionHistory::Previous(Location& location) const {
+  if (location.index > 0) {
+    --location.index;
+    return true;
+  }
+  if (location.segment == 0) {
+    return false;
+  }
+  --location.segment;
+  location.index = segments_[location.segment].checkpoints.size() - 1;
+  return true;
+}
+
+void ExecutionHistory::Restore(const Location& location,
+                               MachineState& state) const {
+  const Segment& segment = segments_[location.segment];
+  std::span<const uint8_t> bytes(segment.bytes);
+  size_t pos = 0;
+  uint64_t clocks = 0;
+  for (size_t i = 0; i <= location.index; ++i) {
+    ApplyCheckpoint(bytes, pos, state, clocks, nullptr);
+  }
+  state.trace.Clear();
+}
+
+void ExecutionHistory::Replay(MachineState& state,
+                              const TimingEngine& timing,
+                              uint64_t clocks) {
+  StopConditions stop;
+  stop.halt = false;
+  UntracedRunner(execution_, &functional_)
+      .Run(state, timing, {BudgetUnit::Clocks, clocks}, stop);
+}
+
+// Replays from the checkpoint to end watching address. Whole instructions
+// first, then the last instruction that wrote it clock by clock, so clock
+// ends up just after the last write.
+bool ExecutionHistory::FindWrite(const Location& location,
+                                 uint64_t end,
+                                 const TimingEngine& timing,
+                                 uint16_t address,
+                                 uint64_t& clock) {
+  uint64_t start = At(location).clock;
+  Restore(location, scratch_);
+  scratch_.memory.Watch(address);
+  uint64_t now = start;
+  uint64_t hit_start = 0;
+  uint64_t hit_end = 0;
+  bool hit = false;
+  while (now < end) {
+    uint64_t hits = scratch_.memory.watch_hits();
+    uint64_t step = std::min(
+        BudgetClocks({BudgetUnit::Instructions, 1}, scratch_.timing),
+        end - now);
+    Replay(scratch_, timing, step);
+    if (scratch_.memory.watch_hits() != hits) {
+      hit = true;
+      hit_start = now;
+      hit_end = now + step;
+    }
+    now += step;
+  }
+  if (!hit) {
+    scratch_.memory.ClearWatch();
+    return false;
+  }
+
+  Restore(location, scratch_);
+  Replay(scratch_, timing, hit_start - start);
+  scratch_.memory.Watch(address);
+  for (now = hit_start; now < hit_end; ++now) {
+    uint64_t hits = scratch_.memory.watch_hits();
+    Replay(scratch_, timing, 1);
+    if (scratch_.memory.watch_hits() != hits) {
+      clock = now + 1;
+    }
+  }
+  scratch_.memory.ClearWatch();
+  return true;
+}
+
+}  // namespace ct10::core
@@ -0,0 +1,173 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include "core/checkpoint.h"
+#include "core/execution_engine.h"
+#include "core/functional_engine.h"
+#include "core/machine_state.h"
+#include "core/memory.h"
+#include "core/runner.h"
+#include "core/timing_engine.h"
+
+namespace ct10::core {
+
+// Timeline of one machine for stepping backwards. Runs made through Run
+// leave an in-memory delta checkpoint every interval clocks, and changes
+// made between runs (panel edits, loads) are checkpointed as they are
+// noticed. Moving to an earlier clock restores the nearest checkpoint at or
+// before it and re-executes the rest, so a seek costs at most one interval
+// of execution plus a short run of delta records, however long the program
+// has run. Moving back and then running or editing drops the later part of
+// the timeline.
+class ExecutionHistory {
+ public:
+  static constexpr uint64_t kDefaultInterval = 96 * 1024;
+  static constexpr size_t kDefaultMaxCheckpoints = 4096;
+  // Records per keyframe, which bounds the delta records a seek applies.
+  static constexpr size_t kKeyframeEvery = 16;
+
+  explicit ExecutionHistory(uint64_t interval = kDefaultInterval,
+                            size_t max_checkpoints = kDefaultMaxCheckpoints);
+
+  // Starts a new timeline at state, as clock zero.
+  void Reset(const MachineState& state);
+  // Checkpoints state at the current clock if it was changed since the
+  // history last saw it. Run and the seeks call this first.
+  void Sync(const MachineState& state);
+
+  // Runner::Run, split at checkpoint boundaries. The split never changes the
+  // outcome, breakpoints included.
+  template <typename Engine>
+  RunResult Run(const BasicRunner<Engine>& runner,
+                MachineState& state,
+                const TimingEngine& timing,
+                const RunBudget& budget,
+                const StopConditions& stop = {});
+
+  // Moves state to an earlier (or previously reached) clock. False, leaving
+  // state alone, when clock is outside [oldest(), end()].
+  bool Seek(MachineState& state, const TimingEngine& timing, uint64_t clock);
+  // Moves back count clocks, or to the count-th distributor or instruction
+  // boundary before the current clock, stopping at oldest().
+  bool StepBack(MachineState& state,
+                const TimingEngine& timing,
+                BudgetUnit unit,
+                uint64_t count);
+  // Moves state to just after the most recent write to address that
+  // finished before the current clock. False, leaving state alone, when the
+  // kept history holds none.
+  bool RunBackToWrite(MachineState& state,
+                      const TimingEngine& timing,
+                      uint16_t address);
+
+  // Clocks run since Reset.
+  uint64_t position() const;
+  // Earliest clock that can still be reached.
+  uint64_t oldest() const;
+  // Latest clock reached on the current timeline.
+  uint64_t end() const;
+  size_t checkpoints() const;
+  size_t bytes() const;
+
+ private:
+  struct Checkpoint {
+    uint64_t clock = 0;
+    size_t offset = 0;
+    // Seek count when recorded: generations are comparable only between
+    // checkpoints taken without a restore in between.
+    uint64_t epoch = 0;
+    std::array<uint64_t, Memory::kPages> generations{};
+  };
+  // A keyframe and the delta records after it.
+  struct Segment {
+    std::vector<uint8_t> bytes;
+    std::vector<Checkpoint> checkpoints;
+  };
+  struct Location {
+    size_t segment = 0;
+    size_t index = 0;
+  };
+
+  void Record(const MachineState& state);
+  void Saw(const MachineState& state);
+  void Truncate();
+  bool Latest(uint64_t clock, Location& location) const;
+  const Checkpoint& At(const Location& location) const;
+  bool Previous(Location& location) const;
+  void Restore(const Location& location, MachineState& state) const;
+  void Replay(MachineState& state,
+              const TimingEngine& timing,
+              uint64_t clocks);
+  bool FindWrite(const Location& location,
+                 uint64_t end,
+                 const TimingEngine& timing,
+                 uint16_t address,
+                 uint64_t& clock);
+
+  uint64_t interval_;
+  size_t max_checkpoints_;
+  std::deque<Segment> segments_;
+  size_t checkpoint_count_ = 0;
+  CheckpointWriter writer_;
+  // Set when the writer's last record was dropped, so the next record
+  // starts a segment with a keyframe.
+  bool rebase_ = true;
+  MachineState seen_;
+  MachineState scratch_;
+  UntracedExecutionEngine execution_;
+  FunctionalEngine functional_;
+  uint64_t position_ = 0;
+  uint64_t end_ = 0;
+  uint64_t epoch_ = 0;
+};
+
+template <typename Engine>
+RunResult ExecutionHistory::Run(const BasicRunner<Engine>& runner,
+                                MachineState& state,
+                                const TimingEngine& timing,
+                                const RunBudget& budget,
+                                const StopConditions& stop) {
+  Sync(state);
+  Truncate();
+  uint64_t limit = BudgetClocks(budget, state.timing);
+  RunResult total;
+  while (true) {
+    uint64_t next = segments_.back().checkpoints.back().clock + interval_;
+    uint64_t slice = std::min(limit - total.clocks, next - position_);
+    RunResult result =
+        runner.Run(state, timing, {BudgetUnit::Clocks, slice}, stop);
+    total.reason = result.reason;
+    total.clocks += result.clocks;
+    total.distributor_counts += result.distributor_counts;
+    total.instructions += result.instructions;
+    total.micro_ops += result.micro_ops;
+    total.wait_clocks += result.wait_clocks;
+    position_ += result.clocks;
+    end_ = position_;
+    if (position_ == next) {
+      Record(state);
+    }
+    if (result.reason != StopReason::BudgetExhausted ||
+        total.clocks >= limit) {
+      break;
+    }
+    // The runner skips breakpoints on the boundary it starts from, which a
+    // split run would otherwise miss.
+    if (stop.breakpoints.any() &&
+        FunctionalEngine::AtInstructionBoundary(state) &&
+        stop.breakpoints.test(state.par.value() & Memory::kAddressMask)) {
+      total.reason = StopReason::Breakpoint;
+      break;
+    }
+  }
+  Saw(state);
+  return total;
+}
+
+}  // namespace ct10::core
@@ -0,0 +1,549 @@
+#include "core/functional_engine.h"
+
+#include "core/machine_ops.h"
+#include "core/microcode_table.h"
+
+namespace ct10::core {
+namespace {
+
+constexpr uint32_t kAcquisitionClocks =
+    MicrocodeDispatch::kDistributorCounts * MicrocodeDispatch::kPhases;
+constexpr uint8_t kLastDistributor = MicrocodeDispatch::kDistributorCounts - 1;
+constexpr uint32_t kFullInstruction = FunctionalEngine::kClocksPerInstruction;
+
+using Instr = TranslatedInstruction;
+
+// Clocks consumed up to and including the given execution slot.
+constexpr uint32_t ExecutionClocks(uint8_t distributor, ClockPhase phase) {
+  return kAcquisitionClocks + distributor * MicrocodeDispatch::kPhases +
+         static_cast<uint32_t>(phase);
+}
+
+uint8_t Accumulator(const MachineState& state) {
+  return ToByte(state.accumulator.value());
+}
+
+uint16_t AccumulatorQuotient(const MachineState& state) {
+  return static_cast<uint16_t>((state.accumulator.value() << 8) |
+                               ToByte(state.quotient.value()));
+}
+
+void Begin(MachineState& state) {
+  state.status.wait = false;
+  LatchPanelStatus(state);
+  state.x_bus.Clear();
+  state.y_bus.Clear();
+  state.z_bus.Clear();
+  state.f_bus.Clear();
+}
+
+uint32_t Finish(MachineState& state,
+                const TimingEngine& timing,
+                uint32_t clocks,
+                bool completed) {
+  if (completed) {
+    state.distributor.Load(kLastDistributor);
+  }
+  LatchPanelStatus(state);
+  timing.AdvanceBy(state.timing, clocks);
+  return clocks;
+}
+
+// Acquisition: opcode into B and OP, PAR past the first byte. Execution D0
+// then clears the per-instruction error flags.
+void Acquire(MachineState& state, const Instr& instr) {
+  state.mar.Load(state.par.value());
+  state.buffer.Load(instr.opcode);
+  state.opcode.Load(instr.opcode);
+  IncrementPar(state);
+  state.flags.add_overflow = false;
+  state.flags.divide_overflow = false;
+  state.flags.inst_error = false;
+}
+
+uint8_t FetchImmediate(MachineState& state, const Instr& instr) {
+  Acquire(state, instr);
+  state.mar.Load(state.par.value());
+  state.buffer.Load(instr.operand);
+  IncrementPar(state);
+  return instr.operand;
+}
+
+void FetchAddress(MachineState& state, const Instr& instr) {
+  FetchImmediate(state, instr);
+  state.mar.Load(instr.target);
+  if (IsIndexed(instr.opcode)) {
+    state.mar.Load(state.mar.value() + state.index.value());
+  }
+}
+
+uint8_t FetchOperand(MachineState& state, const Instr& instr) {
+  FetchAddress(state, instr);
+  state.buffer.Load(state.memory.Read(state.mar.value()));
+  return ToByte(state.buffer.value());
+}
+
+uint32_t Complete(MachineState& state) {
+  UpdateFlags(state, Accumulator(state));
+  return kFullInstruction;
+}
+
+uint32_t CompleteWord(MachineState& state) {
+  UpdateFlagsWord(state, AccumulatorQuotient(state));
+  return kFullInstruction;
+}
+
+uint32_t Store(MachineState& state, const Instr& instr, uint8_t value) {
+  FetchAddress(state, instr);
+  state.buffer.Load(value);
+  state.memory.Write(state.mar.value(), value);
+  return Complete(state);
+}
+
+uint32_t Undefined(MachineState& state, const Instr& instr) {
+  Acquire(state, instr);
+  state.flags.inst_error = true;
+  if (!state.panel_input.error_inst) {
+    state.mode.halted = true;
+    state.distributor.Load(kLastDistributor);
+    return ExecutionClocks(0, ClockPhase::CP1);
+  }
+  return kFullInstruction;
+}
+
+uint32_t Sst(MachineState& state, const Instr& instr) {
+  FetchImmediate(state, instr);
+  LatchPanelStatus(state);
+  state.accumulator.Load(state.io.status);
+  return Complete(state);
+}
+
+uint32_t Lci(MachineState& state, const Instr& instr) {
+  state.countdown.Load(FetchImmediate(state, instr));
+  return Complete(state);
+}
+
+uint32_t Lai(MachineState& state, const Instr& instr) {
+  state.accumulator.Load(FetchImmediate(state, instr));
+  return Complete(state);
+}
+
+uint32_t Inx(MachineState& state, const Instr& instr) {
+  state.index.Load(state.index.value() + FetchImmediate(state, instr));
+  return Complete(state);
+}
+
+uint32_t Ski(MachineState& state, const Instr& instr) {
+  SkipIf(state, state.status.interrupt, FetchImmediate(state, instr));
+  state.io.interrupt = false;
+  return Complete(state);
+}
+
+uint32_t Sks(MachineState& state, const Instr& instr) {
+  SkipIf(state, state.status.sense, FetchImmediate(state, instr));
+  return Complete(state);
+}
+
+uint32_t Skf(MachineState& state, const Instr& instr) {
+  SkipIf(state, state.status.flag, FetchImmediate(state, instr));
+  return Complete(state);
+}
+
+uint32_t Sla(MachineState& state, const Instr& instr) {
+  ShiftLeftArithmetic(state, FetchImmediate(state, instr));
+  return CompleteWord(state);
+}
+
+uint32_t Sra(MachineState& state, const Instr& instr) {
+  ShiftRightArithmetic(state, FetchImmediate(state, instr));
+  return CompleteWord(state);
+}
+
+uint32_t Ocd(MachineState& state, const Instr& instr) {
+  SelectDevice(state, FetchImmediate(state, instr));
+  state.io.status = BuildStatusByte(state);
+  return Complete(state);
+}
+
+uint32_t Lxi(MachineState& state, const Instr& instr) {
+  state.index.Load(FetchImmediate(state, instr));
+  return Complete(state);
+}
+
+uint32_t Sll(MachineState& state, const Instr& instr) {
+  ShiftLeftLogical(state, FetchImmediate(state, instr));
+  return Complete(state);
+}
+
+uint32_t Srl(MachineState& state, const Instr& instr) {
+  ShiftRightLogical(state, FetchImmediate(state, instr));
+  return Complete(state);
+}
+
+uint32_t And(MachineState& state, const Instr& instr) {
+  state.accumulator.Load(Accumulator(state) & FetchImmediate(state, instr));
+  return Complete(state);
+}
+
+uint32_t Ior(MachineState& state, const Instr& instr) {
+  state.accumulator.Load(Accumulator(state) | FetchImmediate(state, instr));
+  return Complete(state);
+}
+
+uint32_t Xor(MachineState& state, const Instr& instr) {
+  state.accumulator.Load(Accumulator(state) ^ FetchImmediate(state, instr));
+  return Complete(state);
+}
+
+uint32_t Flc(MachineState& state, const Instr& instr) {
+  FetchImmediate(state, instr);
+  state.status.flag = false;
+  return Complete(state);
+}
+
+uint32_t Fls(MachineState& state, const Instr& instr) {
+  FetchImmediate(state, instr);
+  state.status.flag = true;
+  return Complete(state);
+}
+
+uint32_t Lda(MachineState& state, const Instr& instr) {
+  state.accumulator.Load(FetchOperand(state, instr));
+  return Complete(state);
+}
+
+uint32_t Lcc(MachineState& state, const Instr& instr) {
+  FetchAddress(state, instr);
+  CopyMemoryToNext(state);
+  return Complete(state);
+}
+
+uint32_t Lan(MachineState& state, const Instr& instr) {
+  state.accumulator.Load(
+      static_cast<uint8_t>(~FetchOperand(state, instr) + 1));
+  return Complete(state);
+}
+
+uint32_t Ldq(MachineState& state, const Instr& instr) {
+  state.quotient.Load(FetchOperand(state, instr));
+  return Complete(state);
+}
+
+uint32_t Sta(MachineState& state, const Instr& instr) {
+  return Store(state, instr, Accumulator(state));
+}
+
+uint32_t Stx(MachineState& state, const Instr& instr) {
+  return Store(state, instr, ToByte(state.index.value()));
+}
+
+uint32_t Stq(MachineState& state, const Instr& instr) {
+  return Store(state, instr, ToByte(state.quotient.value()));
+}
+
+// ADD/SUB overflow halts at execution D5 CP3 with A and B still on the Y and
+// X buses and the ALU result on F.
+uint32_t Arithmetic(MachineState& state, const Instr& instr, bool subtract) {
+  uint8_t b = FetchOperand(state, instr);
+  uint8_t a = Accumulator(state);
+  uint8_t result = subtract ? AluSubtract(state, a, b) : AluAdd(state, a, b);
+  if (state.mode.halted) {
+    state.y_bus.Drive(a);
+    state.x_bus.Drive(b);
+    state.f_bus.Drive(result);
+    state.distributor.Load(5);
+    return ExecutionClocks(5, ClockPhase::CP3);
+  }
+  state.accumulator.Load(result);
+  return Complete(state);
+}
+
+uint32_t Add(MachineState& state, const Instr& instr) {
+  return Arithmetic(state, instr, false);
+}
+
+uint32_t Sub(MachineState& state, const Instr& instr) {
+  return Arithmetic(state, instr, true);
+}
+
+uint32_t Mpy(MachineState& state, const Instr& instr) {
+  Multiply(state, FetchOperand(state, instr));
+  return CompleteWord(state);
+}
+
+uint32_t Div(MachineState& state, const Instr& instr) {
+  Divide(state, FetchOperand(state, instr));
+  if (state.mode.halted) {
+    state.distributor.Load(5);
+    return ExecutionClocks(5, ClockPhase::CP1);
+  }
+  UpdateFlags(state, ToByte(state.quotient.value()));
+  return kFullInstruction;
+}
+
+uint32_t Rao(MachineState& state, const Instr& instr) {
+  uint8_t value = FetchOperand(state, instr);
+  ReplaceAddOne(state, state.mar.value(), value);
+  return Complete(state);
+}
+
+uint32_t Rso(MachineState& state, const Instr& instr) {
+  uint8_t value = FetchOperand(state, instr);
+  ReplaceSubtractOne(state, state.mar.value(), value);
+  return Complete(state);
+}
+
+uint32_t BranchOp(MachineState& state, const Instr& instr) {
+  FetchAddress(state, instr);
+  Branch(state, instr.opcode);
+  if (state.mode.halted) {
+    state.distributor.Load(4);
+    return ExecutionClocks(4, ClockPhase::CP1);
+  }
+  return Complete(state);
+}
+
+Instr::Handler ImmediateHandler(uint8_t opcode) {
+  switch (opcode) {
+    case 0x00:
+      return Sst;
+    case 0x01:
+      return Lci;
+    case 0x02:
+      return Lai;
+    case 0x03:
+      return Inx;
+    case 0x08:
+      return Ski;
+    case 0x09:
+      return Sks;
+    case 0x0A:
+      return Skf;
+    case 0x0B:
+      return Sla;
+    case 0x10:
+      return Sra;
+    case 0x11:
+      return Ocd;
+    case 0x12:
+      return Lxi;
+    case 0x13:
+      return Sll;
+    case 0x18:
+      return Srl;
+    case 0x19:
+      return And;
+    case 0x1A:
+      return Ior;
+    case 0x1B:
+      return Xor;
+    case 0x28:
+      return Flc;
+    case 0xF8:
+      return Fls;
+    default:
+      return nullptr;
+  }
+}
+
+Instr::Handler MemoryHandler(uint8_t opcode) {
+  switch (opcode & 0xF8) {
+    case 0x20:
+      return Lda;
+    case 0x30:
+      return Lcc;
+    case 0x38:
+      return Lan;
+    case 0x40:
+      return Ldq;
+    case 0x48:
+      return Sta;
+    case 0x50:
+      return Stx;
+    case 0x58:
+      return Stq;
+    case 0x60:
+      return Add;
+    case 0x68:
+      return Sub;
+    case 0x70:
+      return Mpy;
+    case 0x78:
+      return Div;
+    case 0x80:
+      return Rao;
+    case 0x88:
+      return Rso;
+    case 0x90:
+    case 0x98:
+    case 0xA0:
+    case 0xA8:
+    case 0xB0:
+    case 0xB8:
+    case 0xC0:
+    case 0xC8:
+      return BranchOp;
+    default:
+      return nullptr;
+  }
+}
+
+bool WritesMemory(uint8_t opcode) {
+  switch (opcode & 0xF8) {
+    case 0x30:
+    case 0x48:
+    case 0x50:
+    case 0x58:
+    case 0x80:
+    case 0x88:
+    case 0xA0:
+      return true;
+    default:
+      return false;
+  }
+}
+
+bool EndsBlock(uint8_t opcode) {
+  return (opcode >= 0x08 && opcode <= 0x0A) ||
+         (opcode >= 0x90 && opcode < 0xD0);
+}
+
+}  // namespace
+
+FunctionalEngine::FunctionalEngine() : cache_(&FunctionalEngine::Decode) {
+  clock_.set_fast_forward(true);
+}
+
+bool FunctionalEngine::AtInstructionBoundary(const MachineState& state) {
+  return state.timing.acquisition && state.timing.distributor == 0 &&
+         state.timing.phase == ClockPhase::CP1 &&
+         state.io.transfer_mode == IoTransferMode::None;
+}
+
+const TranslationCache& FunctionalEngine::cache() const { return cache_; }
+
+void FunctionalEngine::set_microcode_coverage(MicrocodeCoverage* coverage) {
+  microcode_coverage_ = coverage;
+  clock_.set_microcode_coverage(coverage);
+}
+
+uint64_t FunctionalEngine::micro_ops() const { return micro_ops_; }
+
+uint64_t FunctionalEngine::wait_clocks() const { return wait_clocks_; }
+
+bool FunctionalEngine::Decode(uint8_t opcode,
+                              uint8_t operand,
+                              TranslatedInstruction& out) {
+  if (IsIoMemoryOpcode(opcode)) {
+    return false;
+  }
+  out.opcode = opcode;
+  out.operand = operand;
+  out.target = FormPageAddress(opcode, operand);
+  out.writes_memory = WritesMemory(opcode);
+  out.ends_block = EndsBlock(opcode);
+  if (!MicrocodeDispatch::Instance().HasExecution(opcode)) {
+    out.handler = Undefined;
+    out.ends_block = true;
+  } else if (Instr::Handler handler = ImmediateHandler(opcode)) {
+    out.handler = handler;
+  } else {
+    out.handler = MemoryHandler(opcode);
+  }
+  return true;
+}
+
+bool FunctionalEngine::CanExecute(const MachineState& state,
+                                  uint32_t max_clocks) const {
+  return max_clocks >= kClocksPerInstruction && !state.mode.halted &&
+         AtInstructionBoundary(state);
+}
+
+uint32_t FunctionalEngine::ExecuteInstruction(MachineState& state,
+                                              const TimingEngine& timing,
+                                              uint32_t max_clocks,
+                                              const InstructionProbes& probes) {
+  if (!CanExecute(state, max_clocks)) {
+    return 0;
+  }
+
+  uint16_t par = state.par.value();
+  uint8_t opcode = state.memory.Read(par);
+  if (IsIoMemoryOpcode(opcode)) {
+    uint64_t wait_clocks = wait_clocks_;
+    uint32_t clocks = RunClocks(state, timing, max_clocks);
+    probes.Record(par, opcode, clocks, wait_clocks_ - wait_clocks);
+    return clocks;
+  }
+
+  // With PAR held the operand fetch re-reads the opcode byte.
+  uint16_t operand_address =
+      ParInhibited(state) ? par : static_cast<uint16_t>(par + 1);
+  TranslatedInstruction instr;
+  Decode(opcode, state.memory.Read(operand_address), instr);
+
+  Begin(state);
+  uint32_t clocks = instr.handler(state, instr);
+  micro_ops_ += kMicrocodeDispatch.MicroOps(opcode, clocks);
+  if (microcode_coverage_) {
+    microcode_coverage_->MarkInstruction(opcode, clocks);
+  }
+  probes.Record(par, opcode, clocks);
+  return Finish(state, timing, clocks, !state.mode.halted);
+}
+
+uint32_t FunctionalEngine::ExecuteBlock(MachineState& state,
+                                        const TimingEngine& timing,
+                                        uint32_t max_clocks,
+                                        const InstructionProbes& probes) {
+  if (!CanExecute(state, max_clocks)) {
+    return 0;
+  }
+  const TranslatedBlock* block =
+      ParInhibited(state) ? nullptr
+                          : cache_.Lookup(state.memory, state.par.value());
+  if (!block) {
+    return ExecuteInstruction(state, timing, max_clocks, probes);
+  }
+
+  Begin(state);
+  uint32_t clocks = 0;
+  for (uint8_t i = 0; i < block->length; ++i) {
+    if (max_clocks - clocks < kClocksPerInstruction) {
+      break;
+    }
+    const TranslatedInstruction& instr = block->instructions[i];
+    uint32_t spent = instr.handler(state, instr);
+    micro_ops_ += kMicrocodeDispatch.MicroOps(instr.opcode, spent);
+    if (microcode_coverage_) {
+      microcode_coverage_->MarkInstruction(instr.opcode, spent);
+    }
+    probes.Record(static_cast<uint16_t>(block->start + 2 * i), instr.opcode,
+                  spent);
+    clocks += spent;
+    if (state.mode.halted ||
+        (instr.writes_memory && block->Contains(state.mar.value()))) {
+      break;
+    }
+  }
+  return Finish(state, timing, clocks, !state.mode.halted);
+}
+
+uint32_t FunctionalEngine::RunClocks(MachineState& state,
+                                     const TimingEngine& timing,
+                                     uint32_t max_clocks) {
+  uint32_t clocks = 0;
+  do {
+    micro_ops_ += clock_.Step(state);
+    if (state.status.wait) {
+      ++wait_clocks_;
+    }
+    timing.Advance(state.timing);
+    ++clocks;
+    clocks += clock_.FastForward(state, timing, max_clocks - clocks);
+  } while (clocks < max_clocks && !state.mode.halted &&
+           !AtInstructionBoundary(state));
+  return clocks;
+}
+
+}  // namespace ct10::core
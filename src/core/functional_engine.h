@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+
+#include "core/execution_engine.h"
+#include "core/machine_state.h"
+#include "core/instruction_probes.h"
+#include "core/timing_engine.h"
+#include "core/translation_cache.h"
+
+namespace ct10::core {
+
+// Instruction-level engine. Applies a whole instruction per call and reports
+// the clocks the clock-level engine would have spent, leaving registers,
+// memory, flags, I/O and timing exactly as ExecutionEngine would. Bus values
+// are only reproduced where an instruction halts mid-sequence, and no
+// micro-op trace is recorded.
+class FunctionalEngine {
+ public:
+  static constexpr uint32_t kClocksPerInstruction = 96;
+
+  FunctionalEngine();
+
+  // Executes the instruction at PAR when the machine sits on an instruction
+  // boundary, returning the clocks consumed (fewer than a full instruction if
+  // it halts). Returns 0 without touching the state when halted, off a
+  // boundary, or when max_clocks cannot cover a whole instruction; callers
+  // then fall back to ExecutionEngine::Step. Block I/O instructions are run
+  // clock by clock until the transfer completes, halts or exhausts
+  // max_clocks. Each instruction run is reported to probes.
+  uint32_t ExecuteInstruction(MachineState& state,
+                              const TimingEngine& timing,
+                              uint32_t max_clocks,
+                              const InstructionProbes& probes = {});
+
+  // Same contract as ExecuteInstruction, but runs as much of the translated
+  // basic block at PAR as max_clocks allows. A block stops after a branch,
+  // skip or halt, before an I/O instruction, and after any store into its
+  // own instructions.
+  uint32_t ExecuteBlock(MachineState& state,
+                        const TimingEngine& timing,
+                        uint32_t max_clocks,
+                        const InstructionProbes& probes = {});
+
+  const TranslationCache& cache() const;
+
+  // Marks the microcode of every instruction run, as the clock-level engine
+  // would have stepped it; null stops collecting.
+  void set_microcode_coverage(MicrocodeCoverage* coverage);
+
+  // Running totals over every call: the micro-ops the clock-level engine
+  // would have executed, and the clocks spent waiting on block I/O.
+  uint64_t micro_ops() const;
+  uint64_t wait_clocks() const;
+
+  static bool AtInstructionBoundary(const MachineState& state);
+
+ private:
+  static bool Decode(uint8_t opcode,
+                     uint8_t operand,
+                     TranslatedInstruction& out);
+
+  bool CanExecute(const MachineState& state, uint32_t max_clocks) const;
+  uint32_t RunClocks(MachineState& state,
+                     const TimingEngine& timing,
+                     uint32_t max_clocks);
+
+  UntracedExecutionEngine clock_;
+  TranslationCache cache_;
+  uint64_t micro_ops_ = 0;
+  uint64_t wait_clocks_ = 0;
+  MicrocodeCoverage* microcode_coverage_ = nullptr;
+};
+
+}  // namespace ct10::core
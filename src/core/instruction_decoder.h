@@ -3,15 +3,9 @@
 #include <cstdint>
 #include <string_view>
 
-namespace ct10::core {
+#include "core/instruction_set.h"
 
-enum class AddressingMode : uint8_t {
-  Direct,
-  Indexed,
-  Immediate,
-  Paged,
-  Unknown,
-};
+namespace ct10::core {
 
 struct Instruction {
   uint8_t opcode = 0;
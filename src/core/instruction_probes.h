@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+
+#include "core/coverage.h"
+#include "core/profile.h"
+
+namespace ct10::core {
+
+// Observers fed every instruction start and the clocks that follow it, by
+// the runner on the clock path and by the functional engine for the
+// instructions it runs. Either may be null.
+struct InstructionProbes {
+  Profile* profile = nullptr;
+  Coverage* coverage = nullptr;
+
+  bool any() const { return profile || coverage; }
+
+  void Begin(uint16_t address, uint8_t opcode) const {
+    if (profile) {
+      profile->Begin(address, opcode);
+    }
+    if (coverage) {
+      coverage->Begin(address, opcode);
+    }
+  }
+
+  void AddClocks(uint64_t clocks, uint64_t wait_clocks) const {
+    if (profile) {
+      profile->AddClocks(clocks, wait_clocks);
+    }
+  }
+
+  // A whole instruction.
+  void Record(uint16_t address,
+              uint8_t opcode,
+              uint64_t clocks,
+              uint64_t wait_clocks = 0) const {
+    Begin(address, opcode);
+    AddClocks(clocks, wait_clocks);
+  }
+};
+
+}  // namespace ct10::core
@@ -0,0 +1,267 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+#include "core/microcode.h"
+
+// Single compile-time description of the CT-10 instruction set. The
+// microcode tables, the instruction decoder and the assembler's mnemonic
+// table are all derived from kInstructionSet.
+
+namespace ct10::core {
+
+enum class AddressingMode : uint8_t {
+  Direct,
+  Indexed,
+  Immediate,
+  Paged,
+  Unknown,
+};
+
+// Fixed-capacity micro-op sequence that can be built in constant expressions.
+struct MicroSequence {
+  static constexpr size_t kCapacity = 14;
+
+  constexpr MicroSequence Then(uint8_t distributor,
+                               ClockPhase phase,
+                               MicroOp op) const {
+    MicroSequence next = *this;
+    next.steps[next.count++] = {distributor, phase, op};
+    return next;
+  }
+
+  constexpr std::span<const MicroOpStep> view() const {
+    return {steps.data(), count};
+  }
+
+  std::array<MicroOpStep, kCapacity> steps{};
+  size_t count = 0;
+};
+
+namespace microcode {
+
+constexpr MicroSequence Acquisition() {
+  return MicroSequence{}
+      .Then(0, ClockPhase::CP1, MicroOp::PAR_TO_MAR)
+      .Then(0, ClockPhase::CP2, MicroOp::MEM_TO_Z)
+      .Then(0, ClockPhase::CP3, MicroOp::Z_TO_BUFFER)
+      .Then(1, ClockPhase::CP1, MicroOp::BUFFER_TO_OPCODE)
+      .Then(1, ClockPhase::CP2, MicroOp::PAR_INC);
+}
+
+constexpr MicroSequence ImmediateFetch() {
+  return MicroSequence{}
+      .Then(2, ClockPhase::CP1, MicroOp::PAR_TO_MAR)
+      .Then(2, ClockPhase::CP2, MicroOp::MEM_TO_Z)
+      .Then(2, ClockPhase::CP3, MicroOp::Z_TO_BUFFER)
+      .Then(3, ClockPhase::CP1, MicroOp::PAR_INC);
+}
+
+constexpr MicroSequence AddressOnly() {
+  return MicroSequence{}
+      .Then(2, ClockPhase::CP1, MicroOp::PAR_TO_MAR)
+      .Then(2, ClockPhase::CP2, MicroOp::MEM_TO_Z)
+      .Then(2, ClockPhase::CP3, MicroOp::Z_TO_BUFFER)
+      .Then(3, ClockPhase::CP1, MicroOp::FORM_EFFECTIVE_ADDRESS)
+      .Then(3, ClockPhase::CP2, MicroOp::ADD_INDEX_TO_MAR)
+      .Then(3, ClockPhase::CP3, MicroOp::PAR_INC);
+}
+
+constexpr MicroSequence MemoryOperand() {
+  return AddressOnly()
+      .Then(4, ClockPhase::CP2, MicroOp::MEM_TO_Z)
+      .Then(4, ClockPhase::CP3, MicroOp::Z_TO_BUFFER);
+}
+
+// Immediate-operand instruction: op at D3 CP2, flags at D3 CP3.
+constexpr MicroSequence Immediate(MicroOp op,
+                                  MicroOp flags = MicroOp::UPDATE_FLAGS) {
+  return ImmediateFetch()
+      .Then(3, ClockPhase::CP2, op)
+      .Then(3, ClockPhase::CP3, flags);
+}
+
+// Memory-operand instruction: op at D5 CP1 on B, flags at D5 CP3.
+constexpr MicroSequence Memory(MicroOp op,
+                               MicroOp flags = MicroOp::UPDATE_FLAGS) {
+  return MemoryOperand()
+      .Then(5, ClockPhase::CP1, op)
+      .Then(5, ClockPhase::CP3, flags);
+}
+
+constexpr MicroSequence Lcc() {
+  return AddressOnly()
+      .Then(5, ClockPhase::CP1, MicroOp::COPY_MEM_TO_MEM_PLUS_ONE)
+      .Then(5, ClockPhase::CP3, MicroOp::UPDATE_FLAGS);
+}
+
+// STA/STX/STQ route the register through Z and B onto Y before writing.
+constexpr MicroSequence Store(MicroOp to_z) {
+  return AddressOnly()
+      .Then(4, ClockPhase::CP2, to_z)
+      .Then(4, ClockPhase::CP3, MicroOp::Z_TO_BUFFER)
+      .Then(5, ClockPhase::CP1, MicroOp::BUFFER_TO_Y)
+      .Then(5, ClockPhase::CP2, MicroOp::Y_TO_MEM)
+      .Then(5, ClockPhase::CP3, MicroOp::UPDATE_FLAGS);
+}
+
+constexpr MicroSequence Arithmetic(MicroOp alu) {
+  return MemoryOperand()
+      .Then(5, ClockPhase::CP1, MicroOp::ACC_TO_Y)
+      .Then(5, ClockPhase::CP2, MicroOp::BUFFER_TO_X)
+      .Then(5, ClockPhase::CP3, alu)
+      .Then(6, ClockPhase::CP1, MicroOp::F_TO_ACCUMULATOR)
+      .Then(6, ClockPhase::CP2, MicroOp::UPDATE_OVERFLOW)
+      .Then(6, ClockPhase::CP3, MicroOp::UPDATE_FLAGS);
+}
+
+constexpr MicroSequence Branch() {
+  return AddressOnly()
+      .Then(4, ClockPhase::CP1, MicroOp::BRANCH)
+      .Then(4, ClockPhase::CP3, MicroOp::UPDATE_FLAGS);
+}
+
+constexpr MicroSequence IoMemory() {
+  return AddressOnly()
+      .Then(4, ClockPhase::CP1, MicroOp::IO_NOOP)
+      .Then(4, ClockPhase::CP3, MicroOp::UPDATE_FLAGS);
+}
+
+}  // namespace microcode
+
+struct InstructionSpec {
+  std::string_view mnemonic;
+  uint8_t opcode = 0;
+  // Paged instructions occupy opcode..opcode+7: bits 0-1 select the page
+  // and bit 2 adds X to the address.
+  AddressingMode addressing = AddressingMode::Immediate;
+  bool halts = false;
+  MicroSequence execution;
+};
+
+inline constexpr MicroSequence kAcquisitionSequence = microcode::Acquisition();
+
+inline constexpr std::array<InstructionSpec, 44> kInstructionSet = {{
+    {"SST", 0x00, AddressingMode::Immediate, false,
+     microcode::Immediate(MicroOp::SENSE_STATUS)},
+    {"LCI", 0x01, AddressingMode::Immediate, false,
+     microcode::Immediate(MicroOp::LOAD_C_FROM_BUFFER)},
+    {"LAI", 0x02, AddressingMode::Immediate, false,
+     microcode::Immediate(MicroOp::LOAD_ACC_FROM_BUFFER)},
+    {"INX", 0x03, AddressingMode::Immediate, false,
+     microcode::Immediate(MicroOp::INCREMENT_X_BY_BUFFER)},
+    {"SKI", 0x08, AddressingMode::Immediate, false,
+     microcode::Immediate(MicroOp::SKIP_IF_INTERRUPT)},
+    {"SKS", 0x09, AddressingMode::Immediate, false,
+     microcode::Immediate(MicroOp::SKIP_IF_SENSE)},
+    {"SKF", 0x0A, AddressingMode::Immediate, false,
+     microcode::Immediate(MicroOp::SKIP_IF_FLAG)},
+    {"SLA", 0x0B, AddressingMode::Immediate, false,
+     microcode::Immediate(MicroOp::SHIFT_SLA, MicroOp::UPDATE_FLAGS_AQ)},
+    {"SRA", 0x10, AddressingMode::Immediate, false,
+     microcode::Immediate(MicroOp::SHIFT_SRA, MicroOp::UPDATE_FLAGS_AQ)},
+    {"OCD", 0x11, AddressingMode::Immediate, false,
+     microcode::Immediate(MicroOp::IO_NOOP)},
+    {"LXI", 0x12, AddressingMode::Immediate, false,
+     microcode::Immediate(MicroOp::LOAD_X_FROM_BUFFER)},
+    {"SLL", 0x13, AddressingMode::Immediate, false,
+     microcode::Immediate(MicroOp::SHIFT_SLL)},
+    {"SRL", 0x18, AddressingMode::Immediate, false,
+     microcode::Immediate(MicroOp::SHIFT_SRL)},
+    {"AND", 0x19, AddressingMode::Immediate, false,
+     microcode::Immediate(MicroOp::ALU_AND)},
+    {"IOR", 0x1A, AddressingMode::Immediate, false,
+     microcode::Immediate(MicroOp::ALU_IOR)},
+    {"XOR", 0x1B, AddressingMode::Immediate, false,
+     microcode::Immediate(MicroOp::ALU_XOR)},
+    {"FLC", 0x28, AddressingMode::Immediate, false,
+     microcode::Immediate(MicroOp::FLAG_CLEAR)},
+    {"FLS", 0xF8, AddressingMode::Immediate, false,
+     microcode::Immediate(MicroOp::FLAG_SET)},
+    {"LDA", 0x20, AddressingMode::Paged, false,
+     microcode::Memory(MicroOp::LOAD_ACC_FROM_BUFFER)},
+    {"LCC", 0x30, AddressingMode::Paged, false, microcode::Lcc()},
+    {"LAN", 0x38, AddressingMode::Paged, false,
+     microcode::Memory(MicroOp::LOAD_ACC_NEGATE_BUFFER)},
+    {"LDQ", 0x40, AddressingMode::Paged, false,
+     microcode::Memory(MicroOp::LOAD_Q_FROM_BUFFER)},
+    {"STA", 0x48, AddressingMode::Paged, false,
+     microcode::Store(MicroOp::ACC_TO_Z)},
+    {"STX", 0x50, AddressingMode::Paged, false,
+     microcode::Store(MicroOp::X_TO_Z)},
+    {"STQ", 0x58, AddressingMode::Paged, false,
+     microcode::Store(MicroOp::Q_TO_Z)},
+    {"ADD", 0x60, AddressingMode::Paged, false,
+     microcode::Arithmetic(MicroOp::ALU_ADD_TO_F)},
+    {"SUB", 0x68, AddressingMode::Paged, false,
+     microcode::Arithmetic(MicroOp::ALU_SUB_TO_F)},
+    {"MPY", 0x70, AddressingMode::Paged, false,
+     microcode::Memory(MicroOp::MULTIPLY, MicroOp::UPDATE_FLAGS_AQ)},
+    {"DIV", 0x78, AddressingMode::Paged, false,
+     microcode::Memory(MicroOp::DIVIDE, MicroOp::UPDATE_FLAGS_Q)},
+    {"RAO", 0x80, AddressingMode::Paged, false,
+     microcode::Memory(MicroOp::RAO)},
+    {"RSO", 0x88, AddressingMode::Paged, false,
+     microcode::Memory(MicroOp::RSO)},
+    {"BUN", 0x90, AddressingMode::Paged, false, microcode::Branch()},
+    {"BST", 0x98, AddressingMode::Paged, true, microcode::Branch()},
+    {"BSB", 0xA0, AddressingMode::Paged, false, microcode::Branch()},
+    {"BPS", 0xA8, AddressingMode::Paged, false, microcode::Branch()},
+    {"BZE", 0xB0, AddressingMode::Paged, false, microcode::Branch()},
+    {"BNG", 0xB8, AddressingMode::Paged, false, microcode::Branch()},
+    {"BNC", 0xC0, AddressingMode::Paged, false, microcode::Branch()},
+    {"BXZ", 0xC8, AddressingMode::Paged, false, microcode::Branch()},
+    {"WDB", 0xD0, AddressingMode::Paged, false, microcode::IoMemory()},
+    {"MNO", 0xD8, AddressingMode::Paged, false, microcode::IoMemory()},
+    {"RDB", 0xE0, AddressingMode::Paged, false, microcode::IoMemory()},
+    {"RDI", 0xE8, AddressingMode::Paged, false, microcode::IoMemory()},
+    {"MNI", 0xF0, AddressingMode::Paged, false, microcode::IoMemory()},
+}};
+
+inline constexpr uint8_t kNoInstruction = 0xFF;
+
+constexpr size_t InstructionVariants(const InstructionSpec& spec) {
+  return spec.addressing == AddressingMode::Paged ? 8 : 1;
+}
+
+constexpr std::array<uint8_t, 256> BuildInstructionIndex() {
+  std::array<uint8_t, 256> index{};
+  index.fill(kNoInstruction);
+  for (size_t i = 0; i < kInstructionSet.size(); ++i) {
+    const InstructionSpec& spec = kInstructionSet[i];
+    for (size_t v = 0; v < InstructionVariants(spec); ++v) {
+      index[spec.opcode + v] = static_cast<uint8_t>(i);
+    }
+  }
+  return index;
+}
+
+constexpr bool InstructionsOverlap() {
+  std::array<bool, 256> used{};
+  for (const InstructionSpec& spec : kInstructionSet) {
+    for (size_t v = 0; v < InstructionVariants(spec); ++v) {
+      if (used[spec.opcode + v]) {
+        return true;
+      }
+      used[spec.opcode + v] = true;
+    }
+  }
+  return false;
+}
+
+static_assert(!InstructionsOverlap(), "opcode assigned to two instructions");
+
+// kInstructionSet index for each opcode byte, or kNoInstruction.
+inline constexpr std::array<uint8_t, 256> kInstructionIndex =
+    BuildInstructionIndex();
+
+constexpr const InstructionSpec* FindInstruction(uint8_t opcode) {
+  uint8_t index = kInstructionIndex[opcode];
+  return index == kNoInstruction ? nullptr : &kInstructionSet[index];
+}
+
+}  // namespace ct10::core
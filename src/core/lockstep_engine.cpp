@@ -0,0 +1,708 @@
+#include "core/lockstep_engine.h"
+
+#include <algorithm>
+#include <array>
+
+#include "core/machine_ops.h"
+#include "core/microcode_table.h"
+#include "core/runner.h"
+
+namespace ct10::core {
+namespace {
+
+constexpr size_t kLanes = LockstepEngine::kLanes;
+constexpr uint32_t kFullInstruction = FunctionalEngine::kClocksPerInstruction;
+constexpr uint16_t kAddressMask = Memory::kAddressMask;
+constexpr uint8_t kLastDistributor = MicrocodeDispatch::kDistributorCounts - 1;
+
+using Bytes = std::array<uint8_t, kLanes>;
+using Words = std::array<uint16_t, kLanes>;
+
+// Lane masks hold 0 or 1. Every lane loop computes all lanes and blends the
+// result in, so the loops stay branch-free and compile to vector code.
+template <typename T>
+T Blend(uint8_t mask, T value, T old) {
+  T select = static_cast<T>(0 - static_cast<T>(mask));
+  return static_cast<T>((value & select) | (old & ~select));
+}
+
+// I/O, status reads and halts go through the scalar runner instead.
+bool Vectorizable(uint8_t opcode) {
+  if (!MicrocodeDispatch::Instance().HasExecution(opcode) ||
+      IsIoMemoryOpcode(opcode)) {
+    return false;
+  }
+  switch (opcode) {
+    case 0x00:  // SST
+    case 0x08:  // SKI
+    case 0x09:  // SKS
+    case 0x11:  // OCD
+      return false;
+    default:
+      return (opcode & 0xF8) != 0x98;  // BST
+  }
+}
+
+bool ReadsOperand(uint8_t opcode) {
+  switch (opcode & 0xF8) {
+    case 0x20:
+    case 0x38:
+    case 0x40:
+    case 0x60:
+    case 0x68:
+    case 0x70:
+    case 0x78:
+    case 0x80:
+    case 0x88:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// FLC sits among the memory-reference opcodes but takes an immediate.
+bool IsMemoryOpcode(uint8_t opcode) {
+  return opcode >= 0x20 && opcode < 0xD0 && opcode != 0x28;
+}
+
+}  // namespace
+
+// Structure-of-arrays copy of the lane machines. Only state that a
+// vectorized instruction reads or writes is held here; the rest stays in
+// the MachineState and is brought up to date by Store.
+struct LockstepEngine::Lanes {
+  Words par{};
+  Words mar{};
+  Bytes accumulator{};
+  Bytes buffer{};
+  Bytes quotient{};
+  Bytes index{};
+  Bytes countdown{};
+  Bytes opcode{};
+  Bytes carry{};
+  Bytes zero{};
+  Bytes greater{};
+  Bytes less{};
+  Bytes add_overflow{};
+  Bytes divide_overflow{};
+  Bytes inst_error{};
+  Bytes flag{};
+  Bytes error_add{};
+  Bytes error_div{};
+  std::array<Bytes, Memory::kSize> memory{};
+  // Clocks run in the vector unit since the lane was last stored.
+  std::array<uint32_t, kLanes> pending{};
+  Bytes active{};
+
+  uint8_t Read(size_t lane, uint16_t address) const {
+    return memory[address & kAddressMask][lane];
+  }
+
+  void Write(const Bytes& mask, const Words& address, const Bytes& value) {
+    for (size_t l = 0; l < kLanes; ++l) {
+      uint8_t& cell = memory[address[l] & kAddressMask][l];
+      cell = Blend(mask[l], value[l], cell);
+    }
+  }
+
+  void WriteRow(const Bytes& mask, uint16_t address, const Bytes& value) {
+    Bytes& row = memory[address & kAddressMask];
+    for (size_t l = 0; l < kLanes; ++l) {
+      row[l] = Blend(mask[l], value[l], row[l]);
+    }
+  }
+
+  // MAR after FetchAddress, without touching the lanes.
+  Words Address(uint8_t instruction, uint8_t operand) const {
+    Words address;
+    uint16_t target = FormPageAddress(instruction, operand);
+    uint16_t indexed = IsIndexed(instruction) ? 0xFFFF : 0;
+    for (size_t l = 0; l < kLanes; ++l) {
+      address[l] = static_cast<uint16_t>(
+          (target + (index[l] & indexed)) & kAddressMask);
+    }
+    return address;
+  }
+
+  Bytes Gather(const Words& address) const {
+    Bytes values;
+    for (size_t l = 0; l < kLanes; ++l) {
+      values[l] = Read(l, address[l]);
+    }
+    return values;
+  }
+
+  // Lanes where ADD, SUB or DIV would halt.
+  Bytes Halts(const Bytes& mask, uint8_t instruction, uint8_t operand) const {
+    Bytes halts{};
+    uint8_t op = static_cast<uint8_t>(instruction & 0xF8);
+    if (op != 0x60 && op != 0x68 && op != 0x78) {
+      return halts;
+    }
+    Bytes values = Gather(Address(instruction, operand));
+    for (size_t l = 0; l < kLanes; ++l) {
+      uint8_t a = accumulator[l];
+      uint8_t b = values[l];
+      bool halt = false;
+      if (op == 0x60) {
+        uint8_t result = static_cast<uint8_t>(a + b);
+        halt = ((a ^ result) & (b ^ result) & 0x80) != 0 && !error_add[l];
+      } else if (op == 0x68) {
+        uint8_t result = static_cast<uint8_t>(a - b);
+        halt = ((a ^ b) & (a ^ result) & 0x80) != 0 && !error_add[l];
+      } else {
+        int16_t dividend = static_cast<int16_t>((a << 8) | quotient[l]);
+        int16_t divisor = static_cast<int8_t>(b);
+        bool error = divisor == 0;
+        if (!error) {
+          int16_t result = static_cast<int16_t>(dividend / divisor);
+          error = result < -128 || result > 127;
+        }
+        halt = error && !error_div[l];
+      }
+      halts[l] = static_cast<uint8_t>(mask[l] & halt);
+    }
+    return halts;
+  }
+
+  void UpdateFlags(const Bytes& mask) {
+    for (size_t l = 0; l < kLanes; ++l) {
+      uint8_t value = accumulator[l];
+      zero[l] = Blend<uint8_t>(mask[l], value == 0, zero[l]);
+      bool positive = (value & 0x80) == 0 && value != 0;
+      greater[l] = Blend<uint8_t>(mask[l], positive, greater[l]);
+      less[l] = Blend<uint8_t>(mask[l], (value & 0x80) != 0, less[l]);
+    }
+  }
+
+  void UpdateFlagsWord(const Bytes& mask, const Bytes& high, const Bytes& low) {
+    for (size_t l = 0; l < kLanes; ++l) {
+      bool sign = (high[l] & 0x80) != 0;
+      bool is_zero = (high[l] | low[l]) == 0;
+      zero[l] = Blend<uint8_t>(mask[l], is_zero, zero[l]);
+      greater[l] = Blend<uint8_t>(mask[l], !sign && !is_zero, greater[l]);
+      less[l] = Blend<uint8_t>(mask[l], sign, less[l]);
+    }
+  }
+
+  // Applies one complete, non-halting instruction at leader_par to the
+  // masked lanes, mirroring the FunctionalEngine handlers.
+  void Execute(const Bytes& mask,
+               uint16_t leader_par,
+               uint8_t op,
+               uint8_t operand) {
+    uint16_t operand_address =
+        static_cast<uint16_t>((leader_par + 1) & kAddressMask);
+    uint16_t next_par = static_cast<uint16_t>((leader_par + 2) & kAddressMask);
+    for (size_t l = 0; l < kLanes; ++l) {
+      uint8_t m = mask[l];
+      opcode[l] = Blend(m, op, opcode[l]);
+      add_overflow[l] = Blend<uint8_t>(m, 0, add_overflow[l]);
+      divide_overflow[l] = Blend<uint8_t>(m, 0, divide_overflow[l]);
+      inst_error[l] = Blend<uint8_t>(m, 0, inst_error[l]);
+      buffer[l] = Blend(m, operand, buffer[l]);
+      par[l] = Blend(m, next_par, par[l]);
+      mar[l] = Blend(m, operand_address, mar[l]);
+    }
+    if (IsMemoryOpcode(op)) {
+      Words address = Address(op, operand);
+      for (size_t l = 0; l < kLanes; ++l) {
+        mar[l] = Blend(mask[l], address[l], mar[l]);
+      }
+      if (ReadsOperand(op)) {
+        // Without indexing every lane reads the same cell, one memory row.
+        const Bytes values = IsIndexed(op)
+                                 ? Gather(mar)
+                                 : memory[FormPageAddress(op, operand)];
+        for (size_t l = 0; l < kLanes; ++l) {
+          buffer[l] = Blend(mask[l], values[l], buffer[l]);
+        }
+      }
+      ExecuteMemory(mask, op, operand);
+    } else {
+      ExecuteImmediate(mask, op, operand);
+    }
+  }
+
+  void ExecuteImmediate(const Bytes& mask, uint8_t op, uint8_t operand) {
+    switch (op) {
+      case 0x01:  // LCI
+        for (size_t l = 0; l < kLanes; ++l) {
+          countdown[l] = Blend(mask[l], operand, countdown[l]);
+        }
+        break;
+      case 0x02:  // LAI
+        for (size_t l = 0; l < kLanes; ++l) {
+          accumulator[l] = Blend(mask[l], operand, accumulator[l]);
+        }
+        break;
+      case 0x03:  // INX
+        for (size_t l = 0; l < kLanes; ++l) {
+          index[l] = Blend(mask[l], static_cast<uint8_t>(index[l] + operand),
+                           index[l]);
+        }
+        break;
+      case 0x0A:  // SKF
+        for (size_t l = 0; l < kLanes; ++l) {
+          countdown[l] = Blend(mask[l], operand, countdown[l]);
+          uint16_t skipped =
+              static_cast<uint16_t>((par[l] + 2u * operand) & kAddressMask);
+          par[l] = Blend(static_cast<uint8_t>(mask[l] & flag[l]), skipped,
+                         par[l]);
+        }
+        break;
+      case 0x0B:  // SLA
+      case 0x10:  // SRA
+        Shift(mask, op == 0x0B, operand);
+        return;
+      case 0x12:  // LXI
+        for (size_t l = 0; l < kLanes; ++l) {
+          index[l] = Blend(mask[l], operand, index[l]);
+        }
+        break;
+      case 0x13:  // SLL
+      case 0x18:  // SRL
+        for (size_t l = 0; l < kLanes; ++l) {
+          uint8_t value = 0;
+          if (operand < 8) {
+            int shifted = op == 0x13 ? accumulator[l] << operand
+                                     : accumulator[l] >> operand;
+            value = static_cast<uint8_t>(shifted);
+          }
+          accumulator[l] = Blend(mask[l], value, accumulator[l]);
+        }
+        break;
+      case 0x19:  // AND
+        for (size_t l = 0; l < kLanes; ++l) {
+          uint8_t value = static_cast<uint8_t>(accumulator[l] & operand);
+          accumulator[l] = Blend(mask[l], value, accumulator[l]);
+        }
+        break;
+      case 0x1A:  // IOR
+        for (size_t l = 0; l < kLanes; ++l) {
+          uint8_t value = static_cast<uint8_t>(accumulator[l] | operand);
+          accumulator[l] = Blend(mask[l], value, accumulator[l]);
+        }
+        break;
+      case 0x1B:  // XOR
+        for (size_t l = 0; l < kLanes; ++l) {
+          uint8_t value = static_cast<uint8_t>(accumulator[l] ^ operand);
+          accumulator[l] = Blend(mask[l], value, accumulator[l]);
+        }
+        break;
+      case 0x28:  // FLC
+      case 0xF8:  // FLS
+        for (size_t l = 0; l < kLanes; ++l) {
+          flag[l] = Blend<uint8_t>(mask[l], op == 0xF8, flag[l]);
+        }
+        break;
+      default:
+        break;
+    }
+    UpdateFlags(mask);
+  }
+
+  void Shift(const Bytes& mask, bool left, uint8_t count) {
+    for (size_t l = 0; l < kLanes; ++l) {
+      uint16_t word =
+          static_cast<uint16_t>((accumulator[l] << 8) | quotient[l]);
+      if (left) {
+        word = count >= 16 ? 0 : static_cast<uint16_t>(word << count);
+      } else {
+        int16_t value = static_cast<int16_t>(word);
+        value = count >= 16 ? static_cast<int16_t>(value < 0 ? -1 : 0)
+                            : static_cast<int16_t>(value >> count);
+        word = static_cast<uint16_t>(value);
+      }
+      accumulator[l] =
+          Blend(mask[l], static_cast<uint8_t>(word >> 8), accumulator[l]);
+      quotient[l] = Blend(mask[l], static_cast<uint8_t>(word), quotient[l]);
+    }
+    UpdateFlagsWord(mask, accumulator, quotient);
+  }
+
+  void ExecuteMemory(const Bytes& mask, uint8_t instruction, uint8_t operand) {
+    uint8_t op = static_cast<uint8_t>(instruction & 0xF8);
+    switch (op) {
+      case 0x20:  // LDA
+        for (size_t l = 0; l < kLanes; ++l) {
+          accumulator[l] = Blend(mask[l], buffer[l], accumulator[l]);
+        }
+        break;
+      case 0x30: {  // LCC
+        Bytes values = Gather(mar);
+        Words next;
+        for (size_t l = 0; l < kLanes; ++l) {
+          next[l] = static_cast<uint16_t>((mar[l] + 1) & kAddressMask);
+        }
+        Write(mask, next, values);
+        for (size_t l = 0; l < kLanes; ++l) {
+          mar[l] = Blend(mask[l], next[l], mar[l]);
+        }
+        break;
+      }
+      case 0x38:  // LAN
+        for (size_t l = 0; l < kLanes; ++l) {
+          accumulator[l] = Blend(mask[l], static_cast<uint8_t>(~buffer[l] + 1),
+                                 accumulator[l]);
+        }
+        break;
+      case 0x40:  // LDQ
+        for (size_t l = 0; l < kLanes; ++l) {
+          quotient[l] = Blend(mask[l], buffer[l], quotient[l]);
+        }
+        break;
+      case 0x48:  // STA
+      case 0x50:  // STX
+      case 0x58: {  // STQ
+        const Bytes& source =
+            op == 0x48 ? accumulator : (op == 0x50 ? index : quotient);
+        for (size_t l = 0; l < kLanes; ++l) {
+          buffer[l] = Blend(mask[l], source[l], buffer[l]);
+        }
+        if (IsIndexed(instruction)) {
+          Write(mask, mar, buffer);
+        } else {
+          WriteRow(mask, FormPageAddress(instruction, operand), buffer);
+        }
+        break;
+      }
+      case 0x60:  // ADD
+      case 0x68:  // SUB
+        for (size_t l = 0; l < kLanes; ++l) {
+          uint8_t a = accumulator[l];
+          uint8_t b = buffer[l];
+          uint8_t result;
+          bool carry_out;
+          bool overflow;
+          if (op == 0x60) {
+            result = static_cast<uint8_t>(a + b);
+            carry_out = a + b > 0xFF;
+            overflow = ((a ^ result) & (b ^ result) & 0x80) != 0;
+          } else {
+            result = static_cast<uint8_t>(a - b);
+            carry_out = a >= b;
+            overflow = ((a ^ b) & (a ^ result) & 0x80) != 0;
+          }
+          carry[l] = Blend<uint8_t>(mask[l], carry_out, carry[l]);
+          add_overflow[l] = Blend<uint8_t>(mask[l], overflow, add_overflow[l]);
+          accumulator[l] = Blend(mask[l], result, accumulator[l]);
+        }
+        break;
+      case 0x70:  // MPY
+        for (size_t l = 0; l < kLanes; ++l) {
+          int16_t product = static_cast<int16_t>(
+              static_cast<int8_t>(accumulator[l]) *
+              static_cast<int8_t>(buffer[l]));
+          accumulator[l] = Blend(mask[l], static_cast<uint8_t>(product >> 8),
+                                 accumulator[l]);
+          quotient[l] =
+              Blend(mask[l], static_cast<uint8_t>(product), quotient[l]);
+        }
+        UpdateFlagsWord(mask, accumulator, quotient);
+        return;
+      case 0x78:  // DIV
+        Divide(mask);
+        return;
+      case 0x80:  // RAO
+      case 0x88: {  // RSO
+        Bytes results;
+        for (size_t l = 0; l < kLanes; ++l) {
+          uint8_t value = buffer[l];
+          results[l] = static_cast<uint8_t>(op == 0x80 ? value + 1 : value - 1);
+          bool carry_out = op == 0x80 ? value == 0xFF : value == 0x00;
+          carry[l] = Blend<uint8_t>(mask[l], carry_out, carry[l]);
+          accumulator[l] = Blend(mask[l], results[l], accumulator[l]);
+        }
+        Write(mask, mar, results);
+        break;
+      }
+      default:
+        Branch(mask, instruction);
+        break;
+    }
+    UpdateFlags(mask);
+  }
+
+  // Lanes that would halt were already sent to the scalar runner, so an
+  // error here is always one the panel switch lets through.
+  void Divide(const Bytes& mask) {
+    for (size_t l = 0; l < kLanes; ++l) {
+      if (!mask[l]) {
+        continue;
+      }
+      int16_t dividend =
+          static_cast<int16_t>((accumulator[l] << 8) | quotient[l]);
+      int16_t divisor = static_cast<int8_t>(buffer[l]);
+      bool error = divisor == 0;
+      int16_t result = 0;
+      if (!error) {
+        result = static_cast<int16_t>(dividend / divisor);
+        error = result < -128 || result > 127;
+      }
+      divide_overflow[l] = error;
+      if (!error) {
+        quotient[l] = static_cast<uint8_t>(result);
+        accumulator[l] = static_cast<uint8_t>(dividend % divisor);
+      }
+      uint8_t value = quotient[l];
+      zero[l] = value == 0;
+      greater[l] = (value & 0x80) == 0 && value != 0;
+      less[l] = (value & 0x80) != 0;
+    }
+  }
+
+  void Branch(const Bytes& mask, uint8_t instruction) {
+    uint8_t op = static_cast<uint8_t>(instruction & 0xF8);
+    if (op == 0xA0) {  // BSB
+      Bytes return_opcode;
+      Bytes return_low;
+      Words link;
+      for (size_t l = 0; l < kLanes; ++l) {
+        return_opcode[l] = EncodeBunOpcode(par[l]);
+        return_low[l] = static_cast<uint8_t>(par[l] & 0xFF);
+        link[l] = static_cast<uint16_t>((mar[l] + 1) & kAddressMask);
+      }
+      Write(mask, mar, return_opcode);
+      Write(mask, link, return_low);
+      for (size_t l = 0; l < kLanes; ++l) {
+        par[l] = Blend(mask[l],
+                       static_cast<uint16_t>((mar[l] + 2) & kAddressMask),
+                       par[l]);
+      }
+      return;
+    }
+    for (size_t l = 0; l < kLanes; ++l) {
+      bool take = false;
+      switch (op) {
+        case 0x90:
+          take = true;
+          break;
+        case 0xA8:
+          take = greater[l];
+          break;
+        case 0xB0:
+          take = zero[l];
+          break;
+        case 0xB8:
+          take = less[l];
+          break;
+        case 0xC0:
+          take = !carry[l];
+          break;
+        case 0xC8:
+          take = index[l] == 0;
+          break;
+        default:
+          break;
+      }
+      par[l] = Blend(static_cast<uint8_t>(mask[l] & take), mar[l], par[l]);
+    }
+  }
+};
+
+LockstepEngine::LockstepEngine() : lanes_(std::make_unique<Lanes>()) {}
+
+LockstepEngine::~LockstepEngine() = default;
+
+uint64_t LockstepEngine::vector_instructions() const {
+  return vector_instructions_;
+}
+
+uint64_t LockstepEngine::scalar_steps() const { return scalar_steps_; }
+
+void LockstepEngine::Run(std::span<MachineState> machines,
+                         const TimingEngine& timing,
+                         uint64_t max_clocks,
+                         std::span<uint64_t> clocks) {
+  for (size_t first = 0; first < machines.size(); first += kLanes) {
+    size_t count = std::min(kLanes, machines.size() - first);
+    RunChunk(machines.subspan(first, count), timing, max_clocks,
+             clocks.subspan(first, count));
+  }
+}
+
+void LockstepEngine::RunChunk(std::span<MachineState> machines,
+                              const TimingEngine& timing,
+                              uint64_t max_clocks,
+                              std::span<uint64_t> clocks) {
+  Lanes& lanes = *lanes_;
+  lanes.active.fill(0);
+  for (size_t l = 0; l < machines.size(); ++l) {
+    clocks[l] = 0;
+    MachineState& machine = machines[l];
+    if (machine.mode.halted || ParInhibited(machine) ||
+        !FunctionalEngine::AtInstructionBoundary(machine)) {
+      lanes.pending[l] = 0;
+      clocks[l] = StepScalar(l, machine, timing, max_clocks, false);
+    } else {
+      Load(l, machine);
+    }
+  }
+
+  while (true) {
+    size_t leader = kLanes;
+    for (size_t l = 0; l < machines.size(); ++l) {
+      if (lanes.active[l] && (leader == kLanes || clocks[l] < clocks[leader])) {
+        leader = l;
+      }
+    }
+    if (leader == kLanes) {
+      break;
+    }
+    // The leader has the most budget left; once it cannot fit a whole
+    // instruction no lane can.
+    if (max_clocks - clocks[leader] < kFullInstruction) {
+      for (size_t l = 0; l < machines.size(); ++l) {
+        if (lanes.active[l]) {
+          clocks[l] += StepScalar(l, machines[l], timing,
+                                  max_clocks - clocks[l], false);
+        }
+      }
+      break;
+    }
+
+    uint16_t par = lanes.par[leader];
+    uint8_t op = lanes.Read(leader, par);
+    uint8_t operand = lanes.Read(leader, static_cast<uint16_t>(par + 1));
+    const Bytes& op_row = lanes.memory[par];
+    const Bytes& operand_row = lanes.memory[(par + 1) & kAddressMask];
+    Bytes group{};
+    size_t members = 0;
+    for (size_t l = 0; l < machines.size(); ++l) {
+      group[l] = static_cast<uint8_t>(
+          lanes.active[l] & (lanes.par[l] == par) & (op_row[l] == op) &
+          (operand_row[l] == operand) &
+          (max_clocks - clocks[l] >= kFullInstruction));
+      members += group[l];
+    }
+
+    if (members == 1) {
+      clocks[leader] += StepScalar(leader, machines[leader], timing,
+                                   max_clocks - clocks[leader], false);
+      continue;
+    }
+    Bytes scalar = Vectorizable(op) ? lanes.Halts(group, op, operand) : group;
+    for (size_t l = 0; l < machines.size(); ++l) {
+      if (scalar[l]) {
+        group[l] = 0;
+        clocks[l] += StepScalar(l, machines[l], timing,
+                                max_clocks - clocks[l], true);
+      }
+    }
+    if (!Vectorizable(op)) {
+      continue;
+    }
+
+    lanes.Execute(group, par, op, operand);
+    ++vector_instructions_;
+    for (size_t l = 0; l < machines.size(); ++l) {
+      clocks[l] += group[l] * kFullInstruction;
+      lanes.pending[l] += group[l] * kFullInstruction;
+    }
+  }
+}
+
+void LockstepEngine::Load(size_t lane, const MachineState& machine) {
+  Lanes& lanes = *lanes_;
+  lanes.par[lane] = machine.par.value();
+  lanes.mar[lane] = machine.mar.value();
+  lanes.accumulator[lane] = ToByte(machine.accumulator.value());
+  lanes.buffer[lane] = ToByte(machine.buffer.value());
+  lanes.quotient[lane] = ToByte(machine.quotient.value());
+  lanes.index[lane] = ToByte(machine.index.value());
+  lanes.countdown[lane] = ToByte(machine.countdown.value());
+  lanes.opcode[lane] = ToByte(machine.opcode.value());
+  lanes.carry[lane] = machine.flags.carry;
+  lanes.zero[lane] = machine.flags.zero;
+  lanes.greater[lane] = machine.flags.greater;
+  lanes.less[lane] = machine.flags.less;
+  lanes.add_overflow[lane] = machine.flags.add_overflow;
+  lanes.divide_overflow[lane] = machine.flags.divide_overflow;
+  lanes.inst_error[lane] = machine.flags.inst_error;
+  lanes.flag[lane] = machine.status.flag;
+  lanes.error_add[lane] = machine.panel_input.error_add;
+  lanes.error_div[lane] = machine.panel_input.error_div;
+  const std::array<uint8_t, Memory::kSize>& cells = machine.memory.cells();
+  for (uint16_t address = 0; address < Memory::kSize; ++address) {
+    lanes.memory[address][lane] = cells[address];
+  }
+  lanes.pending[lane] = 0;
+  lanes.active[lane] = 1;
+}
+
+// Writes the lane back and applies what every vector instruction would have
+// left behind: cleared buses, the last distributor count, the latched panel
+// status and the timing advance.
+void LockstepEngine::Store(size_t lane,
+                           MachineState& machine,
+                           const TimingEngine& timing) {
+  Lanes& lanes = *lanes_;
+  lanes.active[lane] = 0;
+  if (lanes.pending[lane] == 0) {
+    return;
+  }
+  machine.par.Load(lanes.par[lane]);
+  machine.mar.Load(lanes.mar[lane]);
+  machine.accumulator.Load(lanes.accumulator[lane]);
+  machine.buffer.Load(lanes.buffer[lane]);
+  machine.quotient.Load(lanes.quotient[lane]);
+  machine.index.Load(lanes.index[lane]);
+  machine.countdown.Load(lanes.countdown[lane]);
+  machine.opcode.Load(lanes.opcode[lane]);
+  machine.flags.carry = lanes.carry[lane];
+  machine.flags.zero = lanes.zero[lane];
+  machine.flags.greater = lanes.greater[lane];
+  machine.flags.less = lanes.less[lane];
+  machine.flags.add_overflow = lanes.add_overflow[lane];
+  machine.flags.divide_overflow = lanes.divide_overflow[lane];
+  machine.flags.inst_error = lanes.inst_error[lane];
+  machine.status.flag = lanes.flag[lane];
+  // Only changed bytes are written so untouched pages stay clean.
+  for (uint16_t address = 0; address < Memory::kSize; ++address) {
+    uint8_t value = lanes.memory[address][lane];
+    if (machine.memory.Read(address) != value) {
+      machine.memory.Write(address, value);
+    }
+  }
+
+  machine.status.wait = false;
+  machine.x_bus.Clear();
+  machine.y_bus.Clear();
+  machine.z_bus.Clear();
+  machine.f_bus.Clear();
+  machine.distributor.Load(kLastDistributor);
+  LatchPanelStatus(machine);
+  timing.AdvanceBy(machine.timing, lanes.pending[lane]);
+  lanes.pending[lane] = 0;
+}
+
+// Runs a lane on the scalar path: one instruction when single_instruction is
+// set, after which the lane rejoins the vector unit if it can, otherwise
+// the rest of its budget. Returns the clocks spent.
+uint64_t LockstepEngine::StepScalar(size_t lane,
+                                    MachineState& machine,
+                                    const TimingEngine& timing,
+                                    uint64_t budget,
+                                    bool single_instruction) {
+  ++scalar_steps_;
+  Store(lane, machine, timing);
+  UntracedRunner runner(execution_, &functional_);
+  if (!single_instruction) {
+    return runner.Run(machine, timing, {BudgetUnit::Clocks, budget}).clocks;
+  }
+
+  uint64_t spent = 0;
+  do {
+    uint64_t slice = std::min<uint64_t>(budget - spent, kFullInstruction);
+    spent += runner.Run(machine, timing, {BudgetUnit::Clocks, slice}).clocks;
+  } while (spent < budget && !machine.mode.halted &&
+           !FunctionalEngine::AtInstructionBoundary(machine));
+  if (spent < budget && !machine.mode.halted &&
+      !ParInhibited(machine)) {
+    Load(lane, machine);
+  }
+  return spent;
+}
+
+}  // namespace ct10::core
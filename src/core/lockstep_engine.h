@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+
+#include "core/execution_engine.h"
+#include "core/functional_engine.h"
+#include "core/machine_state.h"
+#include "core/timing_engine.h"
+
+namespace ct10::core {
+
+// Runs many machines that share a program, such as one program swept over
+// every value of an input cell, kLanes at a time. Registers, flags and
+// memory are held structure-of-arrays and each instruction is applied to
+// every lane sitting on the same PAR and instruction bytes at once.
+//
+// Lanes whose instruction would halt or touches I/O take that instruction
+// through the scalar runner and rejoin; a lane left on its own after a
+// branch diverges finishes on the scalar path. Results match UntracedRunner
+// with a Clocks budget and default stop conditions for every machine.
+class LockstepEngine {
+ public:
+  static constexpr size_t kLanes = 32;
+
+  LockstepEngine();
+  ~LockstepEngine();
+
+  // Runs every machine for up to max_clocks, storing the clocks each spent
+  // in clocks (same size as machines).
+  void Run(std::span<MachineState> machines,
+           const TimingEngine& timing,
+           uint64_t max_clocks,
+           std::span<uint64_t> clocks);
+
+  // Instructions applied to a whole group of lanes at once.
+  uint64_t vector_instructions() const;
+  // Instructions, or remainders of a run, taken by single lanes.
+  uint64_t scalar_steps() const;
+
+ private:
+  struct Lanes;
+
+  void RunChunk(std::span<MachineState> machines,
+                const TimingEngine& timing,
+                uint64_t max_clocks,
+                std::span<uint64_t> clocks);
+  void Load(size_t lane, const MachineState& machine);
+  void Store(size_t lane, MachineState& machine, const TimingEngine& timing);
+  uint64_t StepScalar(size_t lane,
+                      MachineState& machine,
+                      const TimingEngine& timing,
+                      uint64_t budget,
+                      bool single_instruction);
+
+  UntracedExecutionEngine execution_;
+  FunctionalEngine functional_;
+  std::unique_ptr<Lanes> lanes_;
+  uint64_t vector_instructions_ = 0;
+  uint64_t scalar_steps_ = 0;
+};
+
+}  // namespace ct10::core
@@ -0,0 +1,60 @@
+#include "core/machine_fork.h"
+
+#include "core/functional_engine.h"
+#include "core/machine_ops.h"
+
+namespace ct10::core {
+namespace {
+
+constexpr uint8_t kTerminalDevice = 1;
+
+bool AtTerminalTransfer(const MachineState& state) {
+  return state.io.selected_device == kTerminalDevice &&
+         FunctionalEngine::AtInstructionBoundary(state) &&
+         IsIoMemoryOpcode(state.memory.Read(state.par.value()));
+}
+
+}  // namespace
+
+void MachineFork::Capture(const MachineState& state, uint64_t clocks) {
+  state_.core() = state.core();
+  state_.io = state.io;
+  state_.panel_input = state.panel_input;
+  state_.trace.set_capacity(0);
+  clocks_ = clocks;
+  captured_ = true;
+}
+
+void MachineFork::Spawn(MachineState& state) const {
+  state.core() = state_.core();
+  state.io = state_.io;
+  state.panel_input = state_.panel_input;
+  state.trace.Clear();
+}
+
+bool MachineFork::captured() const { return captured_; }
+
+uint64_t MachineFork::clocks() const { return clocks_; }
+
+const MachineState& MachineFork::state() const { return state_; }
+
+uint64_t RunUntilTerminalInput(const UntracedRunner& runner,
+                               MachineState& state,
+                               const TimingEngine& timing,
+                               uint64_t max_clocks) {
+  StopConditions stop;
+  for (uint16_t address = 0; address < Memory::kSize; ++address) {
+    stop.breakpoints.set(address, IsIoMemoryOpcode(state.memory.Read(address)));
+  }
+
+  uint64_t clocks = 0;
+  while (clocks < max_clocks && !state.mode.halted &&
+         !AtTerminalTransfer(state)) {
+    clocks += runner.Run(state, timing,
+                         {BudgetUnit::Clocks, max_clocks - clocks}, stop)
+                  .clocks;
+  }
+  return clocks;
+}
+
+}  // namespace ct10::core
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+
+#include "core/machine_state.h"
+#include "core/runner.h"
+#include "core/timing_engine.h"
+
+namespace ct10::core {
+
+// A machine captured mid-run so several continuations can start from it
+// instead of each re-running the shared prefix from reset. The captured
+// state, timing included, is immutable; Spawn hands out copies that run
+// independently, in parallel if need be. The trace is not carried over.
+class MachineFork {
+ public:
+  void Capture(const MachineState& state, uint64_t clocks);
+
+  // Overwrites state with the machine at the fork point, keeping its trace
+  // capacity. The copy reuses state's I/O storage, so spawning repeatedly
+  // into the same machine does not allocate.
+  void Spawn(MachineState& state) const;
+
+  bool captured() const;
+  // Clocks the prefix ran before the fork point.
+  uint64_t clocks() const;
+  const MachineState& state() const;
+
+ private:
+  MachineState state_;
+  uint64_t clocks_ = 0;
+  bool captured_ = false;
+};
+
+// Runs state until the instruction boundary before its first terminal
+// input transfer, the last point where runs that differ only in terminal
+// input are still identical, or until it halts or spends max_clocks.
+// Returns the clocks run. Check state.io.terminal_input_pos afterwards:
+// code that writes a new I/O instruction can slip past the stop.
+uint64_t RunUntilTerminalInput(const UntracedRunner& runner,
+                               MachineState& state,
+                               const TimingEngine& timing,
+                               uint64_t max_clocks);
+
+}  // namespace ct10::core
@@ -0,0 +1,267 @@
+#pragma once
+
+#include <cstdint>
+
+#include "core/machine_state.h"
+
+// Register-transfer semantics shared by the clock-level and instruction-level
+// engines. Each helper applies exactly what the corresponding micro-op does so
+// both engines stay bit-identical.
+
+namespace ct10::core {
+
+inline uint8_t ToByte(uint16_t value) {
+  return static_cast<uint8_t>(value & 0xFF);
+}
+
+inline uint16_t FormPageAddress(uint8_t opcode, uint8_t low) {
+  uint16_t page = static_cast<uint16_t>(opcode & 0x03);
+  return static_cast<uint16_t>((page << 8) | low);
+}
+
+inline uint8_t PageBitsFromAddress(uint16_t address) {
+  return static_cast<uint8_t>((address >> 8) & 0x03);
+}
+
+inline uint8_t EncodeBunOpcode(uint16_t address) {
+  return static_cast<uint8_t>(0x90 | PageBitsFromAddress(address));
+}
+
+inline bool IsIndexed(uint8_t opcode) {
+  return (opcode & 0x04u) != 0;
+}
+
+inline bool IsIoMemoryOpcode(uint8_t opcode) {
+  return opcode >= 0xD0 && opcode < 0xF8;
+}
+
+inline uint8_t BuildStatusByte(const MachineState& state) {
+  uint8_t status = 0;
+  if (state.status.interrupt) {
+    status |= 0x01;
+  }
+  if (state.status.sense) {
+    status |= 0x02;
+  }
+  if (state.status.flag) {
+    status |= 0x04;
+  }
+  return status;
+}
+
+inline void LatchPanelStatus(MachineState& state) {
+  switch (state.panel_input.io_mode) {
+    case 1:
+      state.io.hex_mode = true;
+      state.io.alpha_mode = false;
+      break;
+    case 2:
+      state.io.hex_mode = false;
+      state.io.alpha_mode = true;
+      break;
+    default:
+      state.io.hex_mode = false;
+      state.io.alpha_mode = false;
+      break;
+  }
+
+  state.status.sense = state.panel_input.sense;
+  state.status.interrupt = state.io.interrupt;
+  state.io.status = BuildStatusByte(state);
+}
+
+// RPT in the phase or instruction step modes holds PAR so the same
+// instruction repeats.
+inline bool ParInhibited(const MachineState& state) {
+  return state.panel_input.rpt &&
+         (state.panel_input.mode == 1 || state.panel_input.mode == 2);
+}
+
+inline void IncrementPar(MachineState& state) {
+  if (!ParInhibited(state)) {
+    state.par.Increment();
+  }
+}
+
+inline void UpdateFlags(MachineState& state, uint8_t value) {
+  state.flags.zero = value == 0;
+  state.flags.greater = (value & 0x80) == 0 && value != 0;
+  state.flags.less = (value & 0x80) != 0;
+}
+
+inline void UpdateFlagsWord(MachineState& state, uint16_t value) {
+  state.flags.zero = value == 0;
+  state.flags.greater = (value & 0x8000) == 0 && value != 0;
+  state.flags.less = (value & 0x8000) != 0;
+}
+
+inline uint8_t AluAdd(MachineState& state, uint8_t a, uint8_t b) {
+  uint16_t sum = static_cast<uint16_t>(a) + static_cast<uint16_t>(b);
+  uint8_t result = static_cast<uint8_t>(sum & 0xFF);
+  state.flags.carry = sum > 0xFF;
+  state.flags.add_overflow = ((a ^ result) & (b ^ result) & 0x80) != 0;
+  if (state.flags.add_overflow && !state.panel_input.error_add) {
+    state.mode.halted = true;
+  }
+  return result;
+}
+
+inline uint8_t AluSubtract(MachineState& state, uint8_t a, uint8_t b) {
+  int16_t diff = static_cast<int16_t>(a) - static_cast<int16_t>(b);
+  uint8_t result = static_cast<uint8_t>(diff & 0xFF);
+  state.flags.carry = diff >= 0;
+  state.flags.add_overflow = ((a ^ b) & (a ^ result) & 0x80) != 0;
+  if (state.flags.add_overflow && !state.panel_input.error_add) {
+    state.mode.halted = true;
+  }
+  return result;
+}
+
+inline void ShiftLeftArithmetic(MachineState& state, uint8_t count) {
+  uint16_t value = static_cast<uint16_t>((state.accumulator.value() << 8) |
+                                         ToByte(state.quotient.value()));
+  if (count >= 16) {
+    value = 0;
+  } else {
+    value = static_cast<uint16_t>(value << count);
+  }
+  state.accumulator.Load(static_cast<uint8_t>((value >> 8) & 0xFF));
+  state.quotient.Load(static_cast<uint8_t>(value & 0xFF));
+}
+
+inline void ShiftRightArithmetic(MachineState& state, uint8_t count) {
+  int16_t value = static_cast<int16_t>((state.accumulator.value() << 8) |
+                                       ToByte(state.quotient.value()));
+  if (count >= 16) {
+    value = (value < 0) ? static_cast<int16_t>(-1) : 0;
+  } else {
+    value = static_cast<int16_t>(value >> count);
+  }
+  state.accumulator.Load(static_cast<uint8_t>((value >> 8) & 0xFF));
+  state.quotient.Load(static_cast<uint8_t>(value & 0xFF));
+}
+
+inline void ShiftLeftLogical(MachineState& state, uint8_t count) {
+  uint8_t value = ToByte(state.accumulator.value());
+  value = count >= 8 ? 0 : static_cast<uint8_t>(value << count);
+  state.accumulator.Load(value);
+}
+
+inline void ShiftRightLogical(MachineState& state, uint8_t count) {
+  uint8_t value = ToByte(state.accumulator.value());
+  value = count >= 8 ? 0 : static_cast<uint8_t>(value >> count);
+  state.accumulator.Load(value);
+}
+
+inline void Multiply(MachineState& state, uint8_t operand) {
+  int16_t a = static_cast<int8_t>(ToByte(state.accumulator.value()));
+  int16_t b = static_cast<int8_t>(operand);
+  int16_t product = static_cast<int16_t>(a * b);
+  state.accumulator.Load(static_cast<uint8_t>((product >> 8) & 0xFF));
+  state.quotient.Load(static_cast<uint8_t>(product & 0xFF));
+}
+
+inline void Divide(MachineState& state, uint8_t operand) {
+  int16_t dividend = static_cast<int16_t>((state.accumulator.value() << 8) |
+                                          ToByte(state.quotient.value()));
+  int16_t divisor = static_cast<int8_t>(operand);
+  if (divisor == 0) {
+    state.flags.divide_overflow = true;
+    if (!state.panel_input.error_div) {
+      state.mode.halted = true;
+    }
+    return;
+  }
+  int16_t quotient = static_cast<int16_t>(dividend / divisor);
+  int16_t remainder = static_cast<int16_t>(dividend % divisor);
+  if (quotient < -128 || quotient > 127) {
+    state.flags.divide_overflow = true;
+    if (!state.panel_input.error_div) {
+      state.mode.halted = true;
+    }
+    return;
+  }
+  state.flags.divide_overflow = false;
+  state.quotient.Load(static_cast<uint8_t>(quotient & 0xFF));
+  state.accumulator.Load(static_cast<uint8_t>(remainder & 0xFF));
+}
+
+inline void ReplaceAddOne(MachineState& state, uint16_t address, uint8_t value) {
+  uint8_t result = static_cast<uint8_t>((value + 1u) & 0xFF);
+  state.memory.Write(address, result);
+  state.accumulator.Load(result);
+  state.flags.carry = value == 0xFF;
+}
+
+inline void ReplaceSubtractOne(MachineState& state,
+                               uint16_t address,
+                               uint8_t value) {
+  uint8_t result = static_cast<uint8_t>((value - 1) & 0xFF);
+  state.memory.Write(address, result);
+  state.accumulator.Load(result);
+  state.flags.carry = value == 0x00;
+}
+
+inline void CopyMemoryToNext(MachineState& state) {
+  uint16_t addr = state.mar.value();
+  uint8_t value = state.memory.Read(addr);
+  uint16_t next = static_cast<uint16_t>(addr + 1);
+  state.memory.Write(next, value);
+  state.mar.Load(next);
+}
+
+inline bool BranchTaken(const MachineState& state, uint8_t opcode) {
+  switch (opcode & 0xF8) {
+    case 0x90:
+    case 0x98:
+    case 0xA0:
+      return true;
+    case 0xA8:
+      return state.flags.greater;
+    case 0xB0:
+      return state.flags.zero;
+    case 0xB8:
+      return state.flags.less;
+    case 0xC0:
+      return !state.flags.carry;
+    case 0xC8:
+      return state.index.value() == 0;
+    default:
+      return false;
+  }
+}
+
+// BRANCH micro-op: BST halts, BSB plants a return BUN at the target and
+// continues at target + 2, the rest load PAR from MAR when taken.
+inline void Branch(MachineState& state, uint8_t opcode) {
+  uint8_t op = static_cast<uint8_t>(opcode & 0xF8);
+  bool take = BranchTaken(state, opcode);
+  if (op == 0x98) {
+    state.mode.halted = true;
+  }
+  if (op == 0xA0) {
+    uint16_t addr = state.mar.value();
+    state.memory.Write(addr, EncodeBunOpcode(state.par.value()));
+    state.memory.Write(static_cast<uint16_t>(addr + 1),
+                       static_cast<uint8_t>(state.par.value() & 0xFF));
+    state.par.Load(static_cast<uint16_t>(addr + 2));
+  } else if (take) {
+    state.par.Load(state.mar.value());
+  }
+}
+
+inline void SkipIf(MachineState& state, bool condition, uint8_t count) {
+  state.countdown.Load(count);
+  if (condition) {
+    state.par.Load(state.par.value() + static_cast<uint16_t>(2u * count));
+  }
+}
+
+inline void SelectDevice(MachineState& state, uint8_t command) {
+  state.io.last_command = command;
+  state.io.selected_device = static_cast<uint8_t>(command & 0x07);
+  state.io.hex_mode = (command & 0x08) != 0;
+  state.io.alpha_mode = (command & 0x10) != 0;
+}
+
+}  // namespace ct10::core
@@ -2,22 +2,7 @@
 
 namespace ct10::core {
 
-MachineState::MachineState()
-    : accumulator("A", 8),
-      buffer("B", 8),
-      quotient("Q", 8),
-      index("X", 8),
-      countdown("C", 8),
-      mar("MAR", 10),
-      par("PAR", 10),
-      opcode("OP", 8),
-      distributor("D", 4),
-      x_bus("X"),
-      y_bus("Y"),
-      z_bus("Z"),
-      f_bus("F") {
-  Reset();
-}
+MachineState::MachineState() { Reset(); }
 
 void MachineState::Reset() {
   accumulator.Clear();
@@ -41,7 +26,7 @@ void MachineState::Reset() {
   status = {};
   io = {};
   panel_input = {};
-  trace.clear();
+  trace.Clear();
 }
 
 void MachineState::ClearRegisters() {
@@ -64,23 +49,19 @@ void MachineState::ClearRegisters() {
   timing = {};
   mode = {};
   status = {};
-  trace.clear();
+  trace.Clear();
 }
 
 void MachineState::AddTrace(MicroOp op) {
-  TraceEntry entry;
-  entry.distributor = timing.distributor;
-  entry.phase = timing.phase;
-  entry.acquisition = timing.acquisition;
-  entry.op = op;
-  if (trace.size() >= kTraceCapacity) {
-    trace.erase(trace.begin());
-  }
-  trace.push_back(entry);
+  trace.Push(MakeTraceEntry(timing, op));
 }
 
 void MachineState::ClearTrace() {
-  trace.clear();
+  trace.Clear();
 }
 
+MachineCore& MachineState::core() { return *this; }
+
+const MachineCore& MachineState::core() const { return *this; }
+
 }  // namespace ct10::core
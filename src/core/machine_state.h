@@ -1,5 +1,6 @@
 #pragma once
 
+#include <type_traits>
 #include <vector>
 
 #include "core/bus.h"
@@ -8,6 +9,7 @@
 #include "core/panel_input.h"
 #include "core/register.h"
 #include "core/timing_engine.h"
+#include "core/trace_buffer.h"
 
 namespace ct10::core {
 
@@ -61,14 +63,37 @@ struct IOState {
   uint8_t wait_cycles = 0;
 };
 
-struct TraceEntry {
-  uint8_t distributor = 0;
-  ClockPhase phase = ClockPhase::CP1;
-  bool acquisition = true;
-  MicroOp op = MicroOp::PAR_TO_MAR;
+// Hot machine state the engines touch every clock. Trivially copyable, so a
+// snapshot or a second instance is a plain copy of about 1.1 KiB.
+struct MachineCore {
+  Register accumulator{RegisterId::Accumulator};
+  Register buffer{RegisterId::Buffer};
+  Register quotient{RegisterId::Quotient};
+  Register index{RegisterId::Index};
+  Register countdown{RegisterId::Countdown};
+  Register mar{RegisterId::Mar};
+  Register par{RegisterId::Par};
+  Register opcode{RegisterId::Opcode};
+  Register distributor{RegisterId::Distributor};
+
+  Bus x_bus{BusId::X};
+  Bus y_bus{BusId::Y};
+  Bus z_bus{BusId::Z};
+  Bus f_bus{BusId::F};
+
+  Flags flags;
+  TimingState timing;
+  ModeState mode;
+  StatusFlags status;
+  // Last, so RestoreState, which copies the fields above one by one and
+  // reloads memory in place, lists every other field.
+  Memory memory;
 };
 
-class MachineState {
+static_assert(std::is_trivially_copyable_v<MachineCore>);
+
+// MachineCore plus the I/O buffers, panel switches and micro-op trace.
+class MachineState : public MachineCore {
  public:
   MachineState();
 
@@ -77,31 +102,12 @@ class MachineState {
   void AddTrace(MicroOp op);
   void ClearTrace();
 
-  Register accumulator;
-  Register buffer;
-  Register quotient;
-  Register index;
-  Register countdown;
-  Register mar;
-  Register par;
-  Register opcode;
-  Register distributor;
-
-  Bus x_bus;
-  Bus y_bus;
-  Bus z_bus;
-  Bus f_bus;
+  MachineCore& core();
+  const MachineCore& core() const;
 
-  Memory memory;
-  Flags flags;
-  TimingState timing;
-  ModeState mode;
-  StatusFlags status;
   IOState io;
   PanelInput panel_input;
-  std::vector<TraceEntry> trace;
-
-  static constexpr size_t kTraceCapacity = 512;
+  TraceBuffer trace;
 };
 
 }  // namespace ct10::core
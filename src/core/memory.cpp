@@ -1,5 +1,7 @@
 #include "core/memory.h"
 
+#include <algorithm>
+
 namespace ct10::core {
 
 uint8_t Memory::Read(uint16_t address) const {
@@ -7,15 +9,54 @@ uint8_t Memory::Read(uint16_t address) const {
 }
 
 void Memory::Write(uint16_t address, uint8_t value) {
-  cells_[address & kAddressMask] = value;
+  address &= kAddressMask;
+  uint16_t page = address / kPageSize;
+  cells_[address] = value;
+  ++generations_[page];
+  if (address == watch_address_) {
+    ++watch_hits_;
+  }
 }
 
 void Memory::Clear() {
   cells_.fill(0);
+  for (uint64_t& generation : generations_) {
+    ++generation;
+  }
+}
+
+void Memory::Load(std::span<const uint8_t, kSize> cells) {
+  std::copy(cells.begin(), cells.end(), cells_.begin());
+  for (uint64_t& generation : generations_) {
+    ++generation;
+  }
+}
+
+void Memory::LoadPage(uint16_t page,
+                      std::span<const uint8_t, kPageSize> cells) {
+  page %= kPages;
+  std::copy(cells.begin(), cells.end(), cells_.begin() + page * kPageSize);
+  ++generations_[page];
 }
 
 const std::array<uint8_t, Memory::kSize>& Memory::cells() const {
   return cells_;
 }
 
+uint64_t Memory::generation(uint16_t page) const {
+  return generations_[page % kPages];
+}
+
+void Memory::Watch(uint16_t address) {
+  watch_address_ = address & kAddressMask;
+  watch_hits_ = 0;
+}
+
+void Memory::ClearWatch() {
+  watch_address_ = kNoWatch;
+  watch_hits_ = 0;
+}
+
+uint64_t Memory::watch_hits() const { return watch_hits_; }
+
 }  // namespace ct10::core
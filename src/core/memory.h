@@ -2,22 +2,50 @@
 
 #include <array>
 #include <cstdint>
+#include <span>
 
 namespace ct10::core {
 
+// Core memory, tracked in 256-byte pages. Every write bumps the page's
+// generation, so any number of observers (checkpoint writers) can tell
+// whether a page changed since they last looked.
 class Memory {
  public:
   static constexpr uint16_t kSize = 1024;
   static constexpr uint16_t kAddressMask = kSize - 1;
+  static constexpr uint16_t kPageSize = 256;
+  static constexpr uint16_t kPages = kSize / kPageSize;
+  static constexpr uint8_t kAllPages = (1u << kPages) - 1;
+
+  static constexpr uint16_t PageOf(uint16_t address) {
+    return (address & kAddressMask) / kPageSize;
+  }
 
   uint8_t Read(uint16_t address) const;
   void Write(uint16_t address, uint8_t value);
   void Clear();
+  // Replaces every cell at once; like Clear, every page counts as written.
+  void Load(std::span<const uint8_t, kSize> cells);
+  // Restores one page, as Load does for the whole memory.
+  void LoadPage(uint16_t page, std::span<const uint8_t, kPageSize> cells);
 
   const std::array<uint8_t, kSize>& cells() const;
 
+  uint64_t generation(uint16_t page) const;
+
+  // Counts writes to one address, for debuggers looking for the write that
+  // changed a cell. Watching replaces the previous watch.
+  void Watch(uint16_t address);
+  void ClearWatch();
+  uint64_t watch_hits() const;
+
  private:
+  static constexpr uint16_t kNoWatch = kSize;
+
   std::array<uint8_t, kSize> cells_{};
+  std::array<uint64_t, kPages> generations_{};
+  uint64_t watch_hits_ = 0;
+  uint16_t watch_address_ = kNoWatch;
 };
 
 }  // namespace ct10::core
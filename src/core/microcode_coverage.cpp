@@ -0,0 +1,229 @@
+#include "core/microcode_coverage.h"
+
+#include <bit>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+#include "core/instruction_set.h"
+
+namespace ct10::core {
+namespace {
+
+constexpr char kCoverageHeader[] = "# CT-10 microcode coverage";
+constexpr uint32_t kSlotsPerHalf = MicrocodeDispatch::kSlotsPerOpcode;
+constexpr uint8_t kPhases = MicrocodeDispatch::kPhases;
+
+bool Fail(std::string* error, const char* message) {
+  if (error) {
+    *error = message;
+  }
+  return false;
+}
+
+std::span<const MicroOp> RowSlot(bool acquisition,
+                                 uint8_t opcode,
+                                 uint32_t slot) {
+  return kMicrocodeDispatch.Slot(
+      acquisition, opcode, static_cast<uint8_t>(slot / kPhases),
+      static_cast<ClockPhase>(slot % kPhases + 1));
+}
+
+// One character per slot: every micro-op fired, some, none, or the slot has
+// no micro-ops.
+char SlotMark(const MicrocodeCoverage& coverage,
+              std::span<const MicroOp> slot) {
+  if (slot.empty()) {
+    return '.';
+  }
+  size_t entry = kMicrocodeDispatch.Entry(slot);
+  size_t fired = 0;
+  for (size_t i = 0; i < slot.size(); ++i) {
+    fired += coverage.fired(entry + i) ? 1 : 0;
+  }
+  return fired == slot.size() ? '#' : fired > 0 ? '+' : '-';
+}
+
+void WriteRow(std::ostream& out,
+              const MicrocodeCoverage& coverage,
+              std::string_view label,
+              bool acquisition,
+              uint8_t opcode) {
+  std::string line(label);
+  line.resize(8, ' ');
+  for (uint32_t slot = 0; slot < kSlotsPerHalf; ++slot) {
+    if (slot > 0 && slot % kPhases == 0) {
+      line += ' ';
+    }
+    line += SlotMark(coverage, RowSlot(acquisition, opcode, slot));
+  }
+  out << line << '\n';
+}
+
+}  // namespace
+
+void MicrocodeCoverage::Clear() { words_.fill(0); }
+
+void MicrocodeCoverage::MarkInstruction(uint8_t opcode, uint32_t clocks) {
+  for (uint32_t slot = 0; slot < clocks && slot < 2 * kSlotsPerHalf; ++slot) {
+    Mark(RowSlot(slot < kSlotsPerHalf, opcode, slot % kSlotsPerHalf));
+  }
+}
+
+void MicrocodeCoverage::MarkEntry(size_t entry) {
+  if (entry < kEntries) {
+    words_[entry / 64] |= uint64_t{1} << (entry % 64);
+  }
+}
+
+void MicrocodeCoverage::Merge(const MicrocodeCoverage& other) {
+  for (size_t i = 0; i < words_.size(); ++i) {
+    words_[i] |= other.words_[i];
+  }
+}
+
+bool MicrocodeCoverage::fired(size_t entry) const {
+  return entry < kEntries && (words_[entry / 64] >> (entry % 64)) & 1;
+}
+
+size_t MicrocodeCoverage::fired_count() const {
+  size_t count = 0;
+  for (uint64_t word : words_) {
+    count += static_cast<size_t>(std::popcount(word));
+  }
+  return count;
+}
+
+std::vector<MicrocodeEntry> MicrocodeEntries() {
+  std::vector<MicrocodeEntry> entries;
+  entries.reserve(MicrocodeCoverage::kEntries);
+  auto add_row = [&](std::string_view row, bool acquisition, uint8_t opcode) {
+    for (uint32_t slot = 0; slot < kSlotsPerHalf; ++slot) {
+      std::span<const MicroOp> ops = RowSlot(acquisition, opcode, slot);
+      for (size_t i = 0; i < ops.size(); ++i) {
+        MicrocodeEntry entry;
+        entry.index = kMicrocodeDispatch.Entry(ops) + i;
+        entry.row = row;
+        entry.acquisition = acquisition;
+        entry.opcode = opcode;
+        entry.distributor = static_cast<uint8_t>(slot / kPhases);
+        entry.phase = static_cast<ClockPhase>(slot % kPhases + 1);
+        entry.position = static_cast<uint8_t>(i);
+        entry.op = ops[i];
+        entries.push_back(entry);
+      }
+    }
+  };
+  add_row("ACQ", true, 0);
+  for (const InstructionSpec& spec : kInstructionSet) {
+    add_row(spec.mnemonic, false, spec.opcode);
+  }
+  return entries;
+}
+
+bool SaveMicrocodeCoverage(const MicrocodeCoverage& coverage,
+                           const std::string& path,
+                           std::string* error) {
+  std::ofstream out(path);
+  if (!out) {
+    return Fail(error, "Unable to open microcode coverage file for writing.");
+  }
+  out << kCoverageHeader << ": " << coverage.fired_count() << " of "
+      << MicrocodeCoverage::kEntries << " micro-ops fired\n"
+      << "# Columns are D0-D15, three phases each. # every micro-op fired, "
+         "+ some, - none,\n"
+      << "# . no micro-op. MISS lines list the micro-ops never fired.\n";
+
+  std::string columns = "#       ";
+  for (uint32_t d = 0; d < MicrocodeDispatch::kDistributorCounts; ++d) {
+    std::string label = "D" + std::to_string(d);
+    label.resize(kPhases + 1, ' ');
+    columns += label;
+  }
+  columns.resize(columns.find_last_not_of(' ') + 1);
+  out << columns << '\n';
+  WriteRow(out, coverage, "ACQ", true, 0);
+  for (const InstructionSpec& spec : kInstructionSet) {
+    char label[16];
+    std::snprintf(label, sizeof(label), "%.*s %02X",
+                  static_cast<int>(spec.mnemonic.size()),
+                  spec.mnemonic.data(), static_cast<unsigned>(spec.opcode));
+    WriteRow(out, coverage, label, false, spec.opcode);
+  }
+
+  for (const MicrocodeEntry& entry : MicrocodeEntries()) {
+    if (coverage.fired(entry.index)) {
+      continue;
+    }
+    out << "MISS " << entry.row << " D" << static_cast<int>(entry.distributor)
+        << " CP" << static_cast<int>(entry.phase) << ' '
+        << static_cast<int>(entry.position) << ' ' << MicroOpName(entry.op)
+        << '\n';
+  }
+  if (!out) {
+    return Fail(error, "Failed to write microcode coverage file.");
+  }
+  return true;
+}
+
+bool LoadMicrocodeCoverage(MicrocodeCoverage& coverage,
+                           const std::string& path,
+                           std::string* error) {
+  std::ifstream in(path);
+  if (!in) {
+    return Fail(error, "Unable to open microcode coverage file for reading.");
+  }
+  std::string line;
+  if (!std::getline(in, line) || line.rfind(kCoverageHeader, 0) != 0) {
+    return Fail(error, "Invalid microcode coverage file header.");
+  }
+  // A file written against another microcode table cannot be mapped back.
+  std::string total =
+      " of " + std::to_string(MicrocodeCoverage::kEntries) + " micro-ops";
+  if (line.find(total) == std::string::npos) {
+    return Fail(error, "Microcode coverage file is for a different table.");
+  }
+
+  std::vector<MicrocodeEntry> entries = MicrocodeEntries();
+  std::vector<bool> missed(MicrocodeCoverage::kEntries, false);
+  while (std::getline(in, line)) {
+    std::istringstream fields(line);
+    std::string kind;
+    if (!(fields >> kind) || kind != "MISS") {
+      continue;
+    }
+    std::string row;
+    std::string distributor;
+    std::string phase;
+    int position = -1;
+    std::string op;
+    if (!(fields >> row >> distributor >> phase >> position >> op)) {
+      return Fail(error, "Invalid microcode coverage MISS line.");
+    }
+    bool found = false;
+    for (const MicrocodeEntry& entry : entries) {
+      if (entry.row == row &&
+          distributor == "D" + std::to_string(entry.distributor) &&
+          phase == "CP" + std::to_string(static_cast<int>(entry.phase)) &&
+          position == entry.position && op == MicroOpName(entry.op)) {
+        missed[entry.index] = true;
+        found = true;
+        break;
+      }
+    }
+    if (!found) {
+      return Fail(error, "Microcode coverage file names an unknown micro-op.");
+    }
+  }
+
+  MicrocodeCoverage loaded;
+  for (size_t entry = 0; entry < MicrocodeCoverage::kEntries; ++entry) {
+    if (!missed[entry]) {
+      loaded.MarkEntry(entry);
+    }
+  }
+  coverage.Merge(loaded);
+  return true;
+}
+
+}  // namespace ct10::core
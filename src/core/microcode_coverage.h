@@ -0,0 +1,80 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "core/microcode.h"
+#include "core/microcode_table.h"
+#include "core/timing_engine.h"
+
+namespace ct10::core {
+
+// Which micro-ops of the microcode table have fired, one bit per entry of
+// MicrocodeDispatch's flattened table, so every (acquisition or instruction,
+// distributor, phase, micro-op) has its own bit. Coverage from separate runs
+// combines with Merge.
+class MicrocodeCoverage {
+ public:
+  static constexpr size_t kEntries = MicrocodeStepCount();
+
+  void Clear();
+
+  // A slot the clock-level engine has just run.
+  void Mark(std::span<const MicroOp> slot) {
+    if (slot.empty()) {
+      return;
+    }
+    size_t entry = kMicrocodeDispatch.Entry(slot);
+    for (size_t end = entry + slot.size(); entry < end; ++entry) {
+      words_[entry / 64] |= uint64_t{1} << (entry % 64);
+    }
+  }
+  // The slots of an instruction's first clocks clocks, acquisition included,
+  // for engines that run whole instructions.
+  void MarkInstruction(uint8_t opcode, uint32_t clocks);
+  // Adds a single entry, as read from a file.
+  void MarkEntry(size_t entry);
+
+  void Merge(const MicrocodeCoverage& other);
+
+  bool fired(size_t entry) const;
+  size_t fired_count() const;
+
+ private:
+  std::array<uint64_t, (kEntries + 63) / 64> words_{};
+};
+
+// One micro-op of the table, in table order. Acquisition is shared by every
+// instruction, so it is reported once as its own row.
+struct MicrocodeEntry {
+  size_t index = 0;
+  std::string_view row;
+  bool acquisition = false;
+  uint8_t opcode = 0;
+  uint8_t distributor = 0;
+  ClockPhase phase = ClockPhase::CP1;
+  // Position among the micro-ops of the same slot.
+  uint8_t position = 0;
+  MicroOp op = MicroOp::PAR_TO_MAR;
+};
+
+std::vector<MicrocodeEntry> MicrocodeEntries();
+
+// A microcode coverage file is a text report that can be read back for
+// merging: a summary comment, a matrix with a row per instruction and a
+// column per distributor count and phase, then a MISS line for every
+// micro-op that never fired.
+bool SaveMicrocodeCoverage(const MicrocodeCoverage& coverage,
+                           const std::string& path,
+                           std::string* error);
+// Merges the file into coverage.
+bool LoadMicrocodeCoverage(MicrocodeCoverage& coverage,
+                           const std::string& path,
+                           std::string* error);
+
+}  // namespace ct10::core
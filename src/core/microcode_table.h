@@ -1,16 +1,176 @@
 #pragma once
 
+#include <array>
 #include <cstdint>
-#include <vector>
+#include <span>
 
+#include "core/instruction_set.h"
 #include "core/microcode.h"
 
 namespace ct10::core {
 
 class MicrocodeTable {
  public:
-  static const std::vector<MicroOpStep>& Acquisition();
-  static const std::vector<MicroOpStep>& Execution(uint8_t opcode);
+  static constexpr std::span<const MicroOpStep> Acquisition() {
+    return kAcquisitionSequence.view();
+  }
+
+  static constexpr std::span<const MicroOpStep> Execution(uint8_t opcode) {
+    const InstructionSpec* spec = FindInstruction(opcode);
+    return spec ? spec->execution.view() : std::span<const MicroOpStep>{};
+  }
 };
 
+// Micro-ops stored when acquisition and every instruction are flattened.
+constexpr size_t MicrocodeStepCount() {
+  size_t total = kAcquisitionSequence.count;
+  for (const InstructionSpec& spec : kInstructionSet) {
+    total += spec.execution.count;
+  }
+  return total;
+}
+
+// Flattened view of MicrocodeTable indexed by (acquisition, opcode,
+// distributor, phase). Each slot is a contiguous run of micro-ops kept in
+// table order, so a clock step is a single indexed lookup. The whole table is
+// built at compile time.
+class MicrocodeDispatch {
+ public:
+  static constexpr size_t kOpcodes = 256;
+  static constexpr size_t kDistributorCounts = 16;
+  static constexpr size_t kPhases = 3;
+  static constexpr size_t kSlotsPerOpcode = kDistributorCounts * kPhases;
+
+  static const MicrocodeDispatch& Instance();
+
+  constexpr MicrocodeDispatch() {
+    FlattenRow(kAcquisitionRow, MicrocodeTable::Acquisition(), false);
+    for (size_t i = 0; i < kInstructionSet.size(); ++i) {
+      FlattenRow(i, kInstructionSet[i].execution.view(), true);
+    }
+    for (size_t opcode = 0; opcode < kOpcodes; ++opcode) {
+      uint8_t index = kInstructionIndex[opcode];
+      execution_row_[opcode] =
+          index == kNoInstruction ? static_cast<uint8_t>(kEmptyRow) : index;
+    }
+  }
+
+  constexpr std::span<const MicroOp> Slot(bool acquisition,
+                                          uint8_t opcode,
+                                          uint8_t distributor,
+                                          ClockPhase phase) const {
+    const SlotRange* range = Find(acquisition, opcode, distributor, phase);
+    if (!range) {
+      return {};
+    }
+    return {ops_.data() + range->begin, range->count};
+  }
+
+  // Where a slot returned by Slot starts in the flattened table, which holds
+  // every micro-op of acquisition and of each instruction exactly once.
+  constexpr size_t Entry(std::span<const MicroOp> slot) const {
+    return static_cast<size_t>(slot.data() - ops_.data());
+  }
+
+  constexpr bool HasExecution(uint8_t opcode) const {
+    return execution_row_[opcode] != kEmptyRow;
+  }
+
+  // Micro-ops an instruction with this opcode runs in its first clocks
+  // clocks, acquisition included; a whole instruction is two rows of slots.
+  constexpr uint32_t MicroOps(uint8_t opcode,
+                              uint32_t clocks = 2 * kSlotsPerOpcode) const {
+    if (clocks >= 2 * kSlotsPerOpcode) {
+      return row_ops_[kAcquisitionRow] + row_ops_[execution_row_[opcode]];
+    }
+    uint32_t ops = 0;
+    for (uint32_t slot = 0; slot < clocks; ++slot) {
+      size_t row = slot < kSlotsPerOpcode ? kAcquisitionRow
+                                          : execution_row_[opcode];
+      ops += rows_[row][slot % kSlotsPerOpcode].count;
+    }
+    return ops;
+  }
+
+  // Number of consecutive slots, starting at this one, that schedule no
+  // micro-op before the acquisition/execution boundary. Execution D0 CP1 and
+  // undefined opcodes are never idle because Step acts on them regardless.
+  constexpr uint8_t IdleRun(bool acquisition,
+                            uint8_t opcode,
+                            uint8_t distributor,
+                            ClockPhase phase) const {
+    const SlotRange* range = Find(acquisition, opcode, distributor, phase);
+    return range ? range->idle_run : 0;
+  }
+
+ private:
+  struct SlotRange {
+    uint16_t begin = 0;
+    uint8_t count = 0;
+    uint8_t idle_run = 0;
+  };
+  using SlotRow = std::array<SlotRange, kSlotsPerOpcode>;
+
+  // One row per instruction, then acquisition, then the all-empty row that
+  // undefined opcodes execute.
+  static constexpr size_t kAcquisitionRow = kInstructionSet.size();
+  static constexpr size_t kEmptyRow = kAcquisitionRow + 1;
+  static constexpr size_t kRows = kEmptyRow + 1;
+
+  constexpr void FlattenRow(size_t row,
+                            std::span<const MicroOpStep> steps,
+                            bool execution) {
+    SlotRow& ranges = rows_[row];
+    size_t row_begin = op_count_;
+    for (uint8_t d = 0; d < kDistributorCounts; ++d) {
+      for (uint8_t p = 1; p <= kPhases; ++p) {
+        SlotRange& range = ranges[d * kPhases + (p - 1)];
+        range.begin = static_cast<uint16_t>(op_count_);
+        for (const MicroOpStep& step : steps) {
+          if (step.distributor == d &&
+              step.phase == static_cast<ClockPhase>(p)) {
+            ops_[op_count_++] = step.op;
+            ++range.count;
+          }
+        }
+      }
+    }
+    row_ops_[row] = static_cast<uint16_t>(op_count_ - row_begin);
+    uint8_t idle_run = 0;
+    for (size_t slot = kSlotsPerOpcode; slot-- > 0;) {
+      idle_run = ranges[slot].count == 0 ? static_cast<uint8_t>(idle_run + 1)
+                                         : 0;
+      ranges[slot].idle_run = idle_run;
+    }
+    if (execution) {
+      ranges[0].idle_run = 0;
+    }
+  }
+
+  constexpr const SlotRange* Find(bool acquisition,
+                                  uint8_t opcode,
+                                  uint8_t distributor,
+                                  ClockPhase phase) const {
+    uint8_t phase_index = static_cast<uint8_t>(phase);
+    if (distributor >= kDistributorCounts || phase_index < 1 ||
+        phase_index > kPhases) {
+      return nullptr;
+    }
+    size_t row = acquisition ? kAcquisitionRow : execution_row_[opcode];
+    return &rows_[row][distributor * kPhases + (phase_index - 1)];
+  }
+
+  std::array<MicroOp, MicrocodeStepCount()> ops_{};
+  size_t op_count_ = 0;
+  std::array<SlotRow, kRows> rows_{};
+  std::array<uint16_t, kRows> row_ops_{};
+  std::array<uint8_t, kOpcodes> execution_row_{};
+};
+
+inline constexpr MicrocodeDispatch kMicrocodeDispatch;
+
+inline const MicrocodeDispatch& MicrocodeDispatch::Instance() {
+  return kMicrocodeDispatch;
+}
+
 }  // namespace ct10::core
@@ -0,0 +1,46 @@
+#include "core/profile.h"
+
+#include "core/instruction_set.h"
+
+namespace ct10::core {
+
+void Profile::Clear() { *this = Profile(); }
+
+const ProfileCounts& Profile::address(uint16_t address) const {
+  return addresses_[address & Memory::kAddressMask];
+}
+
+const ProfileCounts& Profile::opcode(uint8_t opcode) const {
+  return opcodes_[opcode];
+}
+
+const ProfileCounts& Profile::total() const { return total_; }
+
+const CallGraph& Profile::calls() const { return calls_; }
+
+std::vector<ProfileMnemonic> ProfileByMnemonic(const Profile& profile) {
+  std::array<ProfileCounts, kInstructionSet.size() + 1> sums{};
+  for (size_t opcode = 0; opcode < Profile::kOpcodes; ++opcode) {
+    const ProfileCounts& counts =
+        profile.opcode(static_cast<uint8_t>(opcode));
+    uint8_t index = kInstructionIndex[opcode];
+    ProfileCounts& sum =
+        sums[index == kNoInstruction ? kInstructionSet.size() : index];
+    sum.instructions += counts.instructions;
+    sum.clocks += counts.clocks;
+    sum.wait_clocks += counts.wait_clocks;
+  }
+
+  std::vector<ProfileMnemonic> rows;
+  for (size_t i = 0; i < sums.size(); ++i) {
+    if (sums[i].instructions == 0 && sums[i].clocks == 0) {
+      continue;
+    }
+    rows.push_back({i < kInstructionSet.size() ? kInstructionSet[i].mnemonic
+                                               : std::string_view("???"),
+                    sums[i]});
+  }
+  return rows;
+}
+
+}  // namespace ct10::core
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "core/call_graph.h"
+#include "core/memory.h"
+
+namespace ct10::core {
+
+struct ProfileCounts {
+  uint64_t instructions = 0;
+  uint64_t clocks = 0;
+  // Clocks spent with an I/O transfer in progress.
+  uint64_t wait_clocks = 0;
+};
+
+// Instruction and clock counts per PAR address and per opcode byte, kept in
+// flat arrays. An instruction is counted when it starts, with the opcode
+// BUFFER_TO_OPCODE latches, and every clock until the next one starts is
+// charged to it. Clocks run before the first instruction only reach total().
+// The same starts and clocks feed a CallGraph of the BSB subroutines.
+class Profile {
+ public:
+  static constexpr size_t kOpcodes = 256;
+
+  void Clear();
+
+  void Begin(uint16_t address, uint8_t opcode) {
+    address_ = address & Memory::kAddressMask;
+    opcode_ = opcode;
+    started_ = true;
+    ++addresses_[address_].instructions;
+    ++opcodes_[opcode_].instructions;
+    ++total_.instructions;
+    calls_.Begin(address_, opcode_);
+  }
+
+  void AddClocks(uint64_t clocks, uint64_t wait_clocks) {
+    total_.clocks += clocks;
+    total_.wait_clocks += wait_clocks;
+    calls_.AddClocks(clocks);
+    if (started_) {
+      addresses_[address_].clocks += clocks;
+      addresses_[address_].wait_clocks += wait_clocks;
+      opcodes_[opcode_].clocks += clocks;
+      opcodes_[opcode_].wait_clocks += wait_clocks;
+    }
+  }
+
+  // A whole instruction.
+  void Record(uint16_t address,
+              uint8_t opcode,
+              uint64_t clocks,
+              uint64_t wait_clocks = 0) {
+    Begin(address, opcode);
+    AddClocks(clocks, wait_clocks);
+  }
+
+  const ProfileCounts& address(uint16_t address) const;
+  const ProfileCounts& opcode(uint8_t opcode) const;
+  const ProfileCounts& total() const;
+  const CallGraph& calls() const;
+
+ private:
+  std::array<ProfileCounts, Memory::kSize> addresses_{};
+  std::array<ProfileCounts, kOpcodes> opcodes_{};
+  ProfileCounts total_;
+  CallGraph calls_;
+  uint16_t address_ = 0;
+  uint8_t opcode_ = 0;
+  bool started_ = false;
+};
+
+struct ProfileMnemonic {
+  std::string_view mnemonic;
+  ProfileCounts counts;
+};
+
+// The opcode counts summed per instruction, so every page and index form of
+// LDA lands in one row, in instruction set order; undefined opcodes share a
+// "???" row at the end. Instructions never run are left out.
+std::vector<ProfileMnemonic> ProfileByMnemonic(const Profile& profile);
+
+}  // namespace ct10::core
@@ -1,15 +1,50 @@
 #pragma once
 
+#include <array>
+#include <cstddef>
 #include <cstdint>
-#include <string>
 
 namespace ct10::core {
 
+enum class RegisterId : uint8_t {
+  Accumulator,
+  Buffer,
+  Quotient,
+  Index,
+  Countdown,
+  Mar,
+  Par,
+  Opcode,
+  Distributor,
+};
+
+struct RegisterDescriptor {
+  const char* name = "";
+  uint8_t width = 0;
+  uint16_t mask = 0;
+};
+
+inline constexpr std::array<RegisterDescriptor, 9> kRegisterDescriptors = {{
+    {"A", 8, 0x00FF},
+    {"B", 8, 0x00FF},
+    {"Q", 8, 0x00FF},
+    {"X", 8, 0x00FF},
+    {"C", 8, 0x00FF},
+    {"MAR", 10, 0x03FF},
+    {"PAR", 10, 0x03FF},
+    {"OP", 8, 0x00FF},
+    {"D", 4, 0x000F},
+}};
+
+// Register value tagged with its descriptor. Names, widths and masks live in
+// kRegisterDescriptors so the machine state stays trivially copyable.
 class Register {
  public:
-  Register(std::string name, uint8_t width);
+  constexpr explicit Register(RegisterId id) : id_(id) {}
 
-  const std::string& name() const;
+  RegisterId id() const;
+  const RegisterDescriptor& descriptor() const;
+  const char* name() const;
   uint8_t width() const;
   uint16_t value() const;
 
@@ -19,12 +54,10 @@ class Register {
   void Decrement();
 
  private:
-  static uint16_t MaskForWidth(uint8_t width);
+  uint16_t mask() const;
 
-  std::string name_;
-  uint8_t width_ = 0;
-  uint16_t mask_ = 0;
   uint16_t value_ = 0;
+  RegisterId id_;
 };
 
 }  // namespace ct10::core
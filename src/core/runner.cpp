@@ -0,0 +1,146 @@
+#include "core/runner.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "core/machine_ops.h"
+
+namespace ct10::core {
+namespace {
+
+constexpr uint32_t kPhases = 3;
+constexpr uint32_t kClocksPerHalf = 16 * kPhases;
+constexpr uint32_t kClocksPerInstruction = 2 * kClocksPerHalf;
+
+uint64_t ClockLimit(const RunBudget& budget, uint32_t position) {
+  switch (budget.unit) {
+    case BudgetUnit::Clocks:
+      return budget.count;
+    case BudgetUnit::DistributorCounts:
+      if (budget.count == 0) {
+        return 0;
+      }
+      return budget.count * kPhases - position % kPhases;
+    case BudgetUnit::Instructions:
+      if (budget.count == 0) {
+        return 0;
+      }
+      return budget.count * kClocksPerInstruction - position;
+  }
+  return 0;
+}
+
+}  // namespace
+
+uint32_t InstructionPosition(const TimingState& timing) {
+  uint32_t position = timing.distributor * kPhases +
+                      (static_cast<uint32_t>(timing.phase) - 1);
+  return timing.acquisition ? position : kClocksPerHalf + position;
+}
+
+uint64_t BudgetClocks(const RunBudget& budget, const TimingState& timing) {
+  return ClockLimit(budget, InstructionPosition(timing));
+}
+
+template <typename Engine>
+BasicRunner<Engine>::BasicRunner(const Engine& execution,
+                                 FunctionalEngine* functional,
+                                 InstructionProbes probes)
+    : execution_(execution), functional_(functional), probes_(probes) {}
+
+template <typename Engine>
+RunResult BasicRunner<Engine>::Run(MachineState& state,
+                                   const TimingEngine& timing,
+                                   const RunBudget& budget,
+                                   const StopConditions& stop) const {
+  RunResult result;
+  uint32_t start = InstructionPosition(state.timing);
+  uint64_t limit = ClockLimit(budget, start);
+  bool check_breakpoints = stop.breakpoints.any();
+  bool was_halted = state.mode.halted;
+  state.mode.halted = false;
+
+  while (result.clocks < limit) {
+    if (!stop.halt) {
+      state.mode.halted = false;
+    }
+    uint32_t max_clocks = static_cast<uint32_t>(
+        std::min<uint64_t>(limit - result.clocks,
+                           std::numeric_limits<uint32_t>::max()));
+    uint32_t clocks = StepFunctional(state, timing, stop, max_clocks, result);
+    if (clocks == 0) {
+      if (probes_.any() && FunctionalEngine::AtInstructionBoundary(state)) {
+        probes_.Begin(state.par.value(), state.memory.Read(state.par.value()));
+      }
+      result.micro_ops += execution_.Step(state);
+      bool wait = state.status.wait;
+      if (wait) {
+        ++result.wait_clocks;
+      }
+      timing.Advance(state.timing);
+      clocks = 1 + execution_.FastForward(state, timing, max_clocks - 1);
+      probes_.AddClocks(clocks, wait ? 1 : 0);
+    }
+    result.clocks += clocks;
+
+    if (stop.io_wait && state.status.wait) {
+      result.reason = StopReason::IoWait;
+      break;
+    }
+    if (state.mode.halted && stop.halt) {
+      result.reason = StopReason::Halted;
+      break;
+    }
+    if (check_breakpoints &&
+        FunctionalEngine::AtInstructionBoundary(state) &&
+        stop.breakpoints.test(state.par.value() & Memory::kAddressMask)) {
+      result.reason = StopReason::Breakpoint;
+      break;
+    }
+  }
+
+  // A run that never reached the next instruction is still on the halt.
+  uint64_t end = start + result.clocks;
+  if (!state.mode.halted && end < kClocksPerInstruction) {
+    state.mode.halted = was_halted;
+  }
+  result.distributor_counts = end / kPhases - start / kPhases;
+  result.instructions = (end + kClocksPerInstruction - 1) /
+                            kClocksPerInstruction -
+                        (start + kClocksPerInstruction - 1) /
+                            kClocksPerInstruction;
+  return result;
+}
+
+template <typename Engine>
+uint32_t BasicRunner<Engine>::StepFunctional(MachineState& state,
+                                             const TimingEngine& timing,
+                                             const StopConditions& stop,
+                                             uint32_t max_clocks,
+                                             RunResult& result) const {
+  if (!functional_) {
+    return 0;
+  }
+  // Block I/O runs inside the functional engine until the transfer ends, so
+  // those instructions go clock by clock when the caller watches for waits.
+  if (stop.io_wait &&
+      IsIoMemoryOpcode(state.memory.Read(state.par.value()))) {
+    return 0;
+  }
+  uint64_t micro_ops = functional_->micro_ops();
+  uint64_t wait_clocks = functional_->wait_clocks();
+  uint32_t clocks =
+      stop.breakpoints.any()
+          ? functional_->ExecuteInstruction(state, timing, max_clocks,
+                                            probes_)
+          : functional_->ExecuteBlock(state, timing, max_clocks, probes_);
+  result.micro_ops += functional_->micro_ops() - micro_ops;
+  result.wait_clocks += functional_->wait_clocks() - wait_clocks;
+  return clocks;
+}
+
+template class BasicRunner<ExecutionEngine>;
+template class BasicRunner<UntracedExecutionEngine>;
+template class BasicRunner<StreamingExecutionEngine>;
+
+}  // namespace ct10::core
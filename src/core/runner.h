@@ -0,0 +1,105 @@
+#pragma once
+
+#include <bitset>
+#include <cstdint>
+
+#include "core/execution_engine.h"
+#include "core/functional_engine.h"
+#include "core/machine_state.h"
+#include "core/memory.h"
+#include "core/instruction_probes.h"
+#include "core/timing_engine.h"
+
+namespace ct10::core {
+
+enum class BudgetUnit : uint8_t {
+  Clocks,
+  DistributorCounts,
+  Instructions,
+};
+
+// Distributor counts and instructions are counted as boundaries reached, so a
+// budget of one from mid-instruction runs to the next instruction boundary.
+struct RunBudget {
+  BudgetUnit unit = BudgetUnit::Clocks;
+  uint64_t count = 0;
+};
+
+// Clocks already spent in the current instruction, counting acquisition D0
+// CP1 as zero.
+uint32_t InstructionPosition(const TimingState& timing);
+
+// Clocks the budget allows from the given position; a run may stop sooner.
+uint64_t BudgetClocks(const RunBudget& budget, const TimingState& timing);
+
+struct StopConditions {
+  // When false the run steps through halts the way the panel step switches
+  // do, and the halt is only reported through state.mode.halted.
+  bool halt = true;
+  // Stop on the first clock that leaves an I/O transfer waiting.
+  bool io_wait = false;
+  // PAR addresses that stop the run when reached at an instruction boundary.
+  // The boundary the run starts on is never checked.
+  std::bitset<Memory::kSize> breakpoints;
+};
+
+enum class StopReason : uint8_t {
+  Halted,
+  BudgetExhausted,
+  IoWait,
+  Breakpoint,
+};
+
+struct RunResult {
+  StopReason reason = StopReason::BudgetExhausted;
+  uint64_t clocks = 0;
+  uint64_t distributor_counts = 0;
+  // Instructions started during the run, as the profiler counts them, so the
+  // one a run halts in is included.
+  uint64_t instructions = 0;
+  // Counted by the engines as they go, whichever of them ran each clock.
+  uint64_t micro_ops = 0;
+  // Clocks spent with an I/O transfer in progress (StatusFlags::wait).
+  uint64_t wait_clocks = 0;
+};
+
+// Drives the engines until a budget runs out or a stop condition fires. A
+// halted machine is resumed for the run, as the panel does when stepping, and
+// left halted afterwards unless the run reaches the next instruction. Idle
+// clocks are fast-forwarded when the execution engine allows it, and with a
+// functional engine whole instructions run through it wherever they fit the
+// budget.
+template <typename Engine>
+class BasicRunner {
+ public:
+  // Every instruction the run starts is reported to probes.
+  explicit BasicRunner(const Engine& execution,
+                       FunctionalEngine* functional = nullptr,
+                       InstructionProbes probes = {});
+
+  RunResult Run(MachineState& state,
+                const TimingEngine& timing,
+                const RunBudget& budget,
+                const StopConditions& stop = {}) const;
+
+ private:
+  uint32_t StepFunctional(MachineState& state,
+                          const TimingEngine& timing,
+                          const StopConditions& stop,
+                          uint32_t max_clocks,
+                          RunResult& result) const;
+
+  const Engine& execution_;
+  FunctionalEngine* functional_ = nullptr;
+  InstructionProbes probes_;
+};
+
+using Runner = BasicRunner<ExecutionEngine>;
+using UntracedRunner = BasicRunner<UntracedExecutionEngine>;
+using StreamingRunner = BasicRunner<StreamingExecutionEngine>;
+
+extern template class BasicRunner<ExecutionEngine>;
+extern template class BasicRunner<UntracedExecutionEngine>;
+extern template class BasicRunner<StreamingExecutionEngine>;
+
+}  // namespace ct10::core
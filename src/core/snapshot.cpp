@@ -0,0 +1,50 @@
+#include "core/snapshot.h"
+
+namespace ct10::core {
+namespace {
+
+// Every MachineCore field but memory, which keeps its generations and watch.
+void RestoreRegisters(MachineCore& core, const MachineCore& saved) {
+  core.accumulator = saved.accumulator;
+  core.buffer = saved.buffer;
+  core.quotient = saved.quotient;
+  core.index = saved.index;
+  core.countdown = saved.countdown;
+  core.mar = saved.mar;
+  core.par = saved.par;
+  core.opcode = saved.opcode;
+  core.distributor = saved.distributor;
+  core.x_bus = saved.x_bus;
+  core.y_bus = saved.y_bus;
+  core.z_bus = saved.z_bus;
+  core.f_bus = saved.f_bus;
+  core.flags = saved.flags;
+  core.timing = saved.timing;
+  core.mode = saved.mode;
+  core.status = saved.status;
+}
+
+}  // namespace
+
+Snapshot CaptureState(const MachineState& state) {
+  Snapshot snapshot;
+  CaptureState(state, snapshot);
+  return snapshot;
+}
+
+void CaptureState(const MachineState& state, Snapshot& snapshot) {
+  snapshot.core = state.core();
+  snapshot.io = state.io;
+  snapshot.panel_input = state.panel_input;
+  snapshot.trace = state.trace;
+}
+
+void RestoreState(MachineState& state, const Snapshot& snapshot) {
+  RestoreRegisters(state.core(), snapshot.core);
+  state.memory.Load(snapshot.core.memory.cells());
+  state.io = snapshot.io;
+  state.panel_input = snapshot.panel_input;
+  state.trace = snapshot.trace;
+}
+
+}  // namespace ct10::core
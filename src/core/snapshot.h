@@ -0,0 +1,26 @@
+#pragma once
+
+#include "core/machine_state.h"
+
+namespace ct10::core {
+
+// A whole machine held in memory, trace included, for quick saves and for
+// code that would otherwise round-trip a state file. Capturing into the
+// same Snapshot again reuses its buffers, and restoring reuses the
+// machine's, so neither allocates once the I/O streams stop growing.
+struct Snapshot {
+  MachineCore core;
+  IOState io;
+  PanelInput panel_input;
+  TraceBuffer trace{0};
+};
+
+Snapshot CaptureState(const MachineState& state);
+void CaptureState(const MachineState& state, Snapshot& snapshot);
+
+// Memory comes back with its generations moved forward, as if every page
+// were written, so page trackers such as CheckpointWriter stay right; the
+// memory watch is left as it is.
+void RestoreState(MachineState& state, const Snapshot& snapshot);
+
+}  // namespace ct10::core
@@ -1,317 +1,307 @@
 #include "core/state_io.h"
 
+#include <algorithm>
+#include <array>
 #include <cstring>
 #include <fstream>
-#include <vector>
+#include <istream>
+#include <streambuf>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "core/checkpoint.h"
 
 namespace ct10::core {
 namespace {
 
-constexpr char kMagic[8] = {'C', 'T', '1', '0', 'D', 'M', 'P', '1'};
-constexpr uint32_t kVersion = 6;
+constexpr size_t kHeaderBytes = sizeof(kStateMagic) + 6 * 4;
+// The CRC covers everything after the version and the CRC itself.
+constexpr size_t kCrcStart = sizeof(kStateMagic) + 8;
+constexpr size_t kTraceEntryBytes = 4;
+constexpr size_t kStreams = 5;
 
-bool WriteBytes(std::ofstream& out, const void* data, size_t size) {
-  out.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
-  return static_cast<bool>(out);
-}
+constexpr char kLegacyMagic[8] = {'C', 'T', '1', '0', 'D', 'M', 'P', '1'};
+constexpr uint32_t kLegacyVersion = 7;
 
-bool ReadBytes(std::ifstream& in, void* data, size_t size) {
-  in.read(static_cast<char*>(data), static_cast<std::streamsize>(size));
-  return static_cast<bool>(in);
+constexpr std::array<uint32_t, 256> MakeCrc32cTable() {
+  std::array<uint32_t, 256> table{};
+  for (uint32_t i = 0; i < 256; ++i) {
+    uint32_t crc = i;
+    for (int bit = 0; bit < 8; ++bit) {
+      crc = (crc & 1) ? (crc >> 1) ^ 0x82F63B78u : crc >> 1;
+    }
+    table[i] = crc;
+  }
+  return table;
 }
 
-bool WriteU8(std::ofstream& out, uint8_t value) {
-  return WriteBytes(out, &value, sizeof(value));
-}
+constexpr std::array<uint32_t, 256> kCrc32cTable = MakeCrc32cTable();
 
-bool WriteU16(std::ofstream& out, uint16_t value) {
-  uint8_t bytes[2] = {static_cast<uint8_t>(value & 0xFF),
-                      static_cast<uint8_t>((value >> 8) & 0xFF)};
-  return WriteBytes(out, bytes, sizeof(bytes));
+uint32_t Crc32c(std::span<const uint8_t> bytes) {
+  uint32_t crc = 0xFFFFFFFFu;
+  for (uint8_t byte : bytes) {
+    crc = kCrc32cTable[(crc ^ byte) & 0xFF] ^ (crc >> 8);
+  }
+  return crc ^ 0xFFFFFFFFu;
 }
 
-bool WriteU32(std::ofstream& out, uint32_t value) {
-  uint8_t bytes[4] = {static_cast<uint8_t>(value & 0xFF),
-                      static_cast<uint8_t>((value >> 8) & 0xFF),
-                      static_cast<uint8_t>((value >> 16) & 0xFF),
-                      static_cast<uint8_t>((value >> 24) & 0xFF)};
-  return WriteBytes(out, bytes, sizeof(bytes));
+void PutU32(uint8_t* bytes, uint32_t value) {
+  for (int i = 0; i < 4; ++i) {
+    bytes[i] = static_cast<uint8_t>(value >> (8 * i));
+  }
 }
 
-bool ReadU8(std::ifstream& in, uint8_t& value) {
-  return ReadBytes(in, &value, sizeof(value));
+void PutU32(std::vector<uint8_t>& out, uint32_t value) {
+  size_t pos = out.size();
+  out.resize(pos + 4);
+  PutU32(out.data() + pos, value);
 }
 
-bool ReadU16(std::ifstream& in, uint16_t& value) {
-  uint8_t bytes[2] = {};
-  if (!ReadBytes(in, bytes, sizeof(bytes))) {
-    return false;
-  }
-  value = static_cast<uint16_t>(bytes[0] | (bytes[1] << 8));
-  return true;
+uint32_t GetU32(const uint8_t* bytes) {
+  return static_cast<uint32_t>(bytes[0]) |
+         (static_cast<uint32_t>(bytes[1]) << 8) |
+         (static_cast<uint32_t>(bytes[2]) << 16) |
+         (static_cast<uint32_t>(bytes[3]) << 24);
 }
 
-bool ReadU32(std::ifstream& in, uint32_t& value) {
-  uint8_t bytes[4] = {};
-  if (!ReadBytes(in, bytes, sizeof(bytes))) {
-    return false;
-  }
-  value = static_cast<uint32_t>(bytes[0] | (bytes[1] << 8) |
-                                (bytes[2] << 16) | (bytes[3] << 24));
-  return true;
+std::array<const std::vector<uint8_t>*, kStreams> StreamsOf(
+    const IOState& io) {
+  return {&io.input_data, &io.output_data, &io.terminal_input,
+          &io.terminal_output, &io.printer_output};
 }
 
-bool WriteBool(std::ofstream& out, bool value) {
-  return WriteU8(out, value ? 1 : 0);
+std::array<std::vector<uint8_t>*, kStreams> StreamsOf(IOState& io) {
+  return {&io.input_data, &io.output_data, &io.terminal_input,
+          &io.terminal_output, &io.printer_output};
 }
 
-bool ReadBool(std::ifstream& in, bool& value) {
-  uint8_t raw = 0;
-  if (!ReadU8(in, raw)) {
-    return false;
+// PackBits-style runs: a control byte c below 0x80 is followed by c + 1
+// literal bytes; from 0x80 up it repeats the next byte (c & 0x7F) + 3 times.
+constexpr size_t kMaxLiteral = 128;
+constexpr size_t kMinRun = 3;
+constexpr size_t kMaxRun = 0x7F + kMinRun;
+
+size_t RunAt(const std::vector<uint8_t>& bytes, size_t pos) {
+  size_t end = pos + 1;
+  while (end < bytes.size() && end - pos < kMaxRun &&
+         bytes[end] == bytes[pos]) {
+    ++end;
   }
-  value = (raw != 0);
-  return true;
+  return end - pos;
 }
 
-}  // namespace
-
-bool SaveState(const MachineState& state,
-               const std::string& path,
-               std::string* error) {
-  std::ofstream out(path, std::ios::binary);
-  if (!out) {
-    if (error) {
-      *error = "Unable to open file for writing.";
+void AppendRunLength(const std::vector<uint8_t>& bytes,
+                     std::vector<uint8_t>& out) {
+  size_t pos = 0;
+  while (pos < bytes.size()) {
+    size_t run = RunAt(bytes, pos);
+    if (run >= kMinRun) {
+      out.push_back(static_cast<uint8_t>(0x80 | (run - kMinRun)));
+      out.push_back(bytes[pos]);
+      pos += run;
+      continue;
+    }
+    size_t literal_end = pos + run;
+    while (literal_end < bytes.size() && literal_end - pos < kMaxLiteral) {
+      run = RunAt(bytes, literal_end);
+      if (run >= kMinRun) {
+        break;
+      }
+      literal_end += run;
     }
-    return false;
+    literal_end = std::min(literal_end, pos + kMaxLiteral);
+    out.push_back(static_cast<uint8_t>(literal_end - pos - 1));
+    out.insert(out.end(), bytes.begin() + static_cast<std::ptrdiff_t>(pos),
+               bytes.begin() + static_cast<std::ptrdiff_t>(literal_end));
+    pos = literal_end;
   }
+}
 
-  if (!WriteBytes(out, kMagic, sizeof(kMagic)) ||
-      !WriteU32(out, kVersion)) {
-    if (error) {
-      *error = "Failed to write header.";
-    }
+bool DecodeRunLength(const uint8_t* data,
+                     size_t stored,
+                     size_t length,
+                     std::vector<uint8_t>& out) {
+  out.clear();
+  // A two-byte run is the most any stored bytes can expand, so a larger
+  // length is corrupt and must not reach the reserve.
+  if (length > stored * kMaxRun / 2) {
     return false;
   }
-
-  if (!WriteU16(out, state.accumulator.value()) ||
-      !WriteU16(out, state.buffer.value()) ||
-      !WriteU16(out, state.quotient.value()) ||
-      !WriteU16(out, state.index.value()) ||
-      !WriteU16(out, state.countdown.value()) ||
-      !WriteU16(out, state.mar.value()) ||
-      !WriteU16(out, state.par.value()) ||
-      !WriteU16(out, state.opcode.value()) ||
-      !WriteU16(out, state.distributor.value())) {
-    if (error) {
-      *error = "Failed to write registers.";
+  out.reserve(length);
+  size_t pos = 0;
+  while (pos < stored) {
+    uint8_t control = data[pos++];
+    if (control < 0x80) {
+      size_t count = static_cast<size_t>(control) + 1;
+      if (stored - pos < count || length - out.size() < count) {
+        return false;
+      }
+      out.insert(out.end(), data + pos, data + pos + count);
+      pos += count;
+    } else {
+      size_t count = static_cast<size_t>(control & 0x7F) + kMinRun;
+      if (pos == stored || length - out.size() < count) {
+        return false;
+      }
+      out.insert(out.end(), count, data[pos++]);
     }
-    return false;
   }
+  return out.size() == length;
+}
 
-  if (!WriteU8(out, state.timing.distributor) ||
-      !WriteU8(out, static_cast<uint8_t>(state.timing.phase)) ||
-      !WriteBool(out, state.timing.acquisition) ||
-      !WriteBool(out, state.mode.halted)) {
-    if (error) {
-      *error = "Failed to write timing/mode.";
-    }
-    return false;
-  }
+// Bounds-checked cursor over the state bytes.
+class ByteReader {
+ public:
+  explicit ByteReader(std::span<const uint8_t> bytes) : bytes_(bytes) {}
 
-  if (!WriteBool(out, state.flags.carry) ||
-      !WriteBool(out, state.flags.zero) ||
-      !WriteBool(out, state.flags.greater) ||
-      !WriteBool(out, state.flags.less) ||
-      !WriteBool(out, state.flags.add_overflow) ||
-      !WriteBool(out, state.flags.divide_overflow) ||
-      !WriteBool(out, state.flags.inst_error)) {
-    if (error) {
-      *error = "Failed to write flags.";
+  const uint8_t* Take(size_t count) {
+    if (bytes_.size() - pos_ < count) {
+      return nullptr;
     }
-    return false;
+    const uint8_t* data = bytes_.data() + pos_;
+    pos_ += count;
+    return data;
   }
 
-  if (!WriteBool(out, state.status.interrupt) ||
-      !WriteBool(out, state.status.sense) ||
-      !WriteBool(out, state.status.flag) ||
-      !WriteBool(out, state.status.wait)) {
-    if (error) {
-      *error = "Failed to write status flags.";
-    }
-    return false;
-  }
+  size_t remaining() const { return bytes_.size() - pos_; }
 
-  const Bus* buses[] = {&state.x_bus, &state.y_bus, &state.z_bus, &state.f_bus};
-  for (const Bus* bus : buses) {
-    if (!WriteU16(out, bus->value()) ||
-        !WriteBool(out, bus->driven()) ||
-        !WriteBool(out, bus->complemented())) {
-      if (error) {
-        *error = "Failed to write buses.";
-      }
-      return false;
-    }
-  }
+ private:
+  std::span<const uint8_t> bytes_;
+  size_t pos_ = 0;
+};
 
-  if (!WriteU32(out, Memory::kSize)) {
-    if (error) {
-      *error = "Failed to write memory header.";
-    }
-    return false;
-  }
-  for (uint16_t addr = 0; addr < Memory::kSize; ++addr) {
-    if (!WriteU8(out, state.memory.Read(addr))) {
-      if (error) {
-        *error = "Failed to write memory.";
-      }
-      return false;
-    }
+bool Fail(std::string* error, const char* message) {
+  if (error) {
+    *error = message;
   }
+  return false;
+}
 
-  if (!WriteU32(out, static_cast<uint32_t>(state.io.input_pos)) ||
-      !WriteBool(out, state.io.interrupt) ||
-      !WriteU8(out, state.io.last_command) ||
-      !WriteU8(out, state.io.status) ||
-      !WriteU8(out, state.io.selected_device) ||
-      !WriteBool(out, state.io.hex_mode) ||
-      !WriteBool(out, state.io.alpha_mode) ||
-      !WriteU8(out, static_cast<uint8_t>(state.io.transfer_mode)) ||
-      !WriteU16(out, state.io.transfer_address) ||
-      !WriteU16(out, state.io.transfer_remaining) ||
-      !WriteU8(out, state.io.wait_cycles)) {
-    if (error) {
-      *error = "Failed to write I/O header.";
-    }
-    return false;
-  }
+// The whole file, mapped where the platform allows and read in one go
+// otherwise.
+class MappedFile {
+ public:
+  MappedFile() = default;
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
 
-  if (!WriteU32(out, static_cast<uint32_t>(state.io.input_data.size()))) {
-    if (error) {
-      *error = "Failed to write input size.";
-    }
-    return false;
-  }
-  for (uint8_t value : state.io.input_data) {
-    if (!WriteU8(out, value)) {
-      if (error) {
-        *error = "Failed to write input data.";
-      }
-      return false;
+  ~MappedFile() {
+#if !defined(_WIN32)
+    if (mapping_ != nullptr) {
+      munmap(mapping_, size_);
     }
+#endif
   }
 
-  if (!WriteU32(out, static_cast<uint32_t>(state.io.output_data.size()))) {
-    if (error) {
-      *error = "Failed to write output size.";
-    }
-    return false;
-  }
-  for (uint8_t value : state.io.output_data) {
-    if (!WriteU8(out, value)) {
-      if (error) {
-        *error = "Failed to write output data.";
-      }
+  bool Open(const std::string& path) {
+#if !defined(_WIN32)
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
       return false;
     }
-  }
-
-  if (!WriteU32(out, static_cast<uint32_t>(state.io.terminal_input_pos)) ||
-      !WriteU32(out, static_cast<uint32_t>(state.io.terminal_input.size()))) {
-    if (error) {
-      *error = "Failed to write terminal input size.";
-    }
-    return false;
-  }
-  for (uint8_t value : state.io.terminal_input) {
-    if (!WriteU8(out, value)) {
-      if (error) {
-        *error = "Failed to write terminal input data.";
+    struct stat info {};
+    bool ok = fstat(fd, &info) == 0;
+    if (ok && info.st_size > 0) {
+      size_ = static_cast<size_t>(info.st_size);
+      void* mapping = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (mapping == MAP_FAILED) {
+        ok = false;
+        size_ = 0;
+      } else {
+        mapping_ = mapping;
       }
-      return false;
-    }
-  }
-
-  if (!WriteU32(out, static_cast<uint32_t>(state.io.terminal_output.size()))) {
-    if (error) {
-      *error = "Failed to write terminal output size.";
     }
-    return false;
-  }
-  for (uint8_t value : state.io.terminal_output) {
-    if (!WriteU8(out, value)) {
-      if (error) {
-        *error = "Failed to write terminal output data.";
-      }
+    close(fd);
+    return ok;
+#else
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in) {
       return false;
     }
-  }
+    data_.resize(static_cast<size_t>(in.tellg()));
+    in.seekg(0);
+    in.read(reinterpret_cast<char*>(data_.data()),
+            static_cast<std::streamsize>(data_.size()));
+    return static_cast<bool>(in);
+#endif
+  }
+
+  std::span<const uint8_t> bytes() const {
+#if !defined(_WIN32)
+    return {static_cast<const uint8_t*>(mapping_), size_};
+#else
+    return data_;
+#endif
+  }
+
+ private:
+#if !defined(_WIN32)
+  void* mapping_ = nullptr;
+  size_t size_ = 0;
+#else
+  std::vector<uint8_t> data_;
+#endif
+};
+
+// Lets the v1 reader run over the mapped bytes.
+class ByteStreamBuf : public std::streambuf {
+ public:
+  explicit ByteStreamBuf(std::span<const uint8_t> bytes) {
+    char* begin = const_cast<char*>(
+        reinterpret_cast<const char*>(bytes.data()));
+    setg(begin, begin, begin + bytes.size());
+  }
+};
+
+bool ReadBytes(std::istream& in, void* data, size_t size) {
+  in.read(static_cast<char*>(data), static_cast<std::streamsize>(size));
+  return static_cast<bool>(in);
+}
 
-  if (!WriteU32(out, static_cast<uint32_t>(state.io.printer_output.size()))) {
-    if (error) {
-      *error = "Failed to write printer output size.";
-    }
+bool ReadU8(std::istream& in, uint8_t& value) {
+  return ReadBytes(in, &value, sizeof(value));
+}
+
+bool ReadU16(std::istream& in, uint16_t& value) {
+  uint8_t bytes[2] = {};
+  if (!ReadBytes(in, bytes, sizeof(bytes))) {
     return false;
   }
-  for (uint8_t value : state.io.printer_output) {
-    if (!WriteU8(out, value)) {
-      if (error) {
-        *error = "Failed to write printer output data.";
-      }
-      return false;
-    }
-  }
+  value = static_cast<uint16_t>(bytes[0] | (bytes[1] << 8));
+  return true;
+}
 
-  if (!WriteBool(out, state.panel_input.start) ||
-      !WriteBool(out, state.panel_input.stop) ||
-      !WriteBool(out, state.panel_input.clear) ||
-      !WriteBool(out, state.panel_input.lamp_test) ||
-      !WriteBool(out, state.panel_input.reset) ||
-      !WriteBool(out, state.panel_input.power_on) ||
-      !WriteBool(out, state.panel_input.key_pressed) ||
-      !WriteBool(out, state.panel_input.has_last_key) ||
-      !WriteU8(out, state.panel_input.key_value) ||
-      !WriteU8(out, state.panel_input.last_key) ||
-      !WriteU16(out, state.panel_input.input_switches) ||
-      !WriteU8(out, state.panel_input.io_mode) ||
-      !WriteU8(out, state.panel_input.mode) ||
-      !WriteBool(out, state.panel_input.mem_read) ||
-      !WriteBool(out, state.panel_input.mem_write) ||
-      !WriteBool(out, state.panel_input.load_pressed) ||
-      !WriteU8(out, static_cast<uint8_t>(state.panel_input.load_target)) ||
-      !WriteBool(out, state.panel_input.rpt) ||
-      !WriteBool(out, state.panel_input.sense) ||
-      !WriteBool(out, state.panel_input.error_inst) ||
-      !WriteBool(out, state.panel_input.error_add) ||
-      !WriteBool(out, state.panel_input.error_div) ||
-      !WriteBool(out, state.panel_input.io_read) ||
-      !WriteBool(out, state.panel_input.io_write) ||
-      !WriteBool(out, state.panel_input.io_intrp) ||
-      !WriteBool(out, state.panel_input.io_block)) {
-    if (error) {
-      *error = "Failed to write panel input.";
-    }
+bool ReadU32(std::istream& in, uint32_t& value) {
+  uint8_t bytes[4] = {};
+  if (!ReadBytes(in, bytes, sizeof(bytes))) {
     return false;
   }
-
+  value = static_cast<uint32_t>(bytes[0] | (bytes[1] << 8) |
+                                (bytes[2] << 16) | (bytes[3] << 24));
   return true;
 }
 
-bool LoadState(MachineState& state,
-               const std::string& path,
-               std::string* error) {
-  std::ifstream in(path, std::ios::binary);
-  if (!in) {
-    if (error) {
-      *error = "Unable to open file for reading.";
-    }
+bool ReadBool(std::istream& in, bool& value) {
+  uint8_t raw = 0;
+  if (!ReadU8(in, raw)) {
     return false;
   }
+  value = (raw != 0);
+  return true;
+}
 
-  char magic[sizeof(kMagic)] = {};
+// Reads a "CT10DMP1" file, versions 1 through 7.
+bool LoadLegacyState(std::istream& in,
+                     MachineState& state,
+                     std::string* error) {
+  char magic[sizeof(kLegacyMagic)] = {};
   if (!ReadBytes(in, magic, sizeof(magic)) ||
-      std::memcmp(magic, kMagic, sizeof(kMagic)) != 0) {
+      std::memcmp(magic, kLegacyMagic, sizeof(kLegacyMagic)) != 0) {
     if (error) {
       *error = "Invalid state file header.";
     }
@@ -321,7 +311,8 @@ bool LoadState(MachineState& state,
   uint32_t version = 0;
   if (!ReadU32(in, version) ||
       (version != 1 && version != 2 && version != 3 &&
-       version != 4 && version != 5 && version != kVersion)) {
+       version != 4 && version != 5 && version != 6 &&
+       version != kLegacyVersion)) {
     if (error) {
       *error = "Unsupported state file version.";
     }
@@ -647,7 +638,211 @@ bool LoadState(MachineState& state,
     return false;
   }
 
+  state.trace.Clear();
+  if (version >= 7) {
+    uint32_t trace_size = 0;
+    if (!ReadU32(in, trace_size)) {
+      if (error) {
+        *error = "Failed to read trace size.";
+      }
+      return false;
+    }
+    for (uint32_t i = 0; i < trace_size; ++i) {
+      uint8_t phase = 0;
+      uint8_t op = 0;
+      TraceEntry entry;
+      if (!ReadU8(in, entry.distributor) ||
+          !ReadU8(in, phase) ||
+          !ReadBool(in, entry.acquisition) ||
+          !ReadU8(in, op)) {
+        if (error) {
+          *error = "Failed to read trace.";
+        }
+        return false;
+      }
+      entry.phase = static_cast<ClockPhase>(phase);
+      entry.op = static_cast<MicroOp>(op);
+      state.trace.Push(entry);
+    }
+  }
+
+  return true;
+}
+
+}  // namespace
+
+void SerializeState(const MachineState& state,
+                    std::vector<uint8_t>& out,
+                    const StateSaveOptions& options) {
+  out.clear();
+  out.resize(kHeaderBytes);
+  std::memcpy(out.data(), kStateMagic, sizeof(kStateMagic));
+
+  CheckpointFields fields;
+  GatherCheckpointFields(state, fields);
+  for (uint32_t field : fields) {
+    PutU32(out, field);
+  }
+
+  const auto& cells = state.memory.cells();
+  out.insert(out.end(), cells.begin(), cells.end());
+
+  uint32_t flags = options.compress_streams ? kStateCompressedStreams : 0;
+  std::vector<uint8_t> packed;
+  for (const std::vector<uint8_t>* stream : StreamsOf(state.io)) {
+    PutU32(out, static_cast<uint32_t>(stream->size()));
+    packed.clear();
+    if (options.compress_streams) {
+      AppendRunLength(*stream, packed);
+    }
+    if (options.compress_streams && packed.size() < stream->size()) {
+      PutU32(out, static_cast<uint32_t>(packed.size()));
+      out.insert(out.end(), packed.begin(), packed.end());
+    } else {
+      PutU32(out, static_cast<uint32_t>(stream->size()));
+      out.insert(out.end(), stream->begin(), stream->end());
+    }
+  }
+
+  for (const TraceEntry& entry : state.trace) {
+    out.push_back(entry.distributor);
+    out.push_back(static_cast<uint8_t>(entry.phase));
+    out.push_back(entry.acquisition ? 1 : 0);
+    out.push_back(static_cast<uint8_t>(entry.op));
+  }
+
+  uint8_t* header = out.data() + sizeof(kStateMagic);
+  PutU32(header, kStateVersion);
+  PutU32(header + 8, flags);
+  PutU32(header + 12, static_cast<uint32_t>(kCheckpointFieldCount));
+  PutU32(header + 16, static_cast<uint32_t>(Memory::kSize));
+  PutU32(header + 20, static_cast<uint32_t>(state.trace.size()));
+  PutU32(header + 4,
+         Crc32c(std::span<const uint8_t>(out).subspan(kCrcStart)));
+}
+
+bool DeserializeState(std::span<const uint8_t> bytes,
+                      MachineState& state,
+                      std::string* error) {
+  if (bytes.size() < kHeaderBytes ||
+      std::memcmp(bytes.data(), kStateMagic, sizeof(kStateMagic)) != 0) {
+    return Fail(error, "Invalid state file header.");
+  }
+  const uint8_t* header = bytes.data() + sizeof(kStateMagic);
+  if (GetU32(header) != kStateVersion) {
+    return Fail(error, "Unsupported state file version.");
+  }
+  if (GetU32(header + 4) != Crc32c(bytes.subspan(kCrcStart))) {
+    return Fail(error, "State file checksum mismatch.");
+  }
+  uint32_t flags = GetU32(header + 8);
+  if (GetU32(header + 12) != kCheckpointFieldCount) {
+    return Fail(error, "Unexpected register block size.");
+  }
+  if (GetU32(header + 16) != Memory::kSize) {
+    return Fail(error, "Unexpected memory size.");
+  }
+  uint32_t trace_size = GetU32(header + 20);
+
+  ByteReader reader(bytes.subspan(kHeaderBytes));
+  const uint8_t* field_bytes = reader.Take(kCheckpointFieldCount * 4);
+  const uint8_t* cells = reader.Take(Memory::kSize);
+  if (field_bytes == nullptr || cells == nullptr) {
+    return Fail(error, "State file is truncated.");
+  }
+
+  std::array<std::vector<uint8_t>, kStreams> streams;
+  for (std::vector<uint8_t>& stream : streams) {
+    const uint8_t* lengths = reader.Take(8);
+    if (lengths == nullptr) {
+      return Fail(error, "State file is truncated.");
+    }
+    uint32_t length = GetU32(lengths);
+    uint32_t stored = GetU32(lengths + 4);
+    const uint8_t* data = reader.Take(stored);
+    if (data == nullptr) {
+      return Fail(error, "State file is truncated.");
+    }
+    if (stored == length) {
+      stream.assign(data, data + stored);
+    } else if (!(flags & kStateCompressedStreams) ||
+               !DecodeRunLength(data, stored, length, stream)) {
+      return Fail(error, "Failed to read I/O streams.");
+    }
+  }
+
+  size_t trace_bytes = static_cast<size_t>(trace_size) * kTraceEntryBytes;
+  if (reader.remaining() != trace_bytes) {
+    return Fail(error, "Failed to read trace.");
+  }
+  const uint8_t* trace = reader.Take(trace_bytes);
+
+  CheckpointFields fields;
+  for (size_t i = 0; i < kCheckpointFieldCount; ++i) {
+    fields[i] = GetU32(field_bytes + 4 * i);
+  }
+  if (!ValidCheckpointFields(fields)) {
+    return Fail(error, "State file has an out-of-range field.");
+  }
+  ScatterCheckpointFields(fields, state);
+  state.memory.Load(std::span<const uint8_t, Memory::kSize>(cells,
+                                                            Memory::kSize));
+  auto targets = StreamsOf(state.io);
+  for (size_t i = 0; i < kStreams; ++i) {
+    targets[i]->swap(streams[i]);
+  }
+  // As in the legacy reader, a position past its stream means exhausted.
+  state.io.input_pos = std::min(state.io.input_pos, state.io.input_data.size());
+  state.io.terminal_input_pos =
+      std::min(state.io.terminal_input_pos, state.io.terminal_input.size());
+  state.trace.Clear();
+  for (uint32_t i = 0; i < trace_size; ++i) {
+    const uint8_t* raw = trace + kTraceEntryBytes * i;
+    TraceEntry entry;
+    entry.distributor = raw[0];
+    entry.phase = static_cast<ClockPhase>(raw[1]);
+    entry.acquisition = raw[2] != 0;
+    entry.op = static_cast<MicroOp>(raw[3]);
+    state.trace.Push(entry);
+  }
   return true;
 }
 
+bool SaveState(const MachineState& state,
+               const std::string& path,
+               std::string* error,
+               const StateSaveOptions& options) {
+  std::vector<uint8_t> bytes;
+  SerializeState(state, bytes, options);
+
+  std::ofstream out(path, std::ios::binary);
+  if (!out) {
+    return Fail(error, "Unable to open file for writing.");
+  }
+  out.write(reinterpret_cast<const char*>(bytes.data()),
+            static_cast<std::streamsize>(bytes.size()));
+  out.close();
+  if (!out) {
+    return Fail(error, "Failed to write state file.");
+  }
+  return true;
+}
+
+bool LoadState(MachineState& state,
+               const std::string& path,
+               std::string* error) {
+  MappedFile file;
+  if (!file.Open(path)) {
+    return Fail(error, "Unable to open file for reading.");
+  }
+  std::span<const uint8_t> bytes = file.bytes();
+  if (bytes.size() >= sizeof(kLegacyMagic) &&
+      std::memcmp(bytes.data(), kLegacyMagic, sizeof(kLegacyMagic)) == 0) {
+    ByteStreamBuf buffer(bytes);
+    std::istream in(&buffer);
+    return LoadLegacyState(in, state, error);
+  }
+  return DeserializeState(bytes, state, error);
+}
+
 }  // namespace ct10::core
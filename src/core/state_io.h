@@ -1,14 +1,49 @@
 #pragma once
 
+#include <cstdint>
+#include <span>
 #include <string>
+#include <vector>
 
 #include "core/machine_state.h"
 
 namespace ct10::core {
 
+// State file v2, little endian:
+//   header: magic (8), version (u32), CRC32C of every byte after it (u32),
+//           flags (u32), field count (u32), memory bytes (u32),
+//           trace entries (u32)
+//   fields: a u32 for each checkpoint field (core/checkpoint.h)
+//   memory: the cells in address order
+//   streams: for each I/O stream, its length (u32), stored length (u32)
+//            and the stored bytes, run-length coded when shorter
+//   trace: distributor, phase, acquisition and op for each entry, oldest
+//          first
+// LoadState still reads the older "CT10DMP1" files.
+inline constexpr char kStateMagic[8] = {'C', 'T', '1', '0',
+                                        'D', 'M', 'P', '2'};
+inline constexpr uint32_t kStateVersion = 1;
+
+inline constexpr uint32_t kStateCompressedStreams = 0x01;
+
+struct StateSaveOptions {
+  // Run-length codes the I/O streams where that makes them smaller.
+  bool compress_streams = false;
+};
+
+// Replaces out with the state file bytes for state.
+void SerializeState(const MachineState& state,
+                    std::vector<uint8_t>& out,
+                    const StateSaveOptions& options = {});
+// Leaves state untouched unless bytes hold a whole, intact v2 state.
+bool DeserializeState(std::span<const uint8_t> bytes,
+                      MachineState& state,
+                      std::string* error);
+
 bool SaveState(const MachineState& state,
                const std::string& path,
-               std::string* error);
+               std::string* error,
+               const StateSaveOptions& options = {});
 bool LoadState(MachineState& state,
                const std::string& path,
                std::string* error);
@@ -26,6 +26,25 @@ void TimingEngine::Advance(TimingState& state) const {
   }
 }
 
+void TimingEngine::AdvanceBy(TimingState& state, uint32_t clocks) const {
+  uint8_t phase_index = static_cast<uint8_t>(state.phase);
+  if (state.distributor > 0x0F || phase_index < 1 || phase_index > 3) {
+    for (uint32_t i = 0; i < clocks; ++i) {
+      Advance(state);
+    }
+    return;
+  }
+  constexpr uint32_t kClocksPerHalf = 16 * 3;
+  uint32_t slot = static_cast<uint32_t>(state.distributor) * 3 +
+                  (phase_index - 1) + clocks;
+  if (((slot / kClocksPerHalf) & 1u) != 0) {
+    state.acquisition = !state.acquisition;
+  }
+  slot %= kClocksPerHalf;
+  state.distributor = static_cast<uint8_t>(slot / 3);
+  state.phase = static_cast<ClockPhase>(slot % 3 + 1);
+}
+
 void TimingEngine::set_speed_multiplier(double speed_multiplier) {
   if (speed_multiplier > 0.0) {
     speed_multiplier_ = speed_multiplier;
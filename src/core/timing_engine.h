@@ -20,6 +20,7 @@ class TimingEngine {
  public:
   void Reset(TimingState& state) const;
   void Advance(TimingState& state) const;
+  void AdvanceBy(TimingState& state, uint32_t clocks) const;
 
   void set_speed_multiplier(double speed_multiplier);
   double speed_multiplier() const;
@@ -0,0 +1,39 @@
+#include "core/trace_buffer.h"
+
+namespace ct10::core {
+
+TraceBuffer::TraceBuffer(size_t capacity) { set_capacity(capacity); }
+
+void TraceBuffer::set_capacity(size_t capacity) {
+  entries_.assign(capacity, TraceEntry{});
+  Clear();
+}
+
+size_t TraceBuffer::capacity() const { return entries_.size(); }
+
+size_t TraceBuffer::size() const { return size_; }
+
+bool TraceBuffer::empty() const { return size_ == 0; }
+
+void TraceBuffer::Clear() {
+  head_ = 0;
+  size_ = 0;
+}
+
+const TraceEntry& TraceBuffer::operator[](size_t index) const {
+  size_t start = head_ >= size_ ? head_ - size_
+                                : head_ + entries_.size() - size_;
+  size_t slot = start + index;
+  if (slot >= entries_.size()) {
+    slot -= entries_.size();
+  }
+  return entries_[slot];
+}
+
+TraceBuffer::Iterator TraceBuffer::begin() const { return Iterator(this, 0); }
+
+TraceBuffer::Iterator TraceBuffer::end() const {
+  return Iterator(this, size_);
+}
+
+}  // namespace ct10::core
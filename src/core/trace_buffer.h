@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+#include "core/microcode.h"
+#include "core/timing_engine.h"
+
+namespace ct10::core {
+
+struct TraceEntry {
+  uint8_t distributor = 0;
+  ClockPhase phase = ClockPhase::CP1;
+  bool acquisition = true;
+  MicroOp op = MicroOp::PAR_TO_MAR;
+};
+
+inline TraceEntry MakeTraceEntry(const TimingState& timing, MicroOp op) {
+  return {timing.distributor, timing.phase, timing.acquisition, op};
+}
+
+// Fixed-capacity ring of the most recent micro-ops, oldest first. Storage is
+// allocated when the capacity is set, so Push never allocates or shifts
+// entries. A capacity of zero disables recording.
+class TraceBuffer {
+ public:
+  static constexpr size_t kDefaultCapacity = 512;
+
+  class Iterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = TraceEntry;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const TraceEntry*;
+    using reference = const TraceEntry&;
+
+    Iterator(const TraceBuffer* buffer, size_t index)
+        : buffer_(buffer), index_(index) {}
+
+    reference operator*() const { return (*buffer_)[index_]; }
+    pointer operator->() const { return &(*buffer_)[index_]; }
+    Iterator& operator++() {
+      ++index_;
+      return *this;
+    }
+    Iterator operator++(int) {
+      Iterator previous = *this;
+      ++index_;
+      return previous;
+    }
+    bool operator==(const Iterator& other) const {
+      return index_ == other.index_;
+    }
+    bool operator!=(const Iterator& other) const {
+      return index_ != other.index_;
+    }
+
+   private:
+    const TraceBuffer* buffer_ = nullptr;
+    size_t index_ = 0;
+  };
+
+  explicit TraceBuffer(size_t capacity = kDefaultCapacity);
+
+  // Drops every entry and reallocates for the new capacity.
+  void set_capacity(size_t capacity);
+  size_t capacity() const;
+  size_t size() const;
+  bool empty() const;
+
+  void Push(const TraceEntry& entry) {
+    if (entries_.empty()) {
+      return;
+    }
+    entries_[head_] = entry;
+    head_ = head_ + 1 == entries_.size() ? 0 : head_ + 1;
+    if (size_ < entries_.size()) {
+      ++size_;
+    }
+  }
+  void Clear();
+
+  // Index 0 is the oldest entry still held.
+  const TraceEntry& operator[](size_t index) const;
+  Iterator begin() const;
+  Iterator end() const;
+
+ private:
+  std::vector<TraceEntry> entries_;
+  size_t head_ = 0;
+  size_t size_ = 0;
+};
+
+}  // namespace ct10::core
@@ -0,0 +1,144 @@
+#include "core/trace_file.h"
+
+#include <cstring>
+
+namespace ct10::core {
+
+TraceRecorder::TraceRecorder(size_t buffer_bytes)
+    : stream_([this](std::span<const uint8_t> bytes) { Write(bytes); },
+              buffer_bytes) {}
+
+TraceRecorder::~TraceRecorder() { Close(nullptr); }
+
+bool TraceRecorder::Open(const std::string& path, std::string* error) {
+  out_.open(path, std::ios::binary | std::ios::trunc);
+  if (!out_) {
+    if (error) {
+      *error = "Unable to open trace file for writing.";
+    }
+    return false;
+  }
+  uint8_t header[kTraceHeaderBytes] = {};
+  std::memcpy(header, kTraceMagic, sizeof(kTraceMagic));
+  for (size_t i = 0; i < 4; ++i) {
+    header[sizeof(kTraceMagic) + i] =
+        static_cast<uint8_t>((kTraceVersion >> (8 * i)) & 0xFF);
+  }
+  write_failed_ = false;
+  Write(header);
+  if (write_failed_) {
+    if (error) {
+      *error = "Failed to write trace header.";
+    }
+    return false;
+  }
+  return true;
+}
+
+bool TraceRecorder::Close(std::string* error) {
+  if (!out_.is_open()) {
+    return true;
+  }
+  stream_.Flush();
+  out_.close();
+  if (write_failed_ || out_.fail()) {
+    if (error) {
+      *error = "Failed to write trace file.";
+    }
+    return false;
+  }
+  return true;
+}
+
+TraceStream& TraceRecorder::stream() { return stream_; }
+
+StreamingTraceSink TraceRecorder::sink() { return StreamingTraceSink(&stream_); }
+
+void TraceRecorder::Write(std::span<const uint8_t> bytes) {
+  if (!out_.is_open() || write_failed_) {
+    return;
+  }
+  out_.write(reinterpret_cast<const char*>(bytes.data()),
+             static_cast<std::streamsize>(bytes.size()));
+  if (!out_) {
+    write_failed_ = true;
+  }
+}
+
+bool TraceReader::Open(const std::string& path, std::string* error) {
+  in_.open(path, std::ios::binary);
+  if (!in_) {
+    if (error) {
+      *error = "Unable to open trace file for reading.";
+    }
+    return false;
+  }
+  buffer_.resize(kBufferBytes);
+  pos_ = 0;
+  end_ = 0;
+  error_.clear();
+
+  uint32_t version = 0;
+  if (!Fill(kTraceHeaderBytes) ||
+      std::memcmp(buffer_.data(), kTraceMagic, sizeof(kTraceMagic)) != 0) {
+    if (error) {
+      *error = "Invalid trace file header.";
+    }
+    return false;
+  }
+  for (size_t i = 0; i < 4; ++i) {
+    version |= static_cast<uint32_t>(buffer_[sizeof(kTraceMagic) + i])
+               << (8 * i);
+  }
+  if (version != kTraceVersion) {
+    if (error) {
+      *error = "Unsupported trace file version.";
+    }
+    return false;
+  }
+  pos_ = kTraceHeaderBytes;
+  return true;
+}
+
+bool TraceReader::Next(TraceRecord& record) {
+  if (!Fill(1)) {
+    return false;
+  }
+  if ((buffer_[pos_] & kInstructionRecordTag) != 0) {
+    if (!Fill(kInstructionRecordBytes)) {
+      error_ = "Trace file ends inside an instruction record.";
+      return false;
+    }
+    record.kind = TraceRecordKind::Instruction;
+    record.instruction = DecodeInstructionRecord(buffer_.data() + pos_);
+    pos_ += kInstructionRecordBytes;
+    return true;
+  }
+  if (!Fill(kMicroOpRecordBytes)) {
+    error_ = "Trace file ends inside a micro-op record.";
+    return false;
+  }
+  record.kind = TraceRecordKind::MicroOp;
+  record.micro_op = DecodeMicroOpRecord(buffer_.data() + pos_);
+  pos_ += kMicroOpRecordBytes;
+  return true;
+}
+
+const std::string& TraceReader::error() const { return error_; }
+
+bool TraceReader::Fill(size_t needed) {
+  if (end_ - pos_ >= needed) {
+    return true;
+  }
+  std::memmove(buffer_.data(), buffer_.data() + pos_, end_ - pos_);
+  end_ -= pos_;
+  pos_ = 0;
+  while (end_ < needed && in_) {
+    in_.read(reinterpret_cast<char*>(buffer_.data() + end_),
+             static_cast<std::streamsize>(buffer_.size() - end_));
+    end_ += static_cast<size_t>(in_.gcount());
+  }
+  return end_ - pos_ >= needed;
+}
+
+}  // namespace ct10::core
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "core/trace_buffer.h"
+#include "core/trace_format.h"
+#include "core/trace_sink.h"
+
+namespace ct10::core {
+
+// Writes a binary trace file (trace_format.h). Records collect in the
+// stream's buffer and reach the file one buffer at a time.
+class TraceRecorder {
+ public:
+  explicit TraceRecorder(
+      size_t buffer_bytes = TraceStream::kDefaultBufferBytes);
+  ~TraceRecorder();
+
+  TraceRecorder(const TraceRecorder&) = delete;
+  TraceRecorder& operator=(const TraceRecorder&) = delete;
+
+  bool Open(const std::string& path, std::string* error);
+  // Flushes the stream; false when any write failed.
+  bool Close(std::string* error);
+
+  TraceStream& stream();
+  StreamingTraceSink sink();
+
+ private:
+  void Write(std::span<const uint8_t> bytes);
+
+  std::ofstream out_;
+  TraceStream stream_;
+  bool write_failed_ = false;
+};
+
+enum class TraceRecordKind : uint8_t {
+  MicroOp,
+  Instruction,
+};
+
+struct TraceRecord {
+  TraceRecordKind kind = TraceRecordKind::MicroOp;
+  TraceEntry micro_op;
+  InstructionRecord instruction;
+};
+
+// Reads a trace file record by record through a large read buffer.
+class TraceReader {
+ public:
+  static constexpr size_t kBufferBytes = 1u << 20;
+
+  bool Open(const std::string& path, std::string* error);
+  // Returns false at the end of the file; error() is set when the file ends
+  // inside a record.
+  bool Next(TraceRecord& record);
+  const std::string& error() const;
+
+ private:
+  bool Fill(size_t needed);
+
+  std::ifstream in_;
+  std::vector<uint8_t> buffer_;
+  size_t pos_ = 0;
+  size_t end_ = 0;
+  std::string error_;
+};
+
+}  // namespace ct10::core
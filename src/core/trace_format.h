@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "core/machine_state.h"
+#include "core/microcode.h"
+#include "core/timing_engine.h"
+#include "core/trace_buffer.h"
+
+namespace ct10::core {
+
+// Binary execution trace: an 8-byte magic and a u32 version, then a stream of
+// records. A micro-op record is two bytes, the first with bit 7 clear:
+//   bits 0-3 distributor, bits 4-5 clock phase, bit 6 acquisition; then op.
+// An instruction record is written as each instruction is acquired, before
+// its first micro-op:
+//   0x80, PAR (u16 little endian), opcode, A, Q, X, flags.
+inline constexpr char kTraceMagic[8] = {'C', 'T', '1', '0', 'T', 'R', 'C', '1'};
+inline constexpr uint32_t kTraceVersion = 1;
+inline constexpr size_t kTraceHeaderBytes = sizeof(kTraceMagic) + 4;
+
+inline constexpr uint8_t kInstructionRecordTag = 0x80;
+inline constexpr size_t kMicroOpRecordBytes = 2;
+inline constexpr size_t kInstructionRecordBytes = 8;
+
+struct InstructionRecord {
+  uint16_t par = 0;
+  uint8_t opcode = 0;
+  uint8_t accumulator = 0;
+  uint8_t quotient = 0;
+  uint8_t index = 0;
+  Flags flags;
+};
+
+inline uint8_t EncodeTraceFlags(const Flags& flags) {
+  return static_cast<uint8_t>((flags.carry ? 0x01 : 0) |
+                              (flags.zero ? 0x02 : 0) |
+                              (flags.greater ? 0x04 : 0) |
+                              (flags.less ? 0x08 : 0) |
+                              (flags.add_overflow ? 0x10 : 0) |
+                              (flags.divide_overflow ? 0x20 : 0) |
+                              (flags.inst_error ? 0x40 : 0));
+}
+
+inline Flags DecodeTraceFlags(uint8_t bits) {
+  Flags flags;
+  flags.carry = (bits & 0x01) != 0;
+  flags.zero = (bits & 0x02) != 0;
+  flags.greater = (bits & 0x04) != 0;
+  flags.less = (bits & 0x08) != 0;
+  flags.add_overflow = (bits & 0x10) != 0;
+  flags.divide_overflow = (bits & 0x20) != 0;
+  flags.inst_error = (bits & 0x40) != 0;
+  return flags;
+}
+
+inline void EncodeMicroOpRecord(const TimingState& timing,
+                                MicroOp op,
+                                uint8_t* out) {
+  out[0] = static_cast<uint8_t>((timing.distributor & 0x0F) |
+                                ((static_cast<uint8_t>(timing.phase) & 0x03)
+                                 << 4) |
+                                (timing.acquisition ? 0x40 : 0));
+  out[1] = static_cast<uint8_t>(op);
+}
+
+inline TraceEntry DecodeMicroOpRecord(const uint8_t* in) {
+  TraceEntry entry;
+  entry.distributor = in[0] & 0x0F;
+  entry.phase = static_cast<ClockPhase>((in[0] >> 4) & 0x03);
+  entry.acquisition = (in[0] & 0x40) != 0;
+  entry.op = static_cast<MicroOp>(in[1]);
+  return entry;
+}
+
+inline void EncodeInstructionRecord(const MachineState& state, uint8_t* out) {
+  uint16_t par = state.par.value();
+  out[0] = kInstructionRecordTag;
+  out[1] = static_cast<uint8_t>(par & 0xFF);
+  out[2] = static_cast<uint8_t>(par >> 8);
+  out[3] = state.memory.Read(par);
+  out[4] = static_cast<uint8_t>(state.accumulator.value());
+  out[5] = static_cast<uint8_t>(state.quotient.value());
+  out[6] = static_cast<uint8_t>(state.index.value());
+  out[7] = EncodeTraceFlags(state.flags);
+}
+
+inline InstructionRecord DecodeInstructionRecord(const uint8_t* in) {
+  InstructionRecord record;
+  record.par = static_cast<uint16_t>(in[1] | (in[2] << 8));
+  record.opcode = in[3];
+  record.accumulator = in[4];
+  record.quotient = in[5];
+  record.index = in[6];
+  record.flags = DecodeTraceFlags(in[7]);
+  return record;
+}
+
+}  // namespace ct10::core
@@ -0,0 +1,25 @@
+#include "core/trace_sink.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace ct10::core {
+
+TraceStream::TraceStream(Writer writer, size_t buffer_bytes)
+    : writer_(std::move(writer)),
+      buffer_(std::max(buffer_bytes, kInstructionRecordBytes)) {}
+
+TraceStream::~TraceStream() { Flush(); }
+
+void TraceStream::Flush() {
+  if (size_ > 0 && writer_) {
+    writer_(std::span<const uint8_t>(buffer_.data(), size_));
+  }
+  size_ = 0;
+}
+
+uint64_t TraceStream::micro_ops() const { return micro_ops_; }
+
+uint64_t TraceStream::instructions() const { return instructions_; }
+
+}  // namespace ct10::core
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <vector>
+
+#include "core/machine_state.h"
+#include "core/microcode.h"
+#include "core/trace_buffer.h"
+#include "core/trace_format.h"
+
+namespace ct10::core {
+
+// Trace sinks are the TraceSink policy of BasicExecutionEngine. When kEnabled
+// is true, Instruction is called at acquisition D0 CP1 before the first
+// micro-op of each instruction and Record after every executed micro-op. A
+// disabled sink is never called, so it costs nothing on the hot path.
+
+struct NullTraceSink {
+  static constexpr bool kEnabled = false;
+
+  void Instruction(MachineState&) const {}
+  void Record(MachineState&, MicroOp) const {}
+};
+
+// Keeps the most recent micro-ops in MachineState::trace for the debug pane.
+struct RingTraceSink {
+  static constexpr bool kEnabled = true;
+
+  void Instruction(MachineState&) const {}
+  void Record(MachineState& state, MicroOp op) const {
+    state.trace.Push(MakeTraceEntry(state.timing, op));
+  }
+};
+
+// Encodes records in the trace_format.h layout into a large buffer and hands
+// it to a writer each time it fills. Whatever is still buffered is written
+// on Flush and on destruction.
+class TraceStream {
+ public:
+  using Writer = std::function<void(std::span<const uint8_t>)>;
+
+  static constexpr size_t kDefaultBufferBytes = 1u << 20;
+
+  explicit TraceStream(Writer writer,
+                       size_t buffer_bytes = kDefaultBufferBytes);
+  ~TraceStream();
+
+  TraceStream(const TraceStream&) = delete;
+  TraceStream& operator=(const TraceStream&) = delete;
+
+  void AppendMicroOp(const TimingState& timing, MicroOp op) {
+    if (size_ + kMicroOpRecordBytes > buffer_.size()) {
+      Flush();
+    }
+    EncodeMicroOpRecord(timing, op, buffer_.data() + size_);
+    size_ += kMicroOpRecordBytes;
+    ++micro_ops_;
+  }
+  void AppendInstruction(const MachineState& state) {
+    if (size_ + kInstructionRecordBytes > buffer_.size()) {
+      Flush();
+    }
+    EncodeInstructionRecord(state, buffer_.data() + size_);
+    size_ += kInstructionRecordBytes;
+    ++instructions_;
+  }
+  void Flush();
+
+  uint64_t micro_ops() const;
+  uint64_t instructions() const;
+
+ private:
+  Writer writer_;
+  std::vector<uint8_t> buffer_;
+  size_t size_ = 0;
+  uint64_t micro_ops_ = 0;
+  uint64_t instructions_ = 0;
+};
+
+// Forwards every record to a TraceStream; unbound, it records nothing.
+class StreamingTraceSink {
+ public:
+  static constexpr bool kEnabled = true;
+
+  explicit StreamingTraceSink(TraceStream* stream = nullptr)
+      : stream_(stream) {}
+
+  void Instruction(MachineState& state) const {
+    if (stream_) {
+      stream_->AppendInstruction(state);
+    }
+  }
+  void Record(MachineState& state, MicroOp op) const {
+    if (stream_) {
+      stream_->AppendMicroOp(state.timing, op);
+    }
+  }
+
+  TraceStream* stream() const { return stream_; }
+
+ private:
+  TraceStream* stream_ = nullptr;
+};
+
+}  // namespace ct10::core
@@ -0,0 +1,63 @@
+#include "core/translation_cache.h"
+
+#include <cstring>
+
+namespace ct10::core {
+
+bool TranslatedBlock::Contains(uint16_t address) const {
+  return address >= start && address < start + length * 2;
+}
+
+TranslationCache::TranslationCache(Decoder decoder) : decoder_(decoder) {}
+
+const TranslatedBlock* TranslationCache::Lookup(const Memory& memory,
+                                                uint16_t start) {
+  start &= Memory::kAddressMask;
+  if (blocks_.empty()) {
+    blocks_.resize(Memory::kSize);
+  }
+
+  TranslatedBlock& block = blocks_[start];
+  if (block.length == 0 ||
+      std::memcmp(block.source.data(), memory.cells().data() + start,
+                  block.length * 2u) != 0) {
+    Translate(memory, start, block);
+  }
+  return block.length > 0 ? &block : nullptr;
+}
+
+void TranslationCache::Clear() {
+  for (TranslatedBlock& block : blocks_) {
+    block.length = 0;
+  }
+}
+
+uint64_t TranslationCache::translations() const { return translations_; }
+
+void TranslationCache::Translate(const Memory& memory,
+                                 uint16_t start,
+                                 TranslatedBlock& block) {
+  ++translations_;
+  block.start = start;
+  block.length = 0;
+
+  uint16_t address = start;
+  while (block.length < TranslatedBlock::kMaxInstructions &&
+         address + 1 < Memory::kSize) {
+    uint8_t opcode = memory.Read(address);
+    uint8_t operand = memory.Read(static_cast<uint16_t>(address + 1));
+    TranslatedInstruction& instruction = block.instructions[block.length];
+    if (!decoder_(opcode, operand, instruction)) {
+      break;
+    }
+    block.source[block.length * 2] = opcode;
+    block.source[block.length * 2 + 1] = operand;
+    ++block.length;
+    address = static_cast<uint16_t>(address + 2);
+    if (instruction.ends_block) {
+      break;
+    }
+  }
+}
+
+}  // namespace ct10::core
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "core/machine_state.h"
+#include "core/memory.h"
+
+namespace ct10::core {
+
+// One instruction with its operand byte and page address already resolved.
+// The handler applies the whole instruction and returns the clocks it spent.
+struct TranslatedInstruction {
+  using Handler = uint32_t (*)(MachineState&, const TranslatedInstruction&);
+
+  Handler handler = nullptr;
+  uint16_t target = 0;
+  uint8_t opcode = 0;
+  uint8_t operand = 0;
+  bool writes_memory = false;
+  bool ends_block = false;
+};
+
+// Straight-line run of translated instructions starting at a fixed PAR. The
+// source bytes are kept so a block can be checked against memory on entry;
+// an empty block is never reused.
+struct TranslatedBlock {
+  static constexpr uint8_t kMaxInstructions = 16;
+
+  bool Contains(uint16_t address) const;
+
+  uint16_t start = 0;
+  uint8_t length = 0;
+  std::array<uint8_t, kMaxInstructions * 2> source{};
+  std::array<TranslatedInstruction, kMaxInstructions> instructions{};
+};
+
+// Direct-mapped cache of translated blocks keyed by start address. A block
+// whose source bytes no longer match memory (BSB's return BUN, STA/LCC/RAO
+// into code, I/O reads, panel entry, state loads) is retranslated on lookup.
+class TranslationCache {
+ public:
+  // Fills out for the two instruction bytes; returns false for instructions
+  // that cannot be translated, which end the block before them.
+  using Decoder = bool (*)(uint8_t opcode,
+                           uint8_t operand,
+                           TranslatedInstruction& out);
+
+  explicit TranslationCache(Decoder decoder);
+
+  // Returns the block starting at start, or nullptr when the first
+  // instruction there cannot be translated.
+  const TranslatedBlock* Lookup(const Memory& memory, uint16_t start);
+  void Clear();
+
+  uint64_t translations() const;
+
+ private:
+  void Translate(const Memory& memory, uint16_t start, TranslatedBlock& block);
+
+  Decoder decoder_ = nullptr;
+  std::vector<TranslatedBlock> blocks_;
+  uint64_t translations_ = 0;
+};
+
+}  // namespace ct10::core
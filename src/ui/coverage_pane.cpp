@@ -0,0 +1,107 @@
+#include "ui/coverage_pane.h"
+
+#include <string_view>
+
+#include "imgui.h"
+#include "core/instruction_set.h"
+
+namespace ct10::ui {
+
+namespace {
+
+constexpr int kColumns = 32;
+constexpr float kCell = 10.0f;
+constexpr float kGap = 1.0f;
+
+constexpr ImU32 kUnexecuted = IM_COL32(45, 45, 50, 255);
+constexpr ImU32 kExecuted = IM_COL32(70, 130, 200, 255);
+constexpr ImU32 kBothWays = IM_COL32(60, 180, 90, 255);
+constexpr ImU32 kOneWay = IM_COL32(220, 160, 40, 255);
+constexpr ImU32 kNeitherWay = IM_COL32(200, 60, 60, 255);
+constexpr ImU32 kCurrent = IM_COL32(255, 255, 255, 255);
+
+ImU32 CellColor(const core::Coverage& coverage,
+                uint16_t address,
+                uint8_t opcode) {
+  if (!coverage.executed(address)) {
+    return kUnexecuted;
+  }
+  if (!core::IsConditionalOpcode(opcode)) {
+    return kExecuted;
+  }
+  int ways = (coverage.taken(address) ? 1 : 0) +
+             (coverage.fell_through(address) ? 1 : 0);
+  return ways == 2 ? kBothWays : ways == 1 ? kOneWay : kNeitherWay;
+}
+
+void Legend(ImU32 color, const char* label) {
+  ImVec2 pos = ImGui::GetCursorScreenPos();
+  ImGui::GetWindowDrawList()->AddRectFilled(
+      pos, ImVec2(pos.x + kCell, pos.y + kCell), color);
+  ImGui::Dummy(ImVec2(kCell, kCell));
+  ImGui::SameLine();
+  ImGui::TextUnformatted(label);
+  ImGui::SameLine();
+}
+
+}  // namespace
+
+void CoveragePane::Draw(core::Coverage& coverage,
+                        const core::MachineState& state) const {
+  ImVec2 display = ImGui::GetIO().DisplaySize;
+  ImGui::SetNextWindowPos(ImVec2(500.0f, display.y - 440.0f),
+                          ImGuiCond_FirstUseEver);
+  ImGui::SetNextWindowSize(ImVec2(380.0f, 420.0f), ImGuiCond_FirstUseEver);
+  ImGui::Begin("Coverage");
+
+  ImGui::Text("%zu of %zu addresses executed", coverage.executed_count(),
+              core::Memory::kSize);
+  ImGui::SameLine();
+  if (ImGui::Button("Clear")) {
+    coverage.Clear();
+  }
+  Legend(kExecuted, "run");
+  Legend(kBothWays, "both ways");
+  Legend(kOneWay, "one way");
+  Legend(kNeitherWay, "no outcome");
+  ImGui::NewLine();
+
+  // Cells are labelled with what is in memory now, which self-modifying code
+  // may have changed since it ran.
+  ImDrawList* draw_list = ImGui::GetWindowDrawList();
+  ImVec2 origin = ImGui::GetCursorScreenPos();
+  float pitch = kCell + kGap;
+  int rows = static_cast<int>(core::Memory::kSize) / kColumns;
+  ImGui::InvisibleButton("CoverageMap",
+                         ImVec2(kColumns * pitch, static_cast<float>(rows) *
+                                                      pitch));
+  bool hovered = ImGui::IsItemHovered();
+  ImVec2 mouse = ImGui::GetIO().MousePos;
+  uint16_t par = state.par.value() & core::Memory::kAddressMask;
+
+  for (uint16_t address = 0; address < core::Memory::kSize; ++address) {
+    float x = origin.x + static_cast<float>(address % kColumns) * pitch;
+    float y = origin.y + static_cast<float>(address / kColumns) * pitch;
+    ImVec2 min(x, y);
+    ImVec2 max(x + kCell, y + kCell);
+    uint8_t opcode = state.memory.Read(address);
+    draw_list->AddRectFilled(min, max, CellColor(coverage, address, opcode));
+    if (address == par) {
+      draw_list->AddRect(min, max, kCurrent);
+    }
+    if (hovered && mouse.x >= min.x && mouse.x < max.x + kGap &&
+        mouse.y >= min.y && mouse.y < max.y + kGap) {
+      const core::InstructionSpec* spec = core::FindInstruction(opcode);
+      std::string_view mnemonic = spec ? spec->mnemonic : "???";
+      ImGui::SetTooltip("%03X %02X %.*s%s%s", static_cast<unsigned>(address),
+                        static_cast<unsigned>(opcode),
+                        static_cast<int>(mnemonic.size()), mnemonic.data(),
+                        coverage.taken(address) ? " taken" : "",
+                        coverage.fell_through(address) ? " fell-through" : "");
+    }
+  }
+
+  ImGui::End();
+}
+
+}  // namespace ct10::ui
@@ -0,0 +1,15 @@
+#pragma once
+
+#include "core/coverage.h"
+#include "core/machine_state.h"
+
+namespace ct10::ui {
+
+// Coverage as a map of memory, one cell per address, coloured by whether an
+// instruction started there and which ways a conditional went.
+class CoveragePane {
+ public:
+  void Draw(core::Coverage& coverage, const core::MachineState& state) const;
+};
+
+}  // namespace ct10::ui
@@ -1,6 +1,7 @@
 #include "ui/debug_pane.h"
 
 #include <algorithm>
+#include <iterator>
 
 #include "imgui.h"
 #include "core/microcode.h"
@@ -22,7 +23,7 @@ const char* PhaseLabel(core::ClockPhase phase) {
 }
 
 void DrawBus(const core::Bus& bus) {
-  ImGui::Text("%s: %s 0x%04X", bus.name().c_str(),
+  ImGui::Text("%s: %s 0x%04X", bus.name(),
               bus.driven() ? "DRIVEN" : "idle",
               static_cast<unsigned>(bus.value()));
 }
@@ -204,8 +205,10 @@ void DebugPane::Draw(const core::MachineState& state, float top_offset) const {
   ImGui::Text("Trace");
   size_t trace_count = state.trace.size();
   size_t show = std::min<size_t>(trace_count, 12);
-  for (size_t i = 0; i < show; ++i) {
-    const auto& entry = state.trace[trace_count - show + i];
+  auto it = std::next(state.trace.begin(),
+                      static_cast<std::ptrdiff_t>(trace_count - show));
+  for (; it != state.trace.end(); ++it) {
+    const core::TraceEntry& entry = *it;
     ImGui::Text("D%u %s %s %s",
                 static_cast<unsigned>(entry.distributor),
                 PhaseLabel(entry.phase),
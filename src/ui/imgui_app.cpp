@@ -1,7 +1,9 @@
 #include "ui/imgui_app.h"
 
 #include <algorithm>
+#include <array>
 #include <cctype>
+#include <cstdlib>
 #include <cstring>
 #include <ctime>
 #include <filesystem>
@@ -23,10 +25,19 @@
 #include "imgui_impl_opengl2.h"
 
 #include "app/golden_program.h"
+#include "app/panel_controller.h"
+#include "app/panel_session.h"
 #include "app/program_text.h"
 #include "app/tape_io.h"
+#include "core/execution_history.h"
+#include "core/functional_engine.h"
+#include "core/instruction_probes.h"
+#include "core/runner.h"
+#include "core/snapshot.h"
 #include "core/state_io.h"
+#include "ui/coverage_pane.h"
 #include "ui/debug_pane.h"
+#include "ui/profile_pane.h"
 #include "ui/panel_layout.h"
 #include "ui/panel_view.h"
 
@@ -35,13 +46,18 @@ namespace {
 
 constexpr float kRightPaneMargin = 20.0f;
 constexpr float kRightPaneWidth = 260.0f;
-constexpr float kControlsHeight = 200.0f;
+constexpr float kControlsHeight = 270.0f;
 constexpr float kRightPaneGap = 20.0f;
 constexpr float kProgramHeight = 520.0f;
 constexpr float kProgramTop = kRightPaneMargin + kControlsHeight + kRightPaneGap;
 constexpr float kDebugTop = kProgramTop + kProgramHeight + kRightPaneGap;
-constexpr int kPanelStepGuard = 200000;
 constexpr size_t kIoTextMaxBytes = 4096;
+constexpr size_t kQuickSaveSlots = 4;
+
+struct QuickSaveSlot {
+  core::Snapshot snapshot;
+  bool used = false;
+};
 
 int ClampMaxSteps(int steps) {
   if (steps < 1) {
@@ -139,55 +155,16 @@ PanelFonts LoadPanelFonts() {
   return fonts;
 }
 
-void StepClock(core::TimingEngine& timing,
-               core::MachineState& state,
-               core::ExecutionEngine& execution) {
-  bool was_halted = state.mode.halted;
-  state.mode.halted = false;
-  execution.Step(state);
-  if (!state.mode.halted) {
-    state.mode.halted = was_halted;
-  }
-  timing.Advance(state.timing);
-}
-
-void StepDistributor(core::TimingEngine& timing,
-                     core::MachineState& state,
-                     core::ExecutionEngine& execution) {
-  uint8_t start = state.timing.distributor;
-  do {
-    StepClock(timing, state, execution);
-  } while (state.timing.distributor == start);
-}
-
-void StepUntilPhaseToggle(core::TimingEngine& timing,
-                          core::MachineState& state,
-                          core::ExecutionEngine& execution) {
-  bool start_acq = state.timing.acquisition;
-  int guard = 0;
-  while (guard < kPanelStepGuard) {
-    StepClock(timing, state, execution);
-    if (state.timing.acquisition != start_acq) {
-      break;
-    }
-    ++guard;
-  }
-}
-
-void StepInstruction(core::TimingEngine& timing,
-                     core::MachineState& state,
-                     core::ExecutionEngine& execution) {
-  int toggles = 0;
-  bool start_acq = state.timing.acquisition;
-  int guard = 0;
-  while (guard < kPanelStepGuard && toggles < 2) {
-    StepClock(timing, state, execution);
-    if (state.timing.acquisition != start_acq) {
-      start_acq = state.timing.acquisition;
-      ++toggles;
-    }
-    ++guard;
-  }
+core::RunResult RunPanel(core::TimingEngine& timing,
+                         core::MachineState& state,
+                         core::ExecutionEngine& execution,
+                         core::ExecutionHistory& history,
+                         const core::InstructionProbes& probes,
+                         const core::RunBudget& budget) {
+  core::StopConditions stop;
+  stop.halt = false;
+  return history.Run(core::Runner(execution, nullptr, probes), state, timing,
+                     budget, stop);
 }
 
 void RunGoldenTest(const ImGuiApp::ResetHook& reset_hook,
@@ -208,13 +185,9 @@ void RunGoldenTest(const ImGuiApp::ResetHook& reset_hook,
   test_timing.Reset(test_state.timing);
 
   max_steps = ClampMaxSteps(max_steps);
-  int steps = 0;
-  for (; steps < max_steps; ++steps) {
-    StepClock(test_timing, test_state, test_execution);
-    if (test_state.mode.halted) {
-      break;
-    }
-  }
+  core::RunResult run = core::Runner(test_execution).Run(
+      test_state, test_timing,
+      {core::BudgetUnit::Clocks, static_cast<uint64_t>(max_steps)});
 
   if (!test_state.mode.halted) {
     message = "Golden test did not halt.";
@@ -236,13 +209,18 @@ void RunGoldenTest(const ImGuiApp::ResetHook& reset_hook,
   }
 
   std::ostringstream out;
-  out << "Golden test passed in " << (steps + 1) << " clock steps.";
+  out << "Golden test passed in " << run.clocks << " clock steps.";
   message = out.str();
   passed = true;
 }
 
 void DrawControls(core::MachineState& state,
                   core::TimingEngine& timing,
+                  core::ExecutionEngine& execution,
+                  core::ExecutionHistory& history,
+                  bool& use_functional,
+                  bool& profiling,
+                  bool& covering,
                   app::ModeController& mode,
                   const ImGuiApp::ResetHook& reset_hook,
                   const ImVec2& display_size,
@@ -274,6 +252,49 @@ void DrawControls(core::MachineState& state,
     step_distributor = true;
   }
 
+  core::BudgetUnit back_unit = core::BudgetUnit::Clocks;
+  bool step_back = false;
+  if (ImGui::Button("Back Clock")) {
+    step_back = true;
+  }
+  ImGui::SameLine();
+  if (ImGui::Button("Back Dist")) {
+    back_unit = core::BudgetUnit::DistributorCounts;
+    step_back = true;
+  }
+  ImGui::SameLine();
+  if (ImGui::Button("Back Inst")) {
+    back_unit = core::BudgetUnit::Instructions;
+    step_back = true;
+  }
+  static char write_address[8] = "000";
+  static std::string history_message;
+  ImGui::SetNextItemWidth(60.0f);
+  ImGui::InputText("##WriteAddress", write_address, sizeof(write_address),
+                   ImGuiInputTextFlags_CharsHexadecimal);
+  ImGui::SameLine();
+  if (ImGui::Button("Back to Write")) {
+    mode.SetMode(app::RunMode::Halted);
+    uint16_t address = static_cast<uint16_t>(
+        std::strtoul(write_address, nullptr, 16) & core::Memory::kAddressMask);
+    history_message.clear();
+    if (!history.RunBackToWrite(state, timing, address)) {
+      history_message = "No earlier write in history.";
+    }
+  }
+  if (step_back) {
+    mode.SetMode(app::RunMode::Halted);
+    history_message.clear();
+    history.StepBack(state, timing, back_unit, 1);
+  }
+  ImGui::Text("Clock: %llu (history from %llu)",
+              static_cast<unsigned long long>(history.position()),
+              static_cast<unsigned long long>(history.oldest()));
+  if (!history_message.empty()) {
+    ImGui::TextColored(ImVec4(0.9f, 0.4f, 0.4f, 1.0f), "%s",
+                       history_message.c_str());
+  }
+
   if (ImGui::Button("Reload Program") && reset_hook) {
     reset_hook(state);
     timing.Reset(state.timing);
@@ -284,6 +305,14 @@ void DrawControls(core::MachineState& state,
   if (ImGui::SliderFloat("Speed", &speed, 1.0f, 10.0f, "%.1fx")) {
     timing.set_speed_multiplier(speed);
   }
+  bool fast_forward = execution.fast_forward();
+  if (ImGui::Checkbox("Fast-forward idle clocks", &fast_forward)) {
+    execution.set_fast_forward(fast_forward);
+  }
+  ImGui::Checkbox("Functional engine", &use_functional);
+  ImGui::Checkbox("Profile", &profiling);
+  ImGui::SameLine();
+  ImGui::Checkbox("Coverage", &covering);
 
   ImGui::Text("Mode: %s", mode.IsHalted() ? "halted" : "running");
   ImGui::Text("Panel: %dx%d", PanelLayout::kWidth, PanelLayout::kHeight);
@@ -310,6 +339,8 @@ void DrawControls(core::MachineState& state,
 
 void DrawProgramEditor(core::MachineState& state,
                        app::ModeController& mode,
+                       app::PanelSessionRecorder& session,
+                       app::PanelController& panel,
                        const ImVec2& display_size) {
   ImVec2 pos(display_size.x - kRightPaneWidth - kRightPaneMargin,
              kProgramTop);
@@ -330,6 +361,7 @@ void DrawProgramEditor(core::MachineState& state,
   static char tape_in_path[256] = "";
   static char tape_out_path[256] = "";
   static char state_path[256] = "";
+  static char session_path[256] = "";
   static char terminal_out_path[256] = "";
   static char printer_out_path[256] = "";
   static std::string tape_message;
@@ -346,6 +378,9 @@ void DrawProgramEditor(core::MachineState& state,
   static int printer_save_format = 1;
   static std::string state_message;
   static bool state_ok = true;
+  static std::array<QuickSaveSlot, kQuickSaveSlots> quick_slots;
+  static std::string session_message;
+  static bool session_ok = true;
   static std::string expect_message;
   static bool expect_ok = true;
 
@@ -469,6 +504,12 @@ void DrawProgramEditor(core::MachineState& state,
   if (ImGui::Button("Clear Trace")) {
     state.ClearTrace();
   }
+  int trace_capacity = static_cast<int>(state.trace.capacity());
+  ImGui::SetNextItemWidth(120.0f);
+  if (ImGui::InputInt("Trace capacity", &trace_capacity, 64, 512)) {
+    trace_capacity = std::clamp(trace_capacity, 0, 65536);
+    state.trace.set_capacity(static_cast<size_t>(trace_capacity));
+  }
 
   ImGui::Separator();
   ImGui::Text("I/O Tape");
@@ -736,6 +777,32 @@ void DrawProgramEditor(core::MachineState& state,
       state_ok = false;
     }
   }
+  for (size_t slot = 0; slot < quick_slots.size(); ++slot) {
+    QuickSaveSlot& quick = quick_slots[slot];
+    ImGui::PushID(static_cast<int>(slot));
+    if (ImGui::Button("Quick Save")) {
+      core::CaptureState(state, quick.snapshot);
+      quick.used = true;
+      state_message = "Saved to slot " + std::to_string(slot + 1) + ".";
+      state_ok = true;
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Quick Load") && quick.used) {
+      core::RestoreState(state, quick.snapshot);
+      mode.SetMode(state.mode.halted ? app::RunMode::Halted
+                                     : app::RunMode::Continuous);
+      state_message = "Loaded slot " + std::to_string(slot + 1) + ".";
+      state_ok = true;
+    }
+    ImGui::SameLine();
+    if (quick.used) {
+      ImGui::Text("%zu: PAR %03X", slot + 1,
+                  static_cast<unsigned>(quick.snapshot.core.par.value()));
+    } else {
+      ImGui::Text("%zu: empty", slot + 1);
+    }
+    ImGui::PopID();
+  }
   if (!state_message.empty()) {
     ImVec4 color =
         state_ok ? ImVec4(0.2f, 0.8f, 0.2f, 1.0f)
@@ -743,195 +810,54 @@ void DrawProgramEditor(core::MachineState& state,
     ImGui::TextColored(color, "%s", state_message.c_str());
   }
 
-  ImGui::End();
-}
-
-}  // namespace
-
-void ApplyPanelControls(core::MachineState& state,
-                        core::TimingEngine& timing,
-                        app::ModeController& mode,
-                        const ImGuiApp::ResetHook& reset_hook) {
-  static bool last_power_on = true;
-  bool power_on = state.panel_input.power_on;
-
-  if (power_on != last_power_on) {
-    if (!power_on) {
-      state.ClearRegisters();
-      timing.Reset(state.timing);
-      mode.SetMode(app::RunMode::Halted);
-      state.mode.halted = true;
-      state.io.transfer_mode = core::IoTransferMode::None;
-      state.io.transfer_address = 0;
-      state.io.transfer_remaining = 0;
-      state.io.wait_cycles = 0;
-      state.panel_input.key_value = 0;
-      state.panel_input.last_key = 0;
-      state.panel_input.has_last_key = false;
-      state.panel_input.load_pressed = false;
-      state.panel_input.load_target = core::LoadTarget::None;
+  ImGui::Separator();
+  ImGui::Text("Panel Session");
+  ImGui::InputText("Session Path", session_path, sizeof(session_path));
+  if (!session.recording()) {
+    if (ImGui::Button("Record Session")) {
+      std::string error;
+      session_ok = session.Open(session_path, state, mode.mode(), &error);
+      session_message = session_ok ? "Recording panel input." : error;
+    }
+  } else if (ImGui::Button("Stop Recording")) {
+    std::string error;
+    session_ok = session.Close(&error);
+    if (session_ok) {
+      std::ostringstream out;
+      out << "Recorded " << session.frames() << " frames over "
+          << session.clocks() << " clocks.";
+      session_message = out.str();
     } else {
-      timing.Reset(state.timing);
-      mode.SetMode(app::RunMode::Halted);
-      state.mode.halted = true;
-      state.io.transfer_mode = core::IoTransferMode::None;
-      state.io.transfer_address = 0;
-      state.io.transfer_remaining = 0;
-      state.io.wait_cycles = 0;
-      state.panel_input.key_value = 0;
-      state.panel_input.last_key = 0;
-      state.panel_input.has_last_key = false;
-      state.panel_input.load_pressed = false;
-      state.panel_input.load_target = core::LoadTarget::None;
+      session_message = error;
     }
-    state.panel_input.ClearMomentary();
-    last_power_on = power_on;
-  }
-
-  if (!power_on) {
-    mode.SetMode(app::RunMode::Halted);
-    state.mode.halted = true;
-    return;
   }
-
-  if (state.panel_input.reset && reset_hook) {
-    reset_hook(state);
-    timing.Reset(state.timing);
-    mode.SetMode(app::RunMode::Halted);
-    state.mode.halted = true;
-    state.io.transfer_mode = core::IoTransferMode::None;
-    state.io.transfer_address = 0;
-    state.io.transfer_remaining = 0;
-    state.io.wait_cycles = 0;
-    state.panel_input.input_switches = 0;
-    state.panel_input.key_value = 0;
-    state.panel_input.last_key = 0;
-    state.panel_input.has_last_key = false;
-  }
-
-  if (state.panel_input.clear) {
-    state.ClearRegisters();
-    timing.Reset(state.timing);
-    mode.SetMode(app::RunMode::Halted);
-    state.io.transfer_mode = core::IoTransferMode::None;
-    state.io.transfer_address = 0;
-    state.io.transfer_remaining = 0;
-    state.io.wait_cycles = 0;
-  }
-}
-
-void RefreshPanelStatus(core::MachineState& state) {
-  state.status.sense = state.panel_input.sense;
-  state.status.interrupt = state.io.interrupt;
-}
-
-void ApplyPanelIoPreset(core::MachineState& state) {
-  static bool last_read_intrp = false;
-  static bool last_write_block = false;
-
-  bool read_intrp = state.panel_input.io_read && state.panel_input.io_intrp;
-  bool write_block = state.panel_input.io_write && state.panel_input.io_block;
-
-  if (!state.panel_input.power_on) {
-    last_read_intrp = read_intrp;
-    last_write_block = write_block;
-    return;
-  }
-
-  if (read_intrp && !last_read_intrp) {
-    state.opcode.Load(0xE8);
-    state.countdown.Load(0xFF);
-    state.timing.distributor = 0;
-    state.timing.phase = core::ClockPhase::CP1;
-    state.timing.acquisition = false;
-    state.distributor.Load(state.timing.distributor);
+  ImGui::SameLine();
+  if (ImGui::Button("Replay Session")) {
+    std::string error;
+    uint64_t clocks = 0;
+    session_ok = app::ReplayPanelSession(session_path, state, clocks, &error);
+    if (session_ok) {
+      panel.Sync(state.panel_input);
+      mode.SetMode(state.mode.halted ? app::RunMode::Halted
+                                     : app::RunMode::Continuous);
+      std::ostringstream out;
+      out << "Replayed " << clocks << " clocks.";
+      session_message = out.str();
+    } else {
+      session_message = error.empty() ? "Replay failed." : error;
+    }
   }
-
-  if (write_block && !last_write_block) {
-    state.opcode.Load(0xD0);
-    state.countdown.Load(0xFF);
-    state.timing.distributor = 0;
-    state.timing.phase = core::ClockPhase::CP1;
-    state.timing.acquisition = false;
-    state.distributor.Load(state.timing.distributor);
+  if (!session_message.empty()) {
+    ImVec4 color =
+        session_ok ? ImVec4(0.2f, 0.8f, 0.2f, 1.0f)
+                   : ImVec4(0.9f, 0.4f, 0.4f, 1.0f);
+    ImGui::TextColored(color, "%s", session_message.c_str());
   }
 
-  last_read_intrp = read_intrp;
-  last_write_block = write_block;
-}
-
-void ApplyRegisterLoad(core::MachineState& state) {
-  if (!state.panel_input.power_on) {
-    state.panel_input.load_pressed = false;
-    state.panel_input.load_target = core::LoadTarget::None;
-    return;
-  }
-  if (!state.panel_input.load_pressed) {
-    return;
-  }
-  uint16_t input = state.panel_input.input_switches;
-  uint8_t low8 = static_cast<uint8_t>(input & 0xFF);
-  uint16_t full10 = static_cast<uint16_t>(input & 0x3FF);
-  switch (state.panel_input.load_target) {
-    case core::LoadTarget::Accumulator:
-      state.accumulator.Load(low8);
-      break;
-    case core::LoadTarget::Buffer:
-      state.buffer.Load(low8);
-      break;
-    case core::LoadTarget::Countdown:
-      state.countdown.Load(low8);
-      break;
-    case core::LoadTarget::Distributor:
-      state.distributor.Load(static_cast<uint16_t>(low8 & 0x0F));
-      break;
-    case core::LoadTarget::Opcode:
-      state.opcode.Load(low8);
-      break;
-    case core::LoadTarget::Mar:
-      state.mar.Load(full10);
-      break;
-    case core::LoadTarget::Par:
-      state.par.Load(full10);
-      break;
-    case core::LoadTarget::Quotient:
-      state.quotient.Load(low8);
-      break;
-    case core::LoadTarget::Index:
-      state.index.Load(low8);
-      break;
-    case core::LoadTarget::None:
-    default:
-      break;
-  }
-  state.panel_input.load_pressed = false;
-  state.panel_input.load_target = core::LoadTarget::None;
+  ImGui::End();
 }
 
-bool ApplyManualMemory(core::MachineState& state) {
-  if (!state.panel_input.power_on) {
-    return false;
-  }
-  if (!state.panel_input.start) {
-    return false;
-  }
-  if (!state.panel_input.mem_read && !state.panel_input.mem_write) {
-    return false;
-  }
-  uint16_t address = state.mar.value();
-  if (state.panel_input.mem_write) {
-    uint8_t value = static_cast<uint8_t>(state.panel_input.input_switches & 0xFF);
-    state.memory.Write(address, value);
-    state.mar.Load(static_cast<uint16_t>(address + 1));
-  } else if (state.panel_input.mem_read) {
-    uint8_t value = state.memory.Read(address);
-    uint16_t upper = static_cast<uint16_t>(state.panel_input.input_switches & 0x300);
-    state.panel_input.input_switches =
-        static_cast<uint16_t>(upper | static_cast<uint16_t>(value));
-    state.mar.Load(static_cast<uint16_t>(address + 1));
-  }
-  return true;
-}
+}  // namespace
 
 int ImGuiApp::Run(core::MachineState& state,
                   core::TimingEngine& timing,
@@ -965,7 +891,23 @@ int ImGuiApp::Run(core::MachineState& state,
   ImGui_ImplOpenGL2_Init();
 
   DebugPane debug_pane;
+  ProfilePane profile_pane;
+  core::Profile profile;
+  CoveragePane coverage_pane;
+  core::Coverage coverage;
   PanelView panel_view(panel_fonts.display, panel_fonts.input);
+  core::FunctionalEngine functional;
+  core::ExecutionHistory history;
+  app::PanelController panel;
+  app::PanelSessionRecorder session;
+  // Records what a panel reset left behind, for replays that have no hook.
+  const ResetHook panel_reset = [&](core::MachineState& target) {
+    reset_hook(target);
+    session.NoteReset(target);
+  };
+  bool use_functional = false;
+  bool profiling = false;
+  bool covering = false;
 
   while (!glfwWindowShouldClose(window)) {
     glfwPollEvents();
@@ -980,79 +922,45 @@ int ImGuiApp::Run(core::MachineState& state,
     bool step_distributor = false;
 
     ImVec2 display_size = ImGui::GetIO().DisplaySize;
-    DrawControls(state, timing, mode, reset_hook, display_size, step_clock,
+    DrawControls(state, timing, execution, history, use_functional, profiling,
+                 covering, mode, reset_hook, display_size, step_clock,
                  step_distributor);
-    DrawProgramEditor(state, mode, display_size);
+    DrawProgramEditor(state, mode, session, panel, display_size);
     panel_view.Draw(state);
-    RefreshPanelStatus(state);
-    ApplyPanelControls(state, timing, mode, reset_hook);
-    ApplyPanelIoPreset(state);
-    ApplyRegisterLoad(state);
-
-    bool panel_step_dist = false;
-    bool panel_step_phase = false;
-    bool panel_step_inst = false;
-    bool panel_manual_memory = false;
-    if (state.panel_input.power_on) {
-      if (state.panel_input.stop) {
-        mode.SetMode(app::RunMode::Halted);
-      }
-      if (state.panel_input.start) {
-        panel_manual_memory = ApplyManualMemory(state);
-        if (!panel_manual_memory) {
-          switch (state.panel_input.mode) {
-            case 0:
-              panel_step_dist = true;
-              mode.SetMode(app::RunMode::Halted);
-              break;
-            case 1:
-              panel_step_phase = true;
-              mode.SetMode(app::RunMode::Halted);
-              break;
-            case 2:
-              panel_step_inst = true;
-              mode.SetMode(app::RunMode::Halted);
-              break;
-            case 3:
-            default:
-              mode.SetMode(app::RunMode::Continuous);
-              break;
-          }
-        } else {
-          mode.SetMode(app::RunMode::Halted);
-        }
-      }
-    } else {
-      mode.SetMode(app::RunMode::Halted);
-    }
-
-    state.mode.halted = mode.IsHalted();
 
-    if (state.panel_input.power_on) {
-      if (!state.mode.halted) {
-        int steps = std::max(1, static_cast<int>(timing.speed_multiplier()));
-        for (int i = 0; i < steps; ++i) {
-          StepClock(timing, state, execution);
-        }
-      } else if (panel_step_inst) {
-        StepInstruction(timing, state, execution);
-      } else if (panel_step_phase) {
-        StepUntilPhaseToggle(timing, state, execution);
-      } else if (panel_step_dist) {
-        StepDistributor(timing, state, execution);
-      } else if (step_distributor) {
-        StepDistributor(timing, state, execution);
-      } else if (step_clock) {
-        StepClock(timing, state, execution);
-      }
-    }
-
-    if (state.mode.halted && !mode.IsHalted()) {
-      mode.SetMode(app::RunMode::Halted);
+    session.BeginFrame(state, mode.mode(), step_clock, step_distributor);
+    core::RunBudget step =
+        panel.Apply(state, timing, mode, reset_hook ? panel_reset : reset_hook,
+                    step_clock, step_distributor);
+    core::InstructionProbes probes;
+    probes.profile = profiling ? &profile : nullptr;
+    probes.coverage = covering ? &coverage : nullptr;
+    uint64_t clocks = 0;
+    if (state.panel_input.power_on && !state.mode.halted) {
+      uint64_t steps = static_cast<uint64_t>(
+          std::max(1, static_cast<int>(timing.speed_multiplier())));
+      core::BudgetUnit unit = use_functional ? core::BudgetUnit::Instructions
+                                             : core::BudgetUnit::Clocks;
+      clocks = history
+                   .Run(core::Runner(execution,
+                                     use_functional ? &functional : nullptr,
+                                     probes),
+                        state, timing, {unit, steps})
+                   .clocks;
+    } else if (step.count > 0) {
+      clocks = RunPanel(timing, state, execution, history, probes, step)
+                   .clocks;
     }
-    state.mode.halted = mode.IsHalted();
+    app::PanelController::Settle(state, mode);
+    session.EndFrame(state, mode.mode(), clocks);
 
     debug_pane.Draw(state, kDebugTop);
+    if (profiling) {
+      profile_pane.Draw(profile, state);
+    }
+    if (covering) {
+      coverage_pane.Draw(coverage, state);
+    }
 
     ImGui::Render();
 
@@ -1068,6 +976,9 @@ int ImGuiApp::Run(core::MachineState& state,
     glfwSwapBuffers(window);
   }
 
+  std::string session_error;
+  session.Close(&session_error);
+
   ImGui_ImplOpenGL2_Shutdown();
   ImGui_ImplGlfw_Shutdown();
   ImGui::DestroyContext();
@@ -0,0 +1,245 @@
+#include "ui/profile_pane.h"
+
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "imgui.h"
+#include "core/instruction_set.h"
+
+namespace ct10::ui {
+
+namespace {
+
+enum ProfileColumn : ImGuiID {
+  kColumnAddress,
+  kColumnInstruction,
+  kColumnCount,
+  kColumnClocks,
+  kColumnWait,
+  kColumnExclusive,
+};
+
+constexpr ImGuiTableFlags kTableFlags =
+    ImGuiTableFlags_Sortable | ImGuiTableFlags_RowBg |
+    ImGuiTableFlags_Borders | ImGuiTableFlags_ScrollY |
+    ImGuiTableFlags_SizingFixedFit;
+
+double Percent(uint64_t part, uint64_t whole) {
+  return whole > 0 ? 100.0 * static_cast<double>(part) /
+                         static_cast<double>(whole)
+                   : 0.0;
+}
+
+struct ProfileRow {
+  uint16_t address = 0;
+  std::string_view mnemonic;
+  core::ProfileCounts counts;
+};
+
+uint64_t SortValue(const ProfileRow& row, ImGuiID column) {
+  switch (column) {
+    case kColumnCount:
+      return row.counts.instructions;
+    case kColumnWait:
+      return row.counts.wait_clocks;
+    case kColumnAddress:
+      return row.address;
+    case kColumnClocks:
+    default:
+      return row.counts.clocks;
+  }
+}
+
+void SortRows(std::vector<ProfileRow>& rows, const ImGuiTableSortSpecs* specs) {
+  if (!specs || specs->SpecsCount == 0) {
+    return;
+  }
+  const ImGuiTableColumnSortSpecs& spec = specs->Specs[0];
+  bool ascending = spec.SortDirection == ImGuiSortDirection_Ascending;
+  std::stable_sort(rows.begin(), rows.end(),
+                   [&](const ProfileRow& a, const ProfileRow& b) {
+                     if (spec.ColumnUserID == kColumnInstruction) {
+                       return ascending ? a.mnemonic < b.mnemonic
+                                        : b.mnemonic < a.mnemonic;
+                     }
+                     uint64_t left = SortValue(a, spec.ColumnUserID);
+                     uint64_t right = SortValue(b, spec.ColumnUserID);
+                     return ascending ? left < right : right < left;
+                   });
+}
+
+uint64_t RoutineSortValue(const core::CallRoutine& routine, ImGuiID column) {
+  switch (column) {
+    case kColumnAddress:
+      return routine.entry;
+    case kColumnCount:
+      return routine.calls;
+    case kColumnExclusive:
+      return routine.exclusive_clocks;
+    case kColumnClocks:
+    default:
+      return routine.inclusive_clocks;
+  }
+}
+
+}  // namespace
+
+void ProfilePane::DrawSubroutines(const core::Profile& profile) const {
+  std::vector<core::CallRoutine> routines =
+      core::CallRoutines(profile.calls());
+  if (routines.empty()) {
+    ImGui::TextDisabled("No BSB calls seen.");
+    return;
+  }
+  if (!ImGui::BeginTable("BySubroutine", 5, kTableFlags)) {
+    return;
+  }
+  ImGui::TableSetupScrollFreeze(0, 1);
+  ImGui::TableSetupColumn("Entry", 0, 0.0f, kColumnAddress);
+  ImGui::TableSetupColumn("Calls", ImGuiTableColumnFlags_PreferSortDescending,
+                          0.0f, kColumnCount);
+  ImGui::TableSetupColumn("Inclusive",
+                          ImGuiTableColumnFlags_DefaultSort |
+                              ImGuiTableColumnFlags_PreferSortDescending,
+                          0.0f, kColumnClocks);
+  ImGui::TableSetupColumn("Time", ImGuiTableColumnFlags_NoSort);
+  ImGui::TableSetupColumn("Exclusive",
+                          ImGuiTableColumnFlags_PreferSortDescending, 0.0f,
+                          kColumnExclusive);
+  ImGui::TableHeadersRow();
+
+  const ImGuiTableSortSpecs* specs = ImGui::TableGetSortSpecs();
+  if (specs && specs->SpecsCount > 0) {
+    const ImGuiTableColumnSortSpecs& spec = specs->Specs[0];
+    bool ascending = spec.SortDirection == ImGuiSortDirection_Ascending;
+    std::stable_sort(routines.begin(), routines.end(),
+                     [&](const core::CallRoutine& a,
+                         const core::CallRoutine& b) {
+                       uint64_t left = RoutineSortValue(a, spec.ColumnUserID);
+                       uint64_t right = RoutineSortValue(b, spec.ColumnUserID);
+                       return ascending ? left < right : right < left;
+                     });
+  }
+  uint64_t total_clocks = profile.total().clocks;
+  for (const core::CallRoutine& routine : routines) {
+    ImGui::TableNextRow();
+    ImGui::TableNextColumn();
+    ImGui::Text("%03X", static_cast<unsigned>(routine.entry));
+    ImGui::TableNextColumn();
+    ImGui::Text("%llu", static_cast<unsigned long long>(routine.calls));
+    ImGui::TableNextColumn();
+    ImGui::Text("%llu",
+                static_cast<unsigned long long>(routine.inclusive_clocks));
+    ImGui::TableNextColumn();
+    ImGui::Text("%.2f%%", Percent(routine.inclusive_clocks, total_clocks));
+    ImGui::TableNextColumn();
+    ImGui::Text("%llu",
+                static_cast<unsigned long long>(routine.exclusive_clocks));
+  }
+  ImGui::EndTable();
+}
+
+void ProfilePane::Draw(core::Profile& profile,
+                       const core::MachineState& state) {
+  ImVec2 display = ImGui::GetIO().DisplaySize;
+  ImGui::SetNextWindowPos(ImVec2(20.0f, display.y - 340.0f),
+                          ImGuiCond_FirstUseEver);
+  ImGui::SetNextWindowSize(ImVec2(460.0f, 320.0f), ImGuiCond_FirstUseEver);
+  ImGui::Begin("Profile");
+
+  const core::ProfileCounts& total = profile.total();
+  ImGui::Text("%llu instructions, %llu clocks, %.2f%% I/O wait",
+              static_cast<unsigned long long>(total.instructions),
+              static_cast<unsigned long long>(total.clocks),
+              Percent(total.wait_clocks, total.clocks));
+  if (ImGui::RadioButton("Addresses", view_ == View::Addresses)) {
+    view_ = View::Addresses;
+  }
+  ImGui::SameLine();
+  if (ImGui::RadioButton("Instructions", view_ == View::Instructions)) {
+    view_ = View::Instructions;
+  }
+  ImGui::SameLine();
+  if (ImGui::RadioButton("Subroutines", view_ == View::Subroutines)) {
+    view_ = View::Subroutines;
+  }
+  ImGui::SameLine();
+  if (ImGui::Button("Clear")) {
+    profile.Clear();
+  }
+
+  if (view_ == View::Subroutines) {
+    DrawSubroutines(profile);
+    ImGui::End();
+    return;
+  }
+
+  bool by_address = view_ == View::Addresses;
+  std::vector<ProfileRow> rows;
+  if (by_address) {
+    for (uint16_t address = 0; address < core::Memory::kSize; ++address) {
+      const core::ProfileCounts& counts = profile.address(address);
+      if (counts.instructions == 0) {
+        continue;
+      }
+      // Labelled with what is in memory now, which self-modifying code may
+      // have changed since it ran.
+      const core::InstructionSpec* spec =
+          core::FindInstruction(state.memory.Read(address));
+      rows.push_back({address, spec ? spec->mnemonic : "???", counts});
+    }
+  } else {
+    for (const core::ProfileMnemonic& row : core::ProfileByMnemonic(profile)) {
+      rows.push_back({0, row.mnemonic, row.counts});
+    }
+  }
+
+  if (ImGui::BeginTable(by_address ? "ByAddress" : "ByInstruction",
+                        by_address ? 6 : 5, kTableFlags)) {
+    ImGui::TableSetupScrollFreeze(0, 1);
+    if (by_address) {
+      ImGui::TableSetupColumn("Addr", 0, 0.0f, kColumnAddress);
+    }
+    ImGui::TableSetupColumn("Inst", 0, 0.0f, kColumnInstruction);
+    ImGui::TableSetupColumn("Count", ImGuiTableColumnFlags_PreferSortDescending,
+                            0.0f, kColumnCount);
+    ImGui::TableSetupColumn("Clocks",
+                            ImGuiTableColumnFlags_DefaultSort |
+                                ImGuiTableColumnFlags_PreferSortDescending,
+                            0.0f, kColumnClocks);
+    ImGui::TableSetupColumn("Time", ImGuiTableColumnFlags_NoSort);
+    ImGui::TableSetupColumn("Wait", ImGuiTableColumnFlags_PreferSortDescending,
+                            0.0f, kColumnWait);
+    ImGui::TableHeadersRow();
+
+    // Rows are rebuilt every frame, so they are sorted every frame too.
+    SortRows(rows, ImGui::TableGetSortSpecs());
+    for (const ProfileRow& row : rows) {
+      ImGui::TableNextRow();
+      if (by_address) {
+        ImGui::TableNextColumn();
+        ImGui::Text("%03X", static_cast<unsigned>(row.address));
+      }
+      ImGui::TableNextColumn();
+      ImGui::Text("%.*s", static_cast<int>(row.mnemonic.size()),
+                  row.mnemonic.data());
+      ImGui::TableNextColumn();
+      ImGui::Text("%llu",
+                  static_cast<unsigned long long>(row.counts.instructions));
+      ImGui::TableNextColumn();
+      ImGui::Text("%llu", static_cast<unsigned long long>(row.counts.clocks));
+      ImGui::TableNextColumn();
+      ImGui::Text("%.2f%%", Percent(row.counts.clocks, total.clocks));
+      ImGui::TableNextColumn();
+      ImGui::Text("%llu",
+                  static_cast<unsigned long long>(row.counts.wait_clocks));
+    }
+    ImGui::EndTable();
+  }
+
+  ImGui::End();
+}
+
+}  // namespace ct10::ui
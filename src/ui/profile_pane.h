@@ -0,0 +1,26 @@
+#pragma once
+
+#include "core/machine_state.h"
+#include "core/profile.h"
+
+namespace ct10::ui {
+
+// Profile as a sortable table, per address, per instruction or per BSB
+// subroutine.
+class ProfilePane {
+ public:
+  void Draw(core::Profile& profile, const core::MachineState& state);
+
+ private:
+  enum class View {
+    Addresses,
+    Instructions,
+    Subroutines,
+  };
+
+  void DrawSubroutines(const core::Profile& profile) const;
+
+  View view_ = View::Addresses;
+};
+
+}  // namespace ct10::ui